@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#ifdef _WINDOWS
+#include <malloc.h>
+#endif
+#include <new>
+#include "AllocationTracker.h"
+
+const char *const ALLOCATION_TAG_NAMES[TAG_COUNT] = { "other", "world", "effects", "snapshot", "draw", "jobs" };
+
+// Constant-initialised, so they are ready before any static constructor allocates
+static std::atomic<long long> s_counts[TAG_COUNT];
+static std::atomic<long long> s_bytes[TAG_COUNT];
+static thread_local AllocationTag t_tag = TAG_OTHER;
+
+long long AllocationCounts::get_total_count() const
+{
+    long long total = 0;
+    for (int tag = 0; tag < TAG_COUNT; tag++) total += count[tag];
+    return total;
+}
+
+long long AllocationCounts::get_total_bytes() const
+{
+    long long total = 0;
+    for (int tag = 0; tag < TAG_COUNT; tag++) total += bytes[tag];
+    return total;
+}
+
+AllocationCounts operator-(const AllocationCounts &later, const AllocationCounts &earlier)
+{
+    AllocationCounts difference;
+    for (int tag = 0; tag < TAG_COUNT; tag++)
+    {
+        difference.count[tag] = later.count[tag] - earlier.count[tag];
+        difference.bytes[tag] = later.bytes[tag] - earlier.bytes[tag];
+    }
+    return difference;
+}
+
+bool is_allocation_tracking_enabled()
+{
+#ifdef RISE_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounts get_allocation_counts()
+{
+    AllocationCounts counts;
+    for (int tag = 0; tag < TAG_COUNT; tag++)
+    {
+        counts.count[tag] = s_counts[tag].load(std::memory_order_relaxed);
+        counts.bytes[tag] = s_bytes[tag].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+AllocationScope::AllocationScope(AllocationTag tag) : m_previous(t_tag)
+{
+    t_tag = tag;
+}
+
+AllocationScope::~AllocationScope()
+{
+    t_tag = m_previous;
+}
+
+void FrameAllocationStats::add_frame(double ms, const AllocationCounts &frame)
+{
+    long long count = frame.get_total_count(),
+              bytes = frame.get_total_bytes();
+
+    frames++;
+    if (count > 0) allocating_frames++;
+    total_ms   += ms;
+    peak_ms     = std::max(peak_ms, ms);
+    peak_count  = std::max(peak_count, count);
+    peak_bytes  = std::max(peak_bytes, bytes);
+
+    for (int tag = 0; tag < TAG_COUNT; tag++)
+    {
+        total.count[tag] += frame.count[tag];
+        total.bytes[tag] += frame.bytes[tag];
+    }
+}
+
+// ————— GLOBAL OPERATOR NEW ————— //
+#ifdef RISE_TRACK_ALLOCATIONS
+static void *tracked_allocate(size_t size)
+{
+    s_counts[t_tag].fetch_add(1, std::memory_order_relaxed);
+    s_bytes[t_tag].fetch_add((long long) size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new(size_t size)
+{
+    void *memory = tracked_allocate(size);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    void *memory = tracked_allocate(size);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept   { return tracked_allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return tracked_allocate(size); }
+
+void operator delete(void *memory) noexcept                          { std::free(memory); }
+void operator delete[](void *memory) noexcept                        { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept                  { std::free(memory); }
+void operator delete[](void *memory, size_t) noexcept                { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept   { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+
+// Over-aligned types (Entity, EntityBody, World) come through these instead
+#ifdef __cpp_aligned_new
+static void *tracked_allocate(size_t size, std::align_val_t alignment)
+{
+    s_counts[t_tag].fetch_add(1, std::memory_order_relaxed);
+    s_bytes[t_tag].fetch_add((long long) size, std::memory_order_relaxed);
+
+#ifdef _WINDOWS
+    return _aligned_malloc(size == 0 ? 1 : size, (size_t) alignment);
+#else
+    void *memory = nullptr;
+    if (posix_memalign(&memory, std::max((size_t) alignment, sizeof(void *)), size == 0 ? 1 : size) != 0) return nullptr;
+    return memory;
+#endif
+}
+
+static void tracked_free(void *memory)
+{
+#ifdef _WINDOWS
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    void *memory = tracked_allocate(size, alignment);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    void *memory = tracked_allocate(size, alignment);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return tracked_allocate(size, alignment);
+}
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return tracked_allocate(size, alignment);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept                           { tracked_free(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept                         { tracked_free(memory); }
+void operator delete(void *memory, size_t, std::align_val_t) noexcept                   { tracked_free(memory); }
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept                 { tracked_free(memory); }
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept   { tracked_free(memory); }
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept { tracked_free(memory); }
+#endif
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+// ————— ALLOCATION TRACKING ————— //
+// Builds with RISE_TRACK_ALLOCATIONS replace the global operator new and delete with ones
+// that count every allocation and its bytes, by the tag of the thread that made it. A
+// thread's tag is whatever the innermost AllocationScope on it says, and "other" outside
+// any. Other builds leave the allocator alone and every count stays at zero, so scopes
+// and reports can stay in place either way.
+//
+// Counts only grow; what a frame allocated is the difference of two get_allocation_counts().
+enum AllocationTag
+{
+    TAG_OTHER,
+    TAG_WORLD,    // World::update, the planner and its pools
+    TAG_EFFECTS,  // particle updates
+    TAG_SNAPSHOT, // filling the render thread's snapshot
+    TAG_DRAW,     // the render thread
+    TAG_JOBS,     // job system workers, between jobs and in them
+    TAG_COUNT
+};
+
+extern const char *const ALLOCATION_TAG_NAMES[TAG_COUNT];
+
+struct AllocationCounts
+{
+    long long count[TAG_COUNT] = {};
+    long long bytes[TAG_COUNT] = {};
+
+    long long get_total_count() const;
+    long long get_total_bytes() const;
+};
+
+AllocationCounts operator-(const AllocationCounts &later, const AllocationCounts &earlier);
+
+// Whether this build counts allocations at all
+bool is_allocation_tracking_enabled();
+
+// Everything allocated so far, on every thread
+AllocationCounts get_allocation_counts();
+
+// Tags this thread's allocations from construction to destruction, then restores the tag
+// that was there before
+class AllocationScope
+{
+    AllocationTag m_previous;
+
+public:
+    explicit AllocationScope(AllocationTag tag);
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+};
+
+// Frame times and what the frames allocated, summed over the frames added. A steady-state
+// frame should allocate nothing.
+struct FrameAllocationStats
+{
+    long long frames            = 0,
+              allocating_frames = 0; // frames that allocated anything at all
+    double    total_ms = 0.0,
+              peak_ms  = 0.0;
+    long long peak_count = 0,        // the most allocations and bytes one frame made
+              peak_bytes = 0;
+    AllocationCounts total;
+
+    void add_frame(double ms, const AllocationCounts &frame);
+    void reset() { *this = FrameAllocationStats(); }
+
+    double get_average_ms() const { return frames ? total_ms / frames : 0.0; }
+};
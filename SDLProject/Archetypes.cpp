@@ -0,0 +1,169 @@
+#include "Archetypes.h"
+#include "EnemyAI.h"
+
+constexpr ComponentType ComponentTraits<EntityBody>::TYPE;
+constexpr ComponentType ComponentTraits<BoxComponent>::TYPE;
+constexpr ComponentType ComponentTraits<SpriteComponent>::TYPE;
+constexpr ComponentType ComponentTraits<AnimationComponent>::TYPE;
+constexpr ComponentType ComponentTraits<AIComponent>::TYPE;
+
+// ————— ARCHETYPE ————— //
+int Archetype::add(int id)
+{
+    int row = m_count++;
+    grow_column<EntityBody>(m_count);
+    grow_column<BoxComponent>(m_count);
+    grow_column<SpriteComponent>(m_count);
+    grow_column<AnimationComponent>(m_count);
+    grow_column<AIComponent>(m_count);
+    m_ids.push_back(id);
+    return row;
+}
+
+int Archetype::remove(int row)
+{
+    int last = --m_count;
+    int moved = -1;
+    if (row != last)
+    {
+        move_row<EntityBody>(last, row);
+        move_row<BoxComponent>(last, row);
+        move_row<SpriteComponent>(last, row);
+        move_row<AnimationComponent>(last, row);
+        move_row<AIComponent>(last, row);
+        m_ids[row] = m_ids[last];
+        moved = m_ids[row];
+    }
+
+    grow_column<EntityBody>(m_count);
+    grow_column<BoxComponent>(m_count);
+    grow_column<SpriteComponent>(m_count);
+    grow_column<AnimationComponent>(m_count);
+    grow_column<AIComponent>(m_count);
+    m_ids.pop_back();
+    return moved;
+}
+
+size_t const Archetype::get_memory_bytes() const
+{
+    size_t row_bytes = sizeof(int);
+    if (m_mask & mask_of<EntityBody>())         row_bytes += sizeof(EntityBody);
+    if (m_mask & mask_of<BoxComponent>())       row_bytes += sizeof(BoxComponent);
+    if (m_mask & mask_of<SpriteComponent>())    row_bytes += sizeof(SpriteComponent);
+    if (m_mask & mask_of<AnimationComponent>()) row_bytes += sizeof(AnimationComponent);
+    if (m_mask & mask_of<AIComponent>())        row_bytes += sizeof(AIComponent);
+    return row_bytes * m_count;
+}
+
+// ————— COMPONENT STORE ————— //
+int ComponentStore::spawn(ComponentMask mask)
+{
+    int archetype = 0;
+    while (archetype < (int) m_archetypes.size() && m_archetypes[archetype].get_mask() != mask) archetype++;
+    if (archetype == (int) m_archetypes.size()) m_archetypes.push_back(Archetype(mask));
+
+    Location location;
+    location.archetype = archetype;
+    location.row       = m_archetypes[archetype].add((int) m_locations.size());
+    m_locations.push_back(location);
+    return (int) m_locations.size() - 1;
+}
+
+int ComponentStore::spawn_from(const Entity &entity)
+{
+    const ComponentMask STATIC_OBJECT = mask_of<BoxComponent, SpriteComponent>(),
+                        MOVER         = mask_of<EntityBody, SpriteComponent, AnimationComponent>(),
+                        ENEMY_OBJECT  = mask_of<EntityBody, SpriteComponent, AnimationComponent, AIComponent>();
+
+    ComponentMask mask = entity.get_entity_type() == PLATFORM ? STATIC_OBJECT :
+                         entity.get_entity_type() == ENEMY    ? ENEMY_OBJECT  : MOVER;
+    int id = spawn(mask);
+
+    *get<SpriteComponent>(id) = entity.get_sprite();
+    if (EntityBody *body = get<EntityBody>(id)) *body = entity.get_body();
+    if (AnimationComponent *animation = get<AnimationComponent>(id)) *animation = entity.get_animation();
+    if (AIComponent *ai = get<AIComponent>(id)) *ai = entity.get_ai();
+    if (BoxComponent *box = get<BoxComponent>(id))
+    {
+        box->position = entity.get_position();
+        box->width    = entity.get_width();
+        box->height   = entity.get_height();
+    }
+    return id;
+}
+
+bool ComponentStore::remove(int id)
+{
+    if (id < 0 || id >= (int) m_locations.size() || m_locations[id].archetype < 0) return false;
+
+    Location &location = m_locations[id];
+    int moved = m_archetypes[location.archetype].remove(location.row);
+    if (moved >= 0) m_locations[moved].row = location.row;
+
+    location.archetype = -1;
+    location.row       = -1;
+    return true;
+}
+
+int const ComponentStore::get_count() const
+{
+    int count = 0;
+    for (const Archetype &archetype : m_archetypes) count += archetype.get_count();
+    return count;
+}
+
+size_t const ComponentStore::get_memory_bytes() const
+{
+    size_t bytes = m_locations.size() * sizeof(Location);
+    for (const Archetype &archetype : m_archetypes) bytes += archetype.get_memory_bytes();
+    return bytes;
+}
+
+// ————— SYSTEMS ————— //
+void ai_system(ComponentStore &store, AIContext &context)
+{
+    const ComponentMask AGENT = mask_of<EntityBody, AIComponent, AnimationComponent>();
+    store.each_archetype(AGENT, [&context](Archetype &archetype) {
+        EntityBody         *bodies     = archetype.column<EntityBody>();
+        AIComponent        *ai         = archetype.column<AIComponent>();
+        AnimationComponent *animations = archetype.column<AnimationComponent>();
+
+        for (int row = 0; row < archetype.get_count(); row++)
+        {
+            if (!bodies[row].is_active) continue;
+            AIAgent agent(bodies[row], ai[row], animations[row], archetype.get_id(row));
+            run_ai_agent(agent, context);
+        }
+    });
+}
+
+void animation_system(ComponentStore &store, float delta_time)
+{
+    store.each<EntityBody, AnimationComponent>([delta_time](EntityBody &body, AnimationComponent &animation) {
+        if (body.is_active) animation.step(body, delta_time);
+    });
+}
+
+void physics_system(ComponentStore &store, float delta_time, Map *map, const StaticColliders *statics,
+                    KinematicBatch *batch)
+{
+    store.each_archetype(mask_of<EntityBody>(), [=](Archetype &archetype) {
+        update_bodies(archetype.column<EntityBody>(), archetype.get_count(), delta_time, map, statics, batch);
+    });
+}
+
+void render_system(ComponentStore &store, ShaderProgram *program)
+{
+    const glm::vec4 WHOLE_TEXTURE(0.0f, 0.0f, 1.0f, 1.0f);
+
+    store.each<EntityBody, SpriteComponent, AnimationComponent>(
+        [program](EntityBody &body, SpriteComponent &sprite, AnimationComponent &animation) {
+            if (body.is_active) draw_sprite(program, body.position, sprite, animation.get_uv_rect());
+        });
+    store.each<EntityBody, SpriteComponent>([&](EntityBody &body, SpriteComponent &sprite) {
+        if (body.is_active) draw_sprite(program, body.position, sprite, WHOLE_TEXTURE);
+    }, mask_of<AnimationComponent>());
+    store.each<BoxComponent, SpriteComponent>([&](BoxComponent &box, SpriteComponent &sprite) {
+        draw_sprite(program, box.position, sprite, WHOLE_TEXTURE);
+    });
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <tuple>
+#include <vector>
+#include "Entity.h"
+
+class StaticColliders;
+struct AIContext;
+
+// ————— COMPONENTS ————— //
+// What an object in a ComponentStore may be made of. Movers have an EntityBody; things
+// that never move (platforms) only a BoxComponent. The rest are declared in Entity.h.
+enum ComponentType { COMPONENT_BODY, COMPONENT_BOX, COMPONENT_SPRITE, COMPONENT_ANIMATION, COMPONENT_AI, COMPONENT_COUNT };
+
+typedef unsigned int ComponentMask; // bit t set for ComponentType t
+
+// Where a static object is and how big; 20 bytes in place of a 64-byte body
+struct BoxComponent
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float     width    = 1.0f,
+              height   = 1.0f;
+};
+
+template <typename C> struct ComponentTraits;
+template <> struct ComponentTraits<EntityBody>         { static constexpr ComponentType TYPE = COMPONENT_BODY;      };
+template <> struct ComponentTraits<BoxComponent>       { static constexpr ComponentType TYPE = COMPONENT_BOX;       };
+template <> struct ComponentTraits<SpriteComponent>    { static constexpr ComponentType TYPE = COMPONENT_SPRITE;    };
+template <> struct ComponentTraits<AnimationComponent> { static constexpr ComponentType TYPE = COMPONENT_ANIMATION; };
+template <> struct ComponentTraits<AIComponent>        { static constexpr ComponentType TYPE = COMPONENT_AI;        };
+
+template <typename... Cs> constexpr ComponentMask mask_of()
+{
+    const ComponentMask bits[] = { 0u, (1u << ComponentTraits<Cs>::TYPE)... };
+    ComponentMask mask = 0;
+    for (ComponentMask bit : bits) mask |= bit;
+    return mask;
+}
+
+// ————— ARCHETYPE ————— //
+// Every object with exactly one set of components, one contiguous column per component it
+// has; the columns of the components it lacks stay empty. Row r of every column is the same
+// object. Removing a row moves the last one into it, so rows are dense but not stable.
+class Archetype
+{
+    ComponentMask m_mask;
+    int           m_count = 0;
+
+    std::tuple<std::vector<EntityBody>, std::vector<BoxComponent>, std::vector<SpriteComponent>,
+               std::vector<AnimationComponent>, std::vector<AIComponent>> m_columns;
+    std::vector<int> m_ids; // the store's id of each row
+
+    template <typename C> void grow_column(int count)
+    {
+        if (m_mask & mask_of<C>()) std::get<std::vector<C>>(m_columns).resize(count);
+    }
+    template <typename C> void move_row(int from, int to)
+    {
+        if (m_mask & mask_of<C>())
+        {
+            std::vector<C> &column = std::get<std::vector<C>>(m_columns);
+            column[to] = column[from];
+        }
+    }
+    template <typename F, typename... Cs> void each_row(F &f, Cs *... columns)
+    {
+        for (int row = 0; row < m_count; row++) f(columns[row]...);
+    }
+
+public:
+    explicit Archetype(ComponentMask mask) : m_mask(mask) { }
+
+    // Appends a row of default components and returns its index
+    int add(int id);
+
+    // Swap-removes row; returns the id of the object now in it, or -1 if row was the last
+    int remove(int row);
+
+    template <typename C> C *column()
+    {
+        return m_mask & mask_of<C>() ? std::get<std::vector<C>>(m_columns).data() : nullptr;
+    }
+    template <typename C> const C *column() const
+    {
+        return const_cast<Archetype *>(this)->column<C>();
+    }
+
+    // Calls f(row's C&...) for every row
+    template <typename... Cs, typename F> void each(F &f) { each_row(f, column<Cs>()...); }
+
+    ComponentMask const get_mask()  const { return m_mask;  }
+    int           const get_count() const { return m_count; }
+    int           const get_id(int row) const { return m_ids[row]; }
+    size_t        const get_memory_bytes() const; // of the columns it fills, not of spare capacity
+};
+
+// ————— COMPONENT STORE ————— //
+// Objects kept by archetype, so each holds only the components it uses and a system that
+// wants bodies walks packed bodies rather than whole Entities. Ids are stable: an object
+// keeps its id wherever its row moves to, until it is removed.
+class ComponentStore
+{
+    struct Location
+    {
+        int archetype = -1,
+            row       = -1;
+    };
+
+    std::vector<Archetype> m_archetypes;
+    std::vector<Location>  m_locations; // by id; archetype -1 once removed
+
+public:
+    // A new object with the components in mask, all defaulted; returns its id
+    int spawn(ComponentMask mask);
+
+    // A copy of entity's state, with the components its EntityType needs: a platform is a
+    // box and a sprite, the player a body, sprite and animation, an enemy all of that and AI
+    int spawn_from(const Entity &entity);
+
+    bool remove(int id);
+
+    // Component C of object id, or nullptr if it is gone or has no C
+    template <typename C> C *get(int id)
+    {
+        if (id < 0 || id >= (int) m_locations.size() || m_locations[id].archetype < 0) return nullptr;
+        C *column = m_archetypes[m_locations[id].archetype].column<C>();
+        return column ? column + m_locations[id].row : nullptr;
+    }
+
+    // Calls f(C&...) for every object with all of Cs and none of exclude. Archetypes that
+    // match are walked column by column, so f sees each archetype's rows in order.
+    template <typename... Cs, typename F> void each(F f, ComponentMask exclude = 0)
+    {
+        const ComponentMask required = mask_of<Cs...>();
+        for (Archetype &archetype : m_archetypes)
+        {
+            if ((archetype.get_mask() & required) != required || (archetype.get_mask() & exclude) != 0) continue;
+            archetype.each<Cs...>(f);
+        }
+    }
+
+    // Calls f(archetype) for every archetype with all of the components in mask, for
+    // systems that take a whole column at once
+    template <typename F> void each_archetype(ComponentMask mask, F f)
+    {
+        for (Archetype &archetype : m_archetypes)
+            if ((archetype.get_mask() & mask) == mask) f(archetype);
+    }
+
+    int    const get_count() const;
+    int    const get_archetype_count() const { return (int) m_archetypes.size(); }
+    size_t const get_memory_bytes() const; // columns plus the id table
+};
+
+// ————— SYSTEMS ————— //
+// Together these do what Entity::update and run_ai do for Entities, column by column:
+// ai_system, then animation_system, then physics_system gives the same bodies as AI
+// followed by Entity::update without collidable entities.
+void ai_system(ComponentStore &store, AIContext &context);
+void animation_system(ComponentStore &store, float delta_time);
+void physics_system(ComponentStore &store, float delta_time, Map *map, const StaticColliders *statics = nullptr,
+                    KinematicBatch *batch = nullptr); // see update_bodies()
+
+// Draws every object with a sprite: animated frames for those with an animation, the whole
+// texture for the rest
+void render_system(ComponentStore &store, ShaderProgram *program);
@@ -0,0 +1,2471 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <tuple>
+#include <vector>
+#include "Benchmark.h"
+#include "VecEnv.h"
+#include "EnemyAI.h"
+#include "PixelObservation.h"
+#include "Texture.h"
+#include "Float4.h"
+#include "Archetypes.h"
+#include "Kinematics.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
+#include "PartitionedWorld.h"
+#include "TileStorage.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define LOG(argument) std::cout << argument << '\n'
+
+// Set by a benchmark whose check failed, so that run_benchmark() can say so
+static bool g_failed = false;
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double seconds_since(BenchClock::time_point start)
+{
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Last-level cache misses of this thread, counted by the CPU. Only Linux exposes the
+// counters (and only if perf_event_paranoid allows); elsewhere is_available() is false
+// and the benchmarks report times alone.
+class CacheMissCounter
+{
+    int m_fd = -1;
+
+public:
+    CacheMissCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type           = PERF_TYPE_HARDWARE;
+        attributes.size           = sizeof(attributes);
+        attributes.config         = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled       = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        m_fd = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+    }
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    bool is_available() const { return m_fd >= 0; }
+
+    void start()
+    {
+#ifdef __linux__
+        if (m_fd < 0) return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Misses since start(), or 0 without counters
+    long long stop()
+    {
+        long long count = 0;
+#ifdef __linux__
+        if (m_fd < 0) return 0;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+};
+
+// ————— VEC ENV ————— //
+// Steps 4096 worlds with random actions for a few seconds on every hardware thread
+static void bench_vec_env()
+{
+    const int ENV_COUNT = 4096;
+    VecEnv env(ENV_COUNT);
+
+    std::vector<int>           actions(ENV_COUNT);
+    std::vector<float>         rewards(ENV_COUNT);
+    std::vector<unsigned char> dones(ENV_COUNT);
+
+    unsigned int rng = 12345u;
+    long long steps = 0;
+    int episodes = 0;
+
+    BenchClock::time_point start = BenchClock::now();
+    while (seconds_since(start) < 3.0)
+    {
+        for (int i = 0; i < ENV_COUNT; i++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            actions[i] = (int) ((rng >> 16) % ACTION_COUNT);
+        }
+
+        env.step(actions.data(), rewards.data(), dones.data());
+        steps += ENV_COUNT;
+        for (int i = 0; i < ENV_COUNT; i++) episodes += dones[i];
+    }
+    double elapsed = seconds_since(start);
+
+    LOG("vec_env: " << ENV_COUNT << " worlds on " << env.get_thread_count() << " threads");
+    LOG("  " << (long long) (steps / elapsed) << " env steps/s, "
+        << (long long) (steps / elapsed / env.get_thread_count()) << " per thread, "
+        << episodes << " episodes finished");
+
+    // No worlds at all: one thread, and steps that do nothing
+    VecEnv empty(0);
+    empty.step(nullptr, nullptr, nullptr);
+    LOG("  an empty VecEnv: " << empty.get_env_count() << " worlds on " << empty.get_thread_count() << " thread");
+    if (empty.get_env_count() != 0 || empty.get_thread_count() != 1) g_failed = true;
+}
+
+// ————— TICK PIPELINE ————— //
+static std::string describe_world_data(unsigned int data)
+{
+    const char *NAMES[] = { "player", "enemies", "enemy AI", "projectiles", "navigation", "motion", "candidates",
+                            "contacts", "outcome" };
+    std::string text;
+    for (int bit = 0; bit < (int) (sizeof(NAMES) / sizeof(NAMES[0])); bit++)
+        if (data & (1u << bit)) text += std::string(text.empty() ? "" : ", ") + NAMES[bit];
+    return text;
+}
+
+// Plays many copies of the level with random inputs and reports each phase's share of a
+// tick, and what each one reads and writes
+static void bench_pipeline()
+{
+    const int WORLD_COUNT = 1024, TICKS = 600;
+    Map map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, 0, 1.0f, 3, 1);
+
+    std::vector<World> worlds(WORLD_COUNT);
+    TickTimings timings;
+    for (int i = 0; i < WORLD_COUNT; i++)
+    {
+        worlds[i].initialise(WorldTextures(), &map, (i % 7) * 0.03f);
+        worlds[i].timings = &timings;
+    }
+    NavLevel nav;
+    nav.add_enemies(map, worlds[0].enemies.data(), worlds[0].enemies.get_count());
+    StaticColliders statics(map, worlds[0].platforms, PLATFORM_COUNT);
+
+    unsigned int rng = 2024u;
+    int finished = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        for (World &world : worlds)
+        {
+            if (world.status != WORLD_RUNNING)
+            {
+                finished++;
+                world.initialise(WorldTextures(), &map);
+                world.timings = &timings;
+            }
+            rng = rng * 1664525u + 1013904223u;
+            world.apply_action((WorldAction) ((rng >> 16) % ACTION_COUNT));
+            world.update(FIXED_TIMESTEP, &map, &nav, &statics);
+        }
+    }
+    double total_ms = seconds_since(start) * 1e3;
+
+    double phase_total = 0.0;
+    for (double ms : timings.phase_ms) phase_total += ms;
+
+    LOG("pipeline: " << WORLD_COUNT << " worlds x " << TICKS << " ticks, " << finished << " episodes finished; "
+        << total_ms / timings.ticks * 1e3 << " us per world tick (" << phase_total / total_ms * 100.0
+        << "% inside phases)");
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        LOG("  " << TICK_PHASES[phase].name << ": " << timings.get_average_ms((TickPhase) phase) * 1e3 << " us ("
+            << timings.phase_ms[phase] / phase_total * 100.0 << "%); reads " << describe_world_data(TICK_PHASES[phase].reads)
+            << "; writes " << describe_world_data(TICK_PHASES[phase].writes));
+    }
+}
+
+// ————— RENDER THREAD ————— //
+// A frame's simulation (ticks of a few hundred worlds, to give it some weight) against a
+// draw that blocks for 8 ms, as a busy driver or vsync does: once inline, as the game
+// used to run, and once with the draw on a RenderThread fed snapshots. No GL is touched;
+// the blocking stands in for all of it.
+static void bench_render_thread()
+{
+    const int   WORLD_COUNT = 512, FRAMES = 240;
+    const auto  DRAW_BLOCK  = std::chrono::milliseconds(8);
+    Map map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, 0, 1.0f, 3, 1);
+
+    std::vector<World> worlds(WORLD_COUNT);
+    for (int i = 0; i < WORLD_COUNT; i++) worlds[i].initialise(WorldTextures(), &map, (i % 7) * 0.03f);
+    NavLevel nav;
+    nav.add_enemies(map, worlds[0].enemies.data(), worlds[0].enemies.get_count());
+    StaticColliders statics(map, worlds[0].platforms, PLATFORM_COUNT);
+
+    unsigned int rng = 2024u;
+    auto simulate = [&](RenderSnapshot *snapshot) {
+        for (World &world : worlds)
+        {
+            if (world.status != WORLD_RUNNING) world.initialise(WorldTextures(), &map);
+            rng = rng * 1664525u + 1013904223u;
+            world.apply_action((WorldAction) ((rng >> 16) % ACTION_COUNT));
+            world.update(FIXED_TIMESTEP, &map, &nav, &statics);
+        }
+        worlds[0].player.snapshot(snapshot);
+        for (Entity &enemy : worlds[0].enemies) enemy.snapshot(snapshot);
+        worlds[0].projectiles.snapshot(snapshot);
+    };
+    auto draw = [&](const RenderSnapshot &, FrameArena *) { std::this_thread::sleep_for(DRAW_BLOCK); };
+
+    RenderSnapshot inline_snapshot;
+    BenchClock::time_point start = BenchClock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        inline_snapshot.clear();
+        simulate(&inline_snapshot);
+        draw(inline_snapshot, nullptr);
+    }
+    double inline_ms = seconds_since(start) * 1e3 / FRAMES;
+
+    RenderStats stats;
+    double threaded_ms;
+    {
+        RenderThread renderer(nullptr, nullptr, draw);
+        start = BenchClock::now();
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            simulate(&renderer.get_snapshot());
+            renderer.publish();
+        }
+        threaded_ms = seconds_since(start) * 1e3 / FRAMES;
+        stats = renderer.get_stats();
+    }
+
+    LOG("render_thread: " << WORLD_COUNT << " worlds a frame, draws blocking " << DRAW_BLOCK.count() << " ms");
+    LOG("  inline: " << inline_ms << " ms per simulated frame");
+    LOG("  render thread: " << threaded_ms << " ms per simulated frame (" << inline_ms / threaded_ms << "x); "
+        << stats.drawn << " of " << stats.published << " snapshots drawn, " << stats.skipped << " skipped");
+}
+
+// ————— FRAME ARENA ————— //
+// A frame's worth of text quads (what draw_text builds), in vectors from the heap and in
+// arena vectors, and whether the arena still reaches the heap once it has settled
+template <typename Vector>
+static float build_text_quads(Vector &vertices, Vector &texture_coordinates, int length)
+{
+    vertices.reserve(length * 12);
+    texture_coordinates.reserve(length * 12);
+    for (int i = 0; i < length; i++)
+    {
+        float offset = 0.55f * i;
+        vertices.insert(vertices.end(), {
+            offset - 0.25f, 0.25f, offset - 0.25f, -0.25f, offset + 0.25f, 0.25f,
+            offset + 0.25f, -0.25f, offset + 0.25f, 0.25f, offset - 0.25f, -0.25f
+        });
+        texture_coordinates.insert(texture_coordinates.end(), {
+            0.0f, 0.0f, 0.0f, 0.0625f, 0.0625f, 0.0f, 0.0625f, 0.0625f, 0.0625f, 0.0f, 0.0f, 0.0625f
+        });
+    }
+    return vertices.back() + texture_coordinates.back();
+}
+
+static void bench_arena()
+{
+    const int FRAMES = 20000, TEXTS = 64;
+    float sink = 0.0f;
+
+    BenchClock::time_point start = BenchClock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+        for (int text = 0; text < TEXTS; text++)
+        {
+            std::vector<float> vertices, texture_coordinates;
+            sink += build_text_quads(vertices, texture_coordinates, 8 + (frame + text) % 24);
+        }
+    double heap_us = seconds_since(start) * 1e6 / FRAMES;
+
+    // Starts too small on purpose, to show it growing once and then staying put
+    FrameArena arena(1024);
+    start = BenchClock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        for (int text = 0; text < TEXTS; text++)
+        {
+            ArenaVector<float> vertices{ArenaAllocator<float>(&arena)};
+            ArenaVector<float> texture_coordinates{ArenaAllocator<float>(&arena)};
+            sink += build_text_quads(vertices, texture_coordinates, 8 + (frame + text) % 24);
+        }
+        arena.reset();
+    }
+    double arena_us = seconds_since(start) * 1e6 / FRAMES;
+
+    LOG("arena: " << TEXTS << " strings of 8-31 characters a frame, " << FRAMES << " frames (" << sink << ")");
+    LOG("  heap vectors: " << heap_us << " us per frame, " << 2 * TEXTS << " allocations");
+    LOG("  arena vectors: " << arena_us << " us per frame (" << heap_us / arena_us << "x); peak " << arena.get_peak()
+        << " of " << arena.get_capacity() << " bytes, grew " << arena.get_grows() << " times");
+}
+
+// ————— ALLOCATIONS ————— //
+// The game's frame without a window: the world's ticks, the particles' update and the CPU
+// side of render(), filling and publishing the snapshot as main.cpp does. Fails if any
+// frame after the warm-up touches the heap. A level restart (once the world is won or
+// lost, and the end screen has had its frames) is a load, not a frame, so it is left out.
+static void bench_allocations()
+{
+    const int FRAMES = 10000, WARM_UP = 120, END_SCREEN_FRAMES = 60, BURST_INTERVAL = 200;
+
+    if (!is_allocation_tracking_enabled())
+    {
+        LOG("allocations: this build does not count them; build with RISE_TRACK_ALLOCATIONS");
+        return;
+    }
+
+    Map map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, 0, 1.0f, 3, 1);
+    World world;
+    world.initialise(WorldTextures(), &map);
+    NavLevel nav;
+    nav.add_enemies(map, world.enemies.data(), world.enemies.get_count());
+    StaticColliders statics(map, world.platforms, PLATFORM_COUNT);
+
+    ParticleSystem effects(4096);
+    effects.set_budget(2048);
+    for (int style = 0; style < EFFECT_COUNT; style++)
+    {
+        ParticleStyle look;
+        look.texture = (GLuint) style + 1; // distinct, so there is one batch each
+        look.gravity = style == EFFECT_DEBRIS ? -9.81f : 0.0f;
+        effects.set_style(style, look);
+    }
+    world.effects = &effects;
+
+    JobSystem    jobs(4);
+    RenderThread renderer(nullptr, nullptr, [](const RenderSnapshot &, FrameArena *) {});
+    renderer.reserve(1 + PLATFORM_COUNT + world.enemies.get_capacity(), 4096 + World::PROJECTILE_CAPACITY,
+                     ParticleSystem::MAX_STYLES + 1, 1);
+
+    FrameAllocationStats stats;
+    AllocationCounts     first_bad;
+    int first_bad_frame = -1, restarts = 0, end_frames = 0;
+    unsigned int rng = 777u;
+
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        if (world.status != WORLD_RUNNING && end_frames++ == END_SCREEN_FRAMES)
+        {
+            world.initialise(WorldTextures(), &map);
+            end_frames = 0;
+            restarts++;
+        }
+
+        AllocationCounts before = get_allocation_counts();
+        BenchClock::time_point start = BenchClock::now();
+
+        if (world.status == WORLD_RUNNING)
+        {
+            AllocationScope scope(TAG_WORLD);
+            rng = rng * 1664525u + 1013904223u;
+            world.apply_action((WorldAction) ((rng >> 16) % ACTION_COUNT));
+            world.update(FIXED_TIMESTEP, &map, &nav, &statics);
+        }
+        {
+            // Now and then a burst big enough for the quads to be written as jobs
+            AllocationScope scope(TAG_EFFECTS);
+            if (frame % BURST_INTERVAL == 0) effects.emit(EFFECT_DUST, world.player.get_position(), glm::vec3(0.0f), 3.0f, 1500);
+            effects.update(FIXED_TIMESTEP);
+        }
+        {
+            AllocationScope scope(TAG_SNAPSHOT);
+            RenderSnapshot &snapshot = renderer.get_snapshot();
+            world.player.snapshot(&snapshot);
+            for (Entity &enemy : world.enemies) enemy.snapshot(&snapshot);
+            world.projectiles.snapshot(&snapshot);
+            effects.snapshot(&snapshot, &jobs);
+            if (world.status != WORLD_RUNNING)
+                snapshot.add_text(world.status == WORLD_WON ? "You Win!" : "You Lose!", 0.5f, 0.05f,
+                                  world.player.get_position());
+            renderer.publish();
+        }
+
+        AllocationCounts allocated = get_allocation_counts() - before;
+        if (frame < WARM_UP) continue;
+
+        stats.add_frame(seconds_since(start) * 1e3, allocated);
+        if (allocated.get_total_count() > 0 && first_bad_frame < 0)
+        {
+            first_bad_frame = frame;
+            first_bad       = allocated;
+        }
+    }
+
+    LOG("allocations: " << stats.frames << " frames after " << WARM_UP << " of warm-up, " << restarts
+        << " level restarts left out");
+    LOG("  " << stats.get_average_ms() << " ms per frame (worst " << stats.peak_ms << "), "
+        << stats.allocating_frames << " frames allocated, worst " << stats.peak_count << " allocations / "
+        << stats.peak_bytes << " bytes");
+    if (first_bad_frame < 0)
+    {
+        LOG("  passed: no frame touched the heap");
+        return;
+    }
+
+    std::cout << "  FAILED: frame " << first_bad_frame << " allocated";
+    for (int tag = 0; tag < TAG_COUNT; tag++)
+        if (first_bad.count[tag] > 0)
+            std::cout << ' ' << ALLOCATION_TAG_NAMES[tag] << ' ' << first_bad.count[tag] << " (" << first_bad.bytes[tag]
+                      << " bytes)";
+    std::cout << std::endl;
+    g_failed = true;
+}
+
+// ————— OBSERVATIONS ————— //
+// Observation cost per env step, alongside the simulation, and incremental vs full builds
+static float *align_floats(std::vector<float> &storage, size_t count, size_t alignment)
+{
+    storage.resize(count + alignment / sizeof(float));
+    uintptr_t address = (uintptr_t) storage.data();
+    return (float *) ((address + alignment - 1) / alignment * alignment);
+}
+
+static void bench_observation()
+{
+    const int ENV_COUNT = 4096, STEPS = 300;
+    VecEnv env(ENV_COUNT);
+
+    std::vector<float> storage;
+    float *observations = align_floats(storage, (size_t) ENV_COUNT * ObservationBuilder::FLOATS_PER_ENV,
+                                       ObservationBuilder::OBSERVATION_ALIGNMENT);
+
+    std::vector<int>           actions(ENV_COUNT);
+    std::vector<float>         rewards(ENV_COUNT);
+    std::vector<unsigned char> dones(ENV_COUNT);
+
+    unsigned int rng = 12345u;
+    env.observe(observations);
+    env.reset_observation_timers();
+
+    BenchClock::time_point start = BenchClock::now();
+    for (int step = 0; step < STEPS; step++)
+    {
+        for (int i = 0; i < ENV_COUNT; i++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            actions[i] = (int) ((rng >> 16) % ACTION_COUNT);
+        }
+        env.step(actions.data(), rewards.data(), dones.data(), observations);
+    }
+    double elapsed = seconds_since(start);
+
+    LOG("observation: " << ObservationBuilder::FLOATS_PER_ENV << " floats per world ("
+        << ObservationBuilder::CHANNEL_COUNT << "x" << ObservationBuilder::VIEW_HEIGHT << "x"
+        << ObservationBuilder::VIEW_WIDTH << " grid + " << ObservationBuilder::STATE_SIZE << " state)");
+    LOG("  incremental build: " << env.get_observation_ns_per_step() << " ns per env step");
+    LOG("  step + observe:    " << (long long) (ENV_COUNT * (double) STEPS / elapsed) << " env steps/s");
+
+    // Same world, but alternating between two blocks forces a full rebuild every time
+    ObservationBuilder builder(1);
+    const World &world = env.get_world(0);
+    float *blocks[2] = { observations, observations + ObservationBuilder::FLOATS_PER_ENV };
+    const int BUILDS = 1000000;
+
+    start = BenchClock::now();
+    for (int i = 0; i < BUILDS; i++) builder.build(0, world, env.get_map(), blocks[i & 1]);
+    double full_ns = seconds_since(start) * 1e9 / BUILDS;
+
+    start = BenchClock::now();
+    for (int i = 0; i < BUILDS; i++) builder.build(0, world, env.get_map(), blocks[0]);
+    double patch_ns = seconds_since(start) * 1e9 / BUILDS;
+
+    LOG("  single world: full rebuild " << full_ns << " ns, unchanged-view patch " << patch_ns << " ns");
+}
+
+// ————— AI DISPATCH ————— //
+// 10k enemies of shuffled AI types: the per-enemy switch (once, and twice as the tick
+// used to call it) against one specialised pass per type over sorted groups
+static void bench_ai_dispatch()
+{
+    const int ENEMY_TOTAL = 10000, TICKS = 2000;
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    const AIState STATES[AI_TYPE_COUNT] = { WALKING, WALKING, JUMPING, PATROLLING, SHOOTING };
+
+    Entity player(0, 3.0f, glm::vec3(0.0f, -4.905f, 0.0f), 5.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    player.set_position(glm::vec3(50.0f, -3.0f, 0.0f));
+
+    std::vector<Entity> enemies(ENEMY_TOTAL);
+    unsigned int rng = 777u;
+    for (int i = 0; i < ENEMY_TOTAL; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        AIType type = (AIType) ((rng >> 16) % AI_TYPE_COUNT);
+
+        enemies[i] = Entity(0, 2.0f, glm::vec3(0.0f, -2.905f, 0.0f), 1.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+        enemies[i].set_position(glm::vec3((float) (i % 100), -(float) (i / 100) * 0.1f, 0.0f));
+        enemies[i].set_ai_type(type);
+        enemies[i].set_ai_state(STATES[type]);
+        enemies[i].set_movement(glm::vec3((i & 1) ? 1.0f : -1.0f, 0.0f, 0.0f));
+    }
+    std::vector<Entity> sorted = enemies;
+    AIGroups groups;
+    sort_by_ai_type(sorted.data(), ENEMY_TOTAL, &groups);
+
+    BenchClock::time_point start = BenchClock::now();
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        for (Entity &enemy : enemies) enemy.ai_activate(&player);
+    }
+    double switch_ns = seconds_since(start) * 1e9 / TICKS / ENEMY_TOTAL;
+
+    start = BenchClock::now();
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        for (Entity &enemy : enemies) enemy.ai_activate(&player);
+        for (Entity &enemy : enemies) enemy.ai_activate(&player);
+    }
+    double double_switch_ns = seconds_since(start) * 1e9 / TICKS / ENEMY_TOTAL;
+
+    AIContext context(player);
+    start = BenchClock::now();
+    for (int tick = 0; tick < TICKS; tick++) run_ai(sorted.data(), groups, context);
+    double grouped_ns = seconds_since(start) * 1e9 / TICKS / ENEMY_TOTAL;
+
+    LOG("ai_dispatch: " << ENEMY_TOTAL << " mixed enemies, ns per enemy per tick");
+    LOG("  switch, twice per tick (old): " << double_switch_ns);
+    LOG("  switch, once per tick:        " << switch_ns);
+    LOG("  grouped by type:              " << grouped_ns
+        << " (" << double_switch_ns / grouped_ns << "x faster than before)");
+}
+
+// ————— ENTITY POOL ————— //
+// 10k enemy slots, about half alive, with 5% of them despawned and respawned every tick:
+// a flat array skipping inactive entities (and searching it for a free one to spawn
+// into) against the pool's packed array and O(1) spawn and despawn
+static void bench_entity_pool()
+{
+    const int CAPACITY = 10000, TICKS = 600, CHURN = CAPACITY / 20, WIDTH = 512, HEIGHT = 48;
+
+    std::vector<unsigned int> tiles(WIDTH * HEIGHT, 0);
+    for (int x = 0; x < WIDTH; x++) tiles[(HEIGHT - 1) * WIDTH + x] = 1;
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    Entity player(0, 3.0f, glm::vec3(0.0f, -4.905f, 0.0f), 5.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    Entity prototype(0, 2.0f, glm::vec3(0.0f, -2.905f, 0.0f), 1.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+    prototype.set_ai_type(PATROL);
+    prototype.set_ai_state(PATROLLING);
+    prototype.set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
+
+    auto place = [](Entity *enemy, unsigned int seed) {
+        enemy->set_position(glm::vec3((float) (seed % (WIDTH - 2) + 1), -(float) (HEIGHT - 2), 0.0f));
+    };
+
+    // ————— FLAT ARRAY ————— //
+    std::vector<Entity> flat(CAPACITY, prototype);
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        place(&flat[i], i * 2654435761u);
+        if (i % 2) flat[i].deactivate();
+    }
+
+    unsigned int rng = 4242u;
+    double flat_update_s = 0.0, flat_churn_s = 0.0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (int n = 0; n < CHURN; n++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            int victim = rng % CAPACITY;
+            while (!flat[victim].is_active()) victim = (victim + 1) % CAPACITY;
+            flat[victim].deactivate();
+
+            // First inactive slot from a random start, as spawning into a fixed array must
+            int slot = (rng >> 8) % CAPACITY;
+            while (flat[slot].is_active()) slot = (slot + 1) % CAPACITY;
+            flat[slot] = prototype;
+            place(&flat[slot], rng);
+        }
+        flat_churn_s += seconds_since(start);
+
+        start = BenchClock::now();
+        for (Entity &enemy : flat)
+        {
+            if (!enemy.is_active()) continue;
+            enemy.update(FIXED_TIMESTEP, nullptr, 0, &map);
+        }
+        flat_update_s += seconds_since(start);
+    }
+    int flat_live = 0;
+    for (const Entity &enemy : flat) flat_live += enemy.is_active();
+
+    // ————— POOL ————— //
+    EntityPool pool(CAPACITY, AI_TYPE_COUNT);
+    std::vector<EntityHandle> handles;
+    handles.reserve(CAPACITY);
+    for (int i = 0; i < CAPACITY / 2; i++)
+    {
+        place(&prototype, i * 2654435761u);
+        handles.push_back(pool.spawn(prototype, PATROL));
+    }
+
+    rng = 4242u;
+    int stale_hits = 0;
+    double pool_update_s = 0.0, pool_churn_s = 0.0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (int n = 0; n < CHURN; n++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            int victim = rng % pool.get_count();
+            EntityHandle old = pool.get_handle(victim);
+            pool.despawn_at(victim);
+
+            place(&prototype, rng);
+            EntityHandle fresh = pool.spawn(prototype, PATROL);
+
+            // The slot is usually reused at once; the old handle must not reach the newcomer
+            stale_hits += pool.get(old) != nullptr;
+            stale_hits += pool.get(fresh) == nullptr;
+        }
+        pool_churn_s += seconds_since(start);
+
+        start = BenchClock::now();
+        for (Entity &enemy : pool) enemy.update(FIXED_TIMESTEP, nullptr, 0, &map);
+        pool_update_s += seconds_since(start);
+    }
+
+    LOG("entity_pool: " << CAPACITY << " slots, " << CHURN << " despawns and spawns per tick, ms per tick");
+    LOG("  flat array (" << flat_live << " live): churn " << flat_churn_s * 1e3 / TICKS << ", update "
+        << flat_update_s * 1e3 / TICKS);
+    LOG("  pool       (" << pool.get_count() << " live): churn " << pool_churn_s * 1e3 / TICKS << ", update "
+        << pool_update_s * 1e3 / TICKS << "; " << stale_hits << " stale handles resolved");
+    if (stale_hits != 0) g_failed = true;
+}
+
+// ————— NAVIGATION ————— //
+// A wide level of stacked platforms, generated so every run sees the same one
+static void make_platform_level(std::vector<unsigned int> *tiles, int width, int height, unsigned int seed)
+{
+    tiles->assign(width * height, 0);
+    for (int x = 0; x < width; x++) (*tiles)[(height - 1) * width + x] = 1;
+    for (int y = 0; y < height; y++) (*tiles)[y * width] = (*tiles)[y * width + width - 1] = 1;
+
+    for (int y = height - 3; y >= 2; y -= 2)
+    {
+        for (int x = 1; x < width - 1; )
+        {
+            seed = seed * 1664525u + 1013904223u;
+            int length = 3 + (int) ((seed >> 16) % 8);
+            bool solid = ((seed >> 8) & 3) != 0;
+            for (int i = x; i < x + length && i < width - 1; i++) (*tiles)[y * width + i] = solid ? 2 : 0;
+            x += length + 1 + (int) ((seed >> 4) % 3);
+        }
+    }
+}
+
+// Copies chasers[0] onto count random nodes of graph
+static void spawn_chasers(const NavGraph &graph, int count, unsigned int seed, std::vector<Entity> *chasers)
+{
+    Entity prototype = (*chasers)[0];
+    chasers->assign(count, prototype);
+
+    for (int i = 0; i < count; i++)
+    {
+        int node;
+        do {
+            seed = seed * 1664525u + 1013904223u;
+            node = (int) ((seed >> 8) % (unsigned int) graph.get_node_count());
+        } while (!graph.is_node(node));
+
+        (*chasers)[i].set_position(glm::vec3((float) graph.get_node_x(node), -(float) graph.get_node_y(node) - 0.1f, 0.0f));
+    }
+}
+
+// The player runs back and forth along the floor, hopping now and then
+static void move_chased_player(Entity &player, int tick, Map *map)
+{
+    if (tick % 300 == 0) player.set_movement(glm::vec3((tick / 300) % 2 ? -1.0f : 1.0f, 0.0f, 0.0f));
+    if (tick % 45 == 0 && player.get_collided_bottom()) player.jump();
+    player.update(FIXED_TIMESTEP, nullptr, 0, map);
+}
+
+// ————— PARTITIONED WORLD ————— //
+// 40k enemies of four kinds over one 4096-tile-wide level, stepped by strips on 1 to 16
+// threads, each run checked enemy by enemy (and contact by contact, every tick) against
+// the same ticks run serially in id order
+static unsigned int hash_enemies(const PartitionedWorld &world)
+{
+    unsigned int hash = 2166136261u;
+    for (int id = 0; id < world.get_enemy_count(); id++)
+    {
+        const EntityBody &body = world.get_enemy(id).get_body();
+        const float state[] = { body.position.x, body.position.y, body.velocity.x, body.velocity.y, body.movement.x };
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(state);
+        for (size_t i = 0; i < sizeof(state); i++) hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void bench_partition()
+{
+    const int WIDTH = 4096, HEIGHT = 48, ENEMIES = 40000, TICKS = 120;
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+    StaticColliders statics(map, nullptr, 0);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    glm::vec3 gravity(0.0f, -4.905f, 0.0f);
+
+    std::vector<Entity> enemies(1, Entity(0, 2.0f, gravity, 4.5f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY));
+    enemies[0].set_ai_type(GUARD);
+    enemies[0].set_ai_state(WALKING);
+
+    NavLevel nav;
+    nav.add_enemies(map, enemies.data(), 1);
+    spawn_chasers(nav.get_graph(0), ENEMIES, 77u, &enemies);
+
+    // A quarter each of guards, walkers, patrols and jumpers
+    for (int i = 0; i < ENEMIES; i++)
+    {
+        if (i % 4 == 1) { enemies[i].set_ai_type(WALKER); }
+        if (i % 4 == 2) { enemies[i].set_ai_type(PATROL); enemies[i].set_ai_state(PATROLLING);
+                          enemies[i].set_movement(glm::vec3(i & 8 ? 1.0f : -1.0f, 0.0f, 0.0f)); }
+        if (i % 4 == 3) { enemies[i].set_ai_type(JUMPER); enemies[i].set_ai_state(JUMPING); enemies[i].set_jumping_power(2.0f); }
+    }
+
+    Entity start_player(0, 3.0f, gravity, 5.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    start_player.set_position(glm::vec3(WIDTH / 2.0f, -(HEIGHT - 2.0f), 0.0f));
+
+    // Plays the ticks, hashing the contacts found each tick; returns ms per tick
+    auto play = [&](PartitionedWorld &world, JobSystem *jobs, bool serial, unsigned int *contact_hash) {
+        Entity player = start_player;
+        *contact_hash = 0;
+        double total = 0.0;
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            move_chased_player(player, tick, &map);
+
+            BenchClock::time_point start = BenchClock::now();
+            if (serial) world.tick_serial(FIXED_TIMESTEP, player);
+            else        world.tick(FIXED_TIMESTEP, player, jobs);
+            total += seconds_since(start);
+
+            const std::vector<int> &contacts = serial ? world.find_contacts_serial(player) : world.find_contacts(player);
+            for (int id : contacts) *contact_hash = *contact_hash * 31u + (unsigned int) id + 1u;
+        }
+        return total * 1e3 / TICKS;
+    };
+
+    PartitionedWorld reference(&map, &nav, &statics);
+    for (const Entity &enemy : enemies) reference.add_enemy(enemy);
+    unsigned int reference_contacts;
+    double serial_ms = play(reference, nullptr, true, &reference_contacts);
+    unsigned int reference_hash = hash_enemies(reference);
+
+    LOG("partition: " << ENEMIES << " enemies, " << WIDTH << " tiles wide in " << reference.get_strip_count()
+        << " strips, " << TICKS << " ticks, " << std::thread::hardware_concurrency() << " hardware threads");
+    LOG("  serial: " << serial_ms << " ms per tick");
+
+    const int THREADS[] = { 1, 2, 4, 8, 16 };
+    for (int threads : THREADS)
+    {
+        JobSystem jobs(threads);
+        PartitionedWorld world(&map, &nav, &statics);
+        for (const Entity &enemy : enemies) world.add_enemy(enemy);
+
+        unsigned int contacts;
+        double tick_ms = play(world, &jobs, false, &contacts);
+        bool same = hash_enemies(world) == reference_hash && contacts == reference_contacts;
+
+        LOG("  " << threads << " threads: " << tick_ms << " ms per tick (" << serial_ms / tick_ms << "x), "
+            << world.get_handoff_count() << " handoffs last tick, " << (same ? "identical" : "DIFFERENT"));
+        if (!same) g_failed = true;
+    }
+}
+
+// ————— HOT/COLD SPLIT ————— //
+// 10k to 100k walkers over a wide platform level: Entity::update over whole entities (the
+// body is the first cache line of each) against update_bodies() over the bodies alone,
+// packed one per cache line. Times per tick, and cache misses per entity per tick.
+static void bench_hot_cold()
+{
+    const int WIDTH = 2048, HEIGHT = 64, TICKS = 200;
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    Entity prototype(0, 2.0f, glm::vec3(0.0f, -2.905f, 0.0f), 1.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+
+    CacheMissCounter counter;
+    LOG("hot_cold: " << TICKS << " ticks; Entity is " << sizeof(Entity) << " bytes, EntityBody " << sizeof(EntityBody)
+        << (counter.is_available() ? "" : " (no cache counters here: times only)"));
+
+    const int COUNTS[] = { 10000, 30000, 100000 };
+    for (int count : COUNTS)
+    {
+        std::vector<Entity> entities(count, prototype);
+        unsigned int rng = 99u;
+        for (Entity &entity : entities)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            entity.set_position(glm::vec3((float) (rng % (WIDTH - 4) + 2), -(float) ((rng >> 12) % (HEIGHT - 4) + 1), 0.0f));
+            entity.set_movement(glm::vec3((rng >> 30) & 1 ? 1.0f : -1.0f, 0.0f, 0.0f));
+        }
+
+        // Bodies on their own, each starting a cache line
+        std::vector<EntityBody> body_storage(count);
+        EntityBody *bodies = body_storage.data();
+        for (int i = 0; i < count; i++) bodies[i] = entities[i].get_body();
+
+        // Settle both onto the floors first, so the timed ticks are the steady state
+        for (int tick = 0; tick < 60; tick++)
+        {
+            for (Entity &entity : entities) entity.update(FIXED_TIMESTEP, nullptr, 0, &map);
+            update_bodies(bodies, count, FIXED_TIMESTEP, &map);
+        }
+
+        counter.start();
+        BenchClock::time_point start = BenchClock::now();
+        for (int tick = 0; tick < TICKS; tick++)
+            for (Entity &entity : entities) entity.update(FIXED_TIMESTEP, nullptr, 0, &map);
+        double    entity_ms     = seconds_since(start) * 1e3 / TICKS;
+        long long entity_misses = counter.stop();
+
+        counter.start();
+        start = BenchClock::now();
+        for (int tick = 0; tick < TICKS; tick++) update_bodies(bodies, count, FIXED_TIMESTEP, &map);
+        double    body_ms     = seconds_since(start) * 1e3 / TICKS;
+        long long body_misses = counter.stop();
+
+        int mismatches = 0;
+        for (int i = 0; i < count; i++) mismatches += entities[i].get_position() != bodies[i].position;
+
+        // A counter that opens but never counts (as in some VMs) is as good as none
+        double per_tick = (double) TICKS * count;
+        bool   counted  = counter.is_available() && (entity_misses > 0 || body_misses > 0);
+        if (counted)
+            LOG("  " << count << " entities: Entity::update " << entity_ms << " ms, " << entity_misses / per_tick
+                << " misses each; update_bodies " << body_ms << " ms, " << body_misses / per_tick << " misses each ("
+                << entity_ms / body_ms << "x; " << mismatches << " positions differ)");
+        else
+            LOG("  " << count << " entities: Entity::update " << entity_ms << " ms; update_bodies " << body_ms
+                << " ms (" << entity_ms / body_ms << "x; " << mismatches << " positions differ"
+                << (counter.is_available() ? "; the cache counter read zero" : "") << ")");
+        if (mismatches != 0) g_failed = true;
+    }
+}
+
+// The integration step alone over packed arrays, lanes at a time against one at a time,
+// then update_bodies() with and without a batch integrated ahead of the collisions
+static void bench_kinematics()
+{
+    const int TICKS = 200;
+#if defined(__AVX__)
+    const char *lanes = "AVX, 8 lanes";
+#elif defined(FLOAT4_LANES)
+    const char *lanes = "4 lanes";
+#else
+    const char *lanes = "no SIMD here: scalar both ways";
+#endif
+    LOG("kinematics: " << TICKS << " ticks (" << lanes << ")");
+
+    const int COUNTS[] = { 10000, 100000, 1000000 };
+    for (int count : COUNTS)
+    {
+        std::vector<float> fields[2][8];
+        unsigned int rng = 31u;
+        for (int field = 0; field < 8; field++)
+        {
+            fields[0][field].resize(count);
+            for (float &value : fields[0][field])
+            {
+                rng = rng * 1664525u + 1013904223u;
+                value = (float) (rng >> 8) / (float) (1 << 24) * 8.0f - 4.0f;
+            }
+            fields[1][field] = fields[0][field];
+        }
+
+        double ms[2];
+        const KinematicsMode MODES[2] = { KINEMATICS_REFERENCE, KINEMATICS_SIMD };
+        for (int run = 0; run < 2; run++)
+        {
+            std::vector<float> *f = fields[run];
+            BenchClock::time_point start = BenchClock::now();
+            for (int tick = 0; tick < TICKS; tick++)
+                integrate_kinematics(f[0].data(), f[1].data(), f[2].data(), f[3].data(), f[4].data(), f[5].data(),
+                                     f[6].data(), f[7].data(), count, FIXED_TIMESTEP, MODES[run]);
+            ms[run] = seconds_since(start) * 1e3 / TICKS;
+        }
+
+        int differing = 0;
+        for (int field = 0; field < 4; field++)
+            differing += memcmp(fields[0][field].data(), fields[1][field].data(), count * sizeof(float)) != 0;
+
+        LOG("  " << count << " bodies: one at a time " << ms[0] << " ms, lanes " << ms[1] << " ms ("
+            << ms[0] / ms[1] << "x; " << differing << " of 4 arrays differ in any bit)");
+        if (differing != 0) g_failed = true;
+    }
+
+    const int WIDTH = 2048, HEIGHT = 64, BODIES = 100000;
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    std::vector<EntityBody> bodies[2];
+    unsigned int rng = 99u;
+    for (int i = 0; i < BODIES; i++)
+    {
+        EntityBody body;
+        rng = rng * 1664525u + 1013904223u;
+        body.position     = glm::vec3((float) (rng % (WIDTH - 4) + 2), -(float) ((rng >> 12) % (HEIGHT - 4) + 1), 0.0f);
+        body.movement     = glm::vec3((rng >> 30) & 1 ? 1.0f : -1.0f, 0.0f, 0.0f);
+        body.acceleration = glm::vec2(0.0f, -2.905f);
+        body.speed        = 2.0f;
+        body.width        = body.height = 0.65f;
+        bodies[0].push_back(body);
+    }
+    bodies[1] = bodies[0];
+
+    KinematicBatch batch;
+    double ms[2];
+    for (int run = 0; run < 2; run++)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (int tick = 0; tick < TICKS; tick++)
+            update_bodies(bodies[run].data(), BODIES, FIXED_TIMESTEP, &map, nullptr, run ? &batch : nullptr);
+        ms[run] = seconds_since(start) * 1e3 / TICKS;
+    }
+
+    int mismatches = 0;
+    for (int i = 0; i < BODIES; i++)
+        mismatches += memcmp(&bodies[0][i].position, &bodies[1][i].position, sizeof(glm::vec3)) != 0 ||
+                      memcmp(&bodies[0][i].velocity, &bodies[1][i].velocity, sizeof(glm::vec3)) != 0;
+    LOG("  update_bodies, " << BODIES << " bodies against the map: " << ms[0] << " ms one at a time, " << ms[1]
+        << " ms with a batch (" << ms[0] / ms[1] << "x; " << mismatches << " bodies differ)");
+    if (mismatches != 0) g_failed = true;
+}
+
+// A level's worth of objects, a quarter of them platforms and the rest walkers and patrols,
+// as Entities and in a ComponentStore: bytes per object, and AI plus movement per tick
+static void bench_archetypes()
+{
+    const int WIDTH = 2048, HEIGHT = 64, TICKS = 200;
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    Entity player(0, 2.0f, glm::vec3(0.0f, -2.905f, 0.0f), 1.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    AIContext context(player);
+
+    LOG("archetypes: " << TICKS << " ticks; Entity " << sizeof(Entity) << " bytes; body " << sizeof(EntityBody)
+        << ", box " << sizeof(BoxComponent) << ", sprite " << sizeof(SpriteComponent) << ", animation "
+        << sizeof(AnimationComponent) << ", AI " << sizeof(AIComponent));
+
+    const int COUNTS[] = { 10000, 100000 };
+    for (int count : COUNTS)
+    {
+        std::vector<Entity> platforms, movers;
+        ComponentStore store;
+        std::vector<int> mover_ids;
+
+        unsigned int rng = 7u;
+        for (int i = 0; i < count; i++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            glm::vec3 position((float) (rng % (WIDTH - 4) + 2), -(float) ((rng >> 12) % (HEIGHT - 4) + 1), 0.0f);
+
+            if (i % 4 == 0)
+            {
+                platforms.push_back(Entity(0, 0.0f, 0.4f, 1.0f, PLATFORM));
+                platforms.back().set_position(position);
+                store.spawn_from(platforms.back());
+                continue;
+            }
+
+            Entity enemy(0, 2.0f, glm::vec3(0.0f, -2.905f, 0.0f), 1.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+            enemy.set_ai_type((rng >> 30) & 1 ? PATROL : WALKER);
+            enemy.set_ai_state(PATROLLING);
+            enemy.set_position(position);
+            enemy.set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
+            movers.push_back(enemy);
+            mover_ids.push_back(store.spawn_from(enemy));
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            for (Entity &mover : movers)
+            {
+                AIAgent agent(mover);
+                run_ai_agent(agent, context);
+                mover.update(FIXED_TIMESTEP, nullptr, 0, &map);
+            }
+        }
+        double entity_ms = seconds_since(start) * 1e3 / TICKS;
+
+        start = BenchClock::now();
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            ai_system(store, context);
+            animation_system(store, FIXED_TIMESTEP);
+            physics_system(store, FIXED_TIMESTEP, &map);
+        }
+        double store_ms = seconds_since(start) * 1e3 / TICKS;
+
+        int mismatches = 0;
+        for (size_t i = 0; i < movers.size(); i++)
+        {
+            const EntityBody &body = *store.get<EntityBody>(mover_ids[i]);
+            mismatches += movers[i].get_position() != body.position ||
+                          movers[i].get_animation().index != store.get<AnimationComponent>(mover_ids[i])->index;
+        }
+
+        double entity_bytes = (double) sizeof(Entity),
+               store_bytes  = (double) store.get_memory_bytes() / count;
+        LOG("  " << count << " objects in " << store.get_archetype_count() << " archetypes: " << entity_bytes
+            << " bytes each as Entities, " << store_bytes << " in the store; tick " << entity_ms << " ms as Entities, "
+            << store_ms << " ms by systems (" << entity_ms / store_ms << "x; " << mismatches << " movers differ)");
+        if (mismatches != 0) g_failed = true;
+    }
+}
+
+// 1000 guards chasing a player around a 512x48 level: per-tick AI cost, cache hits, and
+// what a tile edit costs the graph
+static void bench_nav()
+{
+    const int WIDTH = 512, HEIGHT = 48, CHASERS = 1000, TICKS = 1200;
+
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    glm::vec3 gravity(0.0f, -4.905f, 0.0f);
+
+    Entity player(0, 3.0f, gravity, 5.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    player.set_position(glm::vec3(WIDTH / 2.0f, -(HEIGHT - 2.0f), 0.0f));
+
+    std::vector<Entity> chasers(CHASERS);
+    chasers[0] = Entity(0, 2.0f, gravity, 4.5f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+    chasers[0].set_ai_type(GUARD);
+    chasers[0].set_ai_state(WALKING);
+
+    BenchClock::time_point start = BenchClock::now();
+    NavLevel nav;
+    nav.add_enemies(map, chasers.data(), 1);
+    double build_ms = seconds_since(start) * 1e3;
+    const NavGraph &graph = nav.get_graph(0);
+
+    spawn_chasers(graph, CHASERS, 99u, &chasers);
+
+    AIGroups groups;
+    sort_by_ai_type(chasers.data(), CHASERS, &groups);
+    NavPlanner planner;
+
+    auto mean_distance = [&]() {
+        double total = 0.0;
+        for (const Entity &chaser : chasers) total += glm::distance(chaser.get_position(), player.get_position());
+        return total / CHASERS;
+    };
+    double distance_before = mean_distance();
+
+    std::vector<double> ai_times(TICKS);
+    double tick_total = 0.0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        BenchClock::time_point tick_start = BenchClock::now();
+
+        move_chased_player(player, tick, &map);
+
+        BenchClock::time_point ai_start = BenchClock::now();
+        planner.begin_tick();
+        AIContext context(player, &map, &nav, &planner);
+        run_ai(chasers.data(), groups, context);
+        double ai = seconds_since(ai_start);
+
+        for (Entity &chaser : chasers) chaser.update(FIXED_TIMESTEP, nullptr, 0, &map);
+
+        ai_times[tick] = ai;
+        tick_total    += seconds_since(tick_start);
+    }
+
+    // One search with nothing cached, for comparison with searching per chaser per tick
+    NavSearch search;
+    int start_node = graph.find_node(map, chasers[0].get_position()),
+        goal_node  = graph.find_node(map, player.get_position());
+    start = BenchClock::now();
+    const int SEARCHES = 200;
+    for (int i = 0; i < SEARCHES; i++) graph.search_to(start_node, goal_node, search, WIDTH * HEIGHT);
+    double search_us = seconds_since(start) * 1e6 / SEARCHES;
+
+    // A far goal one rationed search cannot reach: the first node, scanning in from the
+    // level's far top corner, whose full search settles more than MAX_EXPANSIONS nodes.
+    // Running out of expansions must not be remembered as "unreachable": the next tick
+    // searches again instead of hitting it.
+    int far_from = graph.find_node(map, glm::vec3(2.0f, -(HEIGHT - 2.0f), 0.0f)), far_goal = -1;
+    for (int node = 0; node < graph.get_node_count() && far_goal < 0; node++)
+    {
+        int goal = (graph.get_node_y(node) + 1) * WIDTH - 1 - graph.get_node_x(node);
+        if (graph.is_node(goal) && graph.search_to(far_from, goal, search, WIDTH * HEIGHT) &&
+            (int) search.settled.size() > NavPlanner::MAX_EXPANSIONS) far_goal = goal;
+    }
+    NavPlanner far_planner;
+    NavLink    far_link;
+    far_planner.begin_tick();
+    bool far_found = far_planner.next_link(graph, far_from, far_goal, &far_link);
+    far_planner.begin_tick();
+    far_planner.next_link(graph, far_from, far_goal, &far_link);
+    bool far_retried = far_planner.get_search_count() == 2;
+
+    // Knock a hole in a platform and put it back, through the map so that the tile storage
+    // the graph reads sees every edit
+    int edit_x = WIDTH / 3, edit_y = HEIGHT - 3, edits_made = 0;
+    start = BenchClock::now();
+    const int EDITS = 200;
+    for (int i = 0; i < EDITS; i++)
+    {
+        edits_made += map.set_tile(edit_x, edit_y, map.get_level_data()[edit_y * WIDTH + edit_x] ? 0 : 2);
+        nav.patch(map, edit_x, edit_y, edit_x, edit_y);
+    }
+    double patch_us = seconds_since(start) * 1e6 / EDITS;
+    if (edits_made != EDITS) g_failed = true;
+
+    double distance_after = mean_distance();
+    double ai_total = 0.0;
+    for (double ai : ai_times) ai_total += ai;
+    std::nth_element(ai_times.begin(), ai_times.begin() + TICKS * 99 / 100, ai_times.end());
+
+    int lookups = planner.get_hit_count() + planner.get_miss_count();
+    LOG("nav: " << CHASERS << " chasers on a " << WIDTH << "x" << HEIGHT << " level, " << TICKS << " ticks");
+    LOG("  graph build " << build_ms << " ms, tile edit patch " << patch_us << " us"
+        << (edits_made == EDITS ? "" : ", SOME EDITS NOT MADE"));
+    LOG("  AI per tick: mean " << ai_total * 1e6 / TICKS << " us, 99th percentile " << ai_times[TICKS * 99 / 100] * 1e6
+        << " us (whole tick mean " << tick_total * 1e3 / TICKS << " ms)");
+    LOG("  " << planner.get_search_count() << " searches, cache hit rate "
+        << 100.0 * planner.get_hit_count() / std::max(lookups, 1) << "%");
+    LOG("  mean distance to the player " << distance_before << " -> " << distance_after << " tiles");
+    LOG("  one uncached search " << search_us << " us; once per chaser would be "
+        << search_us * CHASERS / 1e3 << " ms per tick");
+    LOG("  a goal past the expansion cap: " << (far_goal >= 0 && !far_found ? "cut off" : "NOT CUT OFF")
+        << ", " << (far_retried ? "searched again" : "CACHED AS UNREACHABLE") << " the next tick");
+    if (far_goal < 0 || far_found || !far_retried) g_failed = true;
+}
+
+// Guards reading a shared flow field against guards searching with the path cache, as
+// their number grows: the field's cost per tick should barely move
+static void bench_flow()
+{
+    const int WIDTH = 512, HEIGHT = 48, TICKS = 600;
+    const int COUNTS[] = { 100, 1000, 10000 };
+
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    glm::vec3 gravity(0.0f, -4.905f, 0.0f);
+
+    Entity chaser(0, 2.0f, gravity, 4.5f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+    chaser.set_ai_type(GUARD);
+    chaser.set_ai_state(WALKING);
+
+    NavLevel nav;
+    nav.add_enemies(map, &chaser, 1);
+    std::vector<Entity> chasers;
+    const NavGraph &graph = nav.get_graph(0);
+
+    LOG("flow: guards chasing on a " << WIDTH << "x" << HEIGHT << " level, " << TICKS << " ticks, AI us per tick");
+    for (int count : COUNTS)
+    {
+        double ai_us[2];
+        int rebuilds = 0;
+
+        for (int use_flow = 0; use_flow < 2; use_flow++)
+        {
+            Entity player(0, 3.0f, gravity, 5.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+            player.set_position(glm::vec3(WIDTH / 2.0f, -(HEIGHT - 2.0f), 0.0f));
+
+            chasers.assign(1, chaser);
+            spawn_chasers(graph, count, 99u, &chasers);
+            AIGroups groups;
+            sort_by_ai_type(chasers.data(), count, &groups);
+
+            NavPlanner planner;
+            FlowField  flow;
+            double ai_total = 0.0;
+
+            for (int tick = 0; tick < TICKS; tick++)
+            {
+                move_chased_player(player, tick, &map);
+
+                BenchClock::time_point start = BenchClock::now();
+                planner.begin_tick();
+                AIContext context(player, &map, &nav, &planner);
+                if (use_flow) context.flow_fields = &flow;
+                run_ai(chasers.data(), groups, context);
+                ai_total += seconds_since(start);
+
+                for (Entity &enemy : chasers) enemy.update(FIXED_TIMESTEP, nullptr, 0, &map);
+            }
+            ai_us[use_flow] = ai_total * 1e6 / TICKS;
+            if (use_flow) rebuilds = flow.get_rebuild_count();
+        }
+
+        LOG("  " << count << " guards: path cache " << ai_us[0] << ", flow field " << ai_us[1]
+            << " (" << ai_us[1] * 1e3 / count << " ns per guard, " << rebuilds << " rebuilds)");
+    }
+
+    // What one rebuild costs, for a player that never stops changing tile
+    FlowField flow;
+    const int REBUILDS = 200;
+    BenchClock::time_point start = BenchClock::now();
+    for (int i = 0; i < REBUILDS; i++)
+    {
+        flow.update(graph, graph.find_node(map, glm::vec3((float) (i % (WIDTH - 2) + 1), -(HEIGHT - 2.0f), 0.0f)));
+    }
+    LOG("  one rebuild over " << graph.get_node_count() << " tiles: " << seconds_since(start) * 1e6 / REBUILDS << " us");
+}
+
+// ————— LINE OF SIGHT ————— //
+// Enemy-to-player sight lines of every length, one call per ray and batched
+// The tile-by-tile walk of Map::raycast in double precision, as a reference for long rays
+static bool raycast_in_double(const Map &map, glm::vec3 origin, glm::vec3 direction, double max_distance, RaycastHit *hit)
+{
+    *hit = RaycastHit();
+    double length = sqrt((double) direction.x * direction.x + (double) direction.y * direction.y);
+    double u  = origin.x / (double) map.get_tile_size() + 0.5,  v  = -origin.y / (double) map.get_tile_size() + 0.5;
+    double du = direction.x / length / map.get_tile_size(),   dv = -direction.y / length / map.get_tile_size();
+
+    double t = 0.0;
+    int tile_x = (int) floor(u), tile_y = (int) floor(v);
+    while (t <= max_distance && tile_x >= 0 && tile_x < map.get_width() && tile_y >= 0 && tile_y < map.get_height())
+    {
+        if (map.get_tiles().is_solid(tile_x, tile_y))
+        {
+            hit->tile_x   = tile_x;
+            hit->tile_y   = tile_y;
+            hit->distance = (float) t;
+            return true;
+        }
+        double next_x = du != 0.0 ? (tile_x + (du > 0.0) - u) / du : INFINITY,
+               next_y = dv != 0.0 ? (tile_y + (dv > 0.0) - v) / dv : INFINITY;
+        if (next_x < next_y) { t = next_x; tile_x += du > 0.0 ? 1 : -1; }
+        else                 { t = next_y; tile_y += dv > 0.0 ? 1 : -1; }
+    }
+    return false;
+}
+
+static void bench_los()
+{
+    const int WIDTH = 512, HEIGHT = 48, RAYS = 100000, ROUNDS = 20;
+
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 4242u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    std::vector<Ray>        rays(RAYS);
+    std::vector<RaycastHit> hits(RAYS);
+    unsigned int rng = 31u;
+    for (Ray &ray : rays)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        glm::vec3 from((float) ((rng >> 8) % WIDTH), -(float) ((rng >> 20) % HEIGHT), 0.0f);
+        rng = rng * 1664525u + 1013904223u;
+        glm::vec3 to(from.x + (float) ((int) ((rng >> 8) % 64) - 32), -(float) ((rng >> 20) % HEIGHT), 0.0f);
+
+        ray.origin       = from;
+        ray.direction    = to - from;
+        ray.max_distance = glm::length(to - from);
+    }
+
+    int visible = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (const Ray &ray : rays) visible += map.has_line_of_sight(ray.origin, ray.origin + ray.direction);
+    }
+    double single_ns = seconds_since(start) * 1e9 / (RAYS * ROUNDS);
+
+    start = BenchClock::now();
+    for (int round = 0; round < ROUNDS; round++) map.raycast(rays.data(), RAYS, hits.data());
+    double batch_ns = seconds_since(start) * 1e9 / (RAYS * ROUNDS);
+
+    int blocked = 0;
+    for (const RaycastHit &hit : hits) blocked += hit.tile_x >= 0;
+
+    LOG("los: " << RAYS << " sight lines up to 32 tiles across on a " << WIDTH << "x" << HEIGHT << " level");
+    LOG("  " << single_ns << " ns per has_line_of_sight, " << batch_ns << " ns per ray batched, "
+        << 100.0 * blocked / RAYS << "% blocked, " << 100.0 * visible / (RAYS * ROUNDS) << "% clear");
+
+    // Long diagonal rays across a sparse 2048x2048 level, each walk checked against the
+    // same walk in double precision: float error must not push either off its tiles
+    const int LONG_SIZE = 2048, LONG_RAYS = 5000;
+    std::vector<unsigned int> sparse(LONG_SIZE * LONG_SIZE, 0);
+    for (int i = 0; i < LONG_SIZE * LONG_SIZE / 8000; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        sparse[(rng >> 8) % (LONG_SIZE * LONG_SIZE)] = 1;
+    }
+    Map sparse_map(LONG_SIZE, LONG_SIZE, sparse.data(), 0, 1.0f, 3, 1);
+
+    int wrong[2] = { 0, 0 }, long_hits = 0;
+    for (int i = 0; i < LONG_RAYS; i++)
+    {
+        // From near one corner towards the opposite one, give or take 20 degrees
+        rng = rng * 1664525u + 1013904223u;
+        int corner = (rng >> 30) & 3;
+        glm::vec3 origin((float) ((rng >> 8) % 64), -(float) ((rng >> 16) % 64), 0.0f);
+        if (corner & 1) origin.x = LONG_SIZE - 1 - origin.x;
+        if (corner & 2) origin.y = -(LONG_SIZE - 1) - origin.y;
+        rng = rng * 1664525u + 1013904223u;
+        float angle = -0.785398f + ((rng >> 8) / 16777216.0f - 0.5f) * 0.7f;
+        glm::vec3 direction(cosf(angle) * ((corner & 1) ? -1.0f : 1.0f), sinf(angle) * ((corner & 2) ? -1.0f : 1.0f), 0.0f);
+
+        RaycastHit expected, got[2];
+        long_hits += raycast_in_double(sparse_map, origin, direction, 4096.0, &expected);
+        sparse_map.raycast_tile_by_tile(origin, direction, 4096.0f, &got[0]);
+        sparse_map.raycast(origin, direction, 4096.0f, &got[1]);
+        for (int path = 0; path < 2; path++)
+        {
+            if (got[path].tile_x != expected.tile_x || got[path].tile_y != expected.tile_y ||
+                fabsf(got[path].distance - expected.distance) > 1e-3f * fmaxf(expected.distance, 1.0f)) wrong[path]++;
+        }
+    }
+    LOG("  " << LONG_RAYS << " diagonal rays up to 2896 tiles (" << long_hits << " hit): " << wrong[0]
+        << " wrong tile by tile, " << wrong[1] << " wrong with the pyramid, against a double-precision walk");
+    if (wrong[0] != 0 || wrong[1] != 0) g_failed = true;
+}
+
+// ————— MAP BUILD ————— //
+// The mesh of 1M- and 10M-tile levels, about a third solid: built the way Map::build used
+// to (a vector insert per tile), in two passes on this thread, and in two passes as jobs
+static void build_by_insert(const Map &map, std::vector<float> *vertices, std::vector<float> *texture_coordinates)
+{
+    const unsigned int *level_data = map.get_level_data();
+    float tile_size   = map.get_tile_size(),
+          tile_width  = 1.0f / (float) map.get_tile_count_x(),
+          tile_height = 1.0f / (float) map.get_tile_count_y();
+    float x_offset = -(tile_size / 2), y_offset = (tile_size / 2);
+
+    for (int y = 0; y < map.get_height(); y++)
+        for (int x = 0; x < map.get_width(); x++)
+        {
+            int tile = level_data[(size_t) y * map.get_width() + x];
+            if (tile == 0) continue;
+
+            float u = (float) (tile % map.get_tile_count_x()) / (float) map.get_tile_count_x();
+            float v = (float) (tile / map.get_tile_count_x()) / (float) map.get_tile_count_y();
+            vertices->insert(vertices->end(), {
+                x_offset + (tile_size * x), y_offset + -tile_size * y,
+                x_offset + (tile_size * x), y_offset + (-tile_size * y) - tile_size,
+                x_offset + (tile_size * x) + tile_size, y_offset + (-tile_size * y) - tile_size,
+                x_offset + (tile_size * x), y_offset + -tile_size * y,
+                x_offset + (tile_size * x) + tile_size, y_offset + (-tile_size * y) - tile_size,
+                x_offset + (tile_size * x) + tile_size, y_offset + -tile_size * y
+            });
+            texture_coordinates->insert(texture_coordinates->end(), {
+                u, v, u, v + tile_height, u + tile_width, v + tile_height,
+                u, v, u + tile_width, v + tile_height, u + tile_width, v
+            });
+        }
+}
+
+static void bench_map_build()
+{
+    const int SIZES[][2] = { { 1000, 1000 }, { 4000, 2500 } };
+    const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+    for (const int *size : SIZES)
+    {
+        int width = size[0], height = size[1];
+        std::vector<unsigned int> level((size_t) width * height);
+        unsigned int rng = 99u;
+        for (unsigned int &tile : level)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            tile = (rng >> 16) % 3 == 0 ? 1 + (rng >> 8) % 2 : 0;
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        Map map(width, height, level.data(), 0, 1.0f, 3, 1);
+        double constructed_ms = seconds_since(start) * 1e3;
+
+        start = BenchClock::now();
+        map.build();
+        double serial_ms = seconds_since(start) * 1e3;
+        MeshBuffer serial_vertices = map.get_vertices();
+
+        double insert_ms;
+        bool   insert_identical;
+        {
+            std::vector<float> vertices, texture_coordinates;
+            start = BenchClock::now();
+            build_by_insert(map, &vertices, &texture_coordinates);
+            insert_ms = seconds_since(start) * 1e3;
+            insert_identical = vertices.size() == map.get_vertices().size() &&
+                               std::equal(vertices.begin(), vertices.end(), map.get_vertices().begin()) &&
+                               std::equal(texture_coordinates.begin(), texture_coordinates.end(),
+                                          map.get_texture_coordinates().begin());
+        }
+
+        LOG("map_build: " << width << "x" << height << " tiles, " << map.get_vertices().size() / 12 << " solid ("
+            << constructed_ms << " ms to construct, with the pyramid)");
+        LOG("  insert per tile: " << insert_ms << " ms" << (insert_identical ? "" : ", DIFFERENT"));
+        LOG("  two passes: " << serial_ms << " ms (" << insert_ms / serial_ms << "x)");
+
+        for (int thread_count : THREAD_COUNTS)
+        {
+            JobSystem jobs(thread_count);
+            start = BenchClock::now();
+            map.build(&jobs);
+            double parallel_ms = seconds_since(start) * 1e3;
+            bool identical = map.get_vertices() == serial_vertices;
+            LOG("  " << thread_count << " threads: " << parallel_ms << " ms (" << serial_ms / parallel_ms << "x), "
+                << (identical ? "identical" : "DIFFERENT"));
+            if (!identical) g_failed = true;
+        }
+        if (!insert_identical) g_failed = true;
+    }
+    LOG("  (" << std::thread::hardware_concurrency() << " hardware threads)");
+}
+
+// ————— TILE STORAGE ————— //
+// Column walks and 3x3 neighbourhood probes over a 4096x4096 level (too big for the
+// caches either way), reading unsigned ints in rows and reading TileStorage's 8x8 blocks
+static void bench_tiles()
+{
+    const int SIZE = 4096, WALKS = 4096, PROBES = 2000000;
+
+    std::vector<unsigned int> level((size_t) SIZE * SIZE);
+    unsigned int rng = 5u;
+    for (unsigned int &tile : level)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        tile = (rng >> 16) % 4 == 0 ? 1 + (rng >> 8) % 2 : 0;
+    }
+    TileStorage tiles;
+    tiles.assign(SIZE, SIZE, level.data());
+
+    // Down whole columns, as a body falling or a sight line straight down would
+    std::vector<int> columns(WALKS);
+    for (int &column : columns)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        column = (rng >> 8) % SIZE;
+    }
+    long long rows_solid = 0, blocks_solid = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int column : columns)
+        for (int y = 0; y < SIZE; y++) rows_solid += level[(size_t) y * SIZE + column] != 0;
+    double rows_walk_ns = seconds_since(start) * 1e9 / ((double) WALKS * SIZE);
+
+    start = BenchClock::now();
+    for (int column : columns)
+        for (int y = 0; y < SIZE; y++) blocks_solid += tiles.is_solid(column, y);
+    double blocks_walk_ns = seconds_since(start) * 1e9 / ((double) WALKS * SIZE);
+
+    // The tiles around a point, as a body's collision probes would
+    std::vector<int> points(PROBES * 2);
+    for (int &coordinate : points)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        coordinate = 1 + (rng >> 8) % (SIZE - 2);
+    }
+    long long rows_around = 0, blocks_around = 0;
+    start = BenchClock::now();
+    for (int i = 0; i < PROBES; i++)
+        for (int y = points[2 * i + 1] - 1; y <= points[2 * i + 1] + 1; y++)
+            for (int x = points[2 * i] - 1; x <= points[2 * i] + 1; x++) rows_around += level[(size_t) y * SIZE + x] != 0;
+    double rows_probe_ns = seconds_since(start) * 1e9 / PROBES;
+
+    start = BenchClock::now();
+    for (int i = 0; i < PROBES; i++)
+        for (int y = points[2 * i + 1] - 1; y <= points[2 * i + 1] + 1; y++)
+            for (int x = points[2 * i] - 1; x <= points[2 * i] + 1; x++) blocks_around += tiles.is_solid(x, y);
+    double blocks_probe_ns = seconds_since(start) * 1e9 / PROBES;
+
+    LOG("tiles: " << SIZE << "x" << SIZE << " level, " << level.size() * sizeof(unsigned int) / (1 << 20)
+        << " MB in rows of unsigned ints, " << tiles.get_bytes() / (1 << 20) << " MB in blocks ("
+        << (tiles.is_wide() ? 2 : 1) << " byte a tile)");
+    LOG("  column walks: " << rows_walk_ns << " ns a tile in rows, " << blocks_walk_ns << " ns in blocks ("
+        << rows_walk_ns / blocks_walk_ns << "x)" << (rows_solid == blocks_solid ? "" : ", DIFFERENT"));
+    LOG("  3x3 probes: " << rows_probe_ns << " ns each in rows, " << blocks_probe_ns << " ns in blocks ("
+        << rows_probe_ns / blocks_probe_ns << "x)" << (rows_around == blocks_around ? "" : ", DIFFERENT"));
+    if (rows_solid != blocks_solid || rows_around != blocks_around) g_failed = true;
+}
+
+// ————— TILE EDITS ————— //
+// Random single-tile edits on a 4096x256 level (a million tiles), each patched into the
+// mesh, the solidity pyramid, the static colliders and a nav graph, against what
+// building all of them again costs; then the patched results against fresh ones
+static void bench_tile_edit()
+{
+    const int WIDTH = 4096, HEIGHT = 256, EDITS = 5000;
+
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 77u);
+
+    BenchClock::time_point start = BenchClock::now();
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+    double build_ms = seconds_since(start) * 1e3;
+
+    start = BenchClock::now();
+    StaticColliders statics(map, nullptr, 0);
+    double bake_ms = seconds_since(start) * 1e3;
+
+    NavProfile profile;
+    profile.jump_up     = 3;
+    profile.jump_across = 4;
+    start = BenchClock::now();
+    NavLevel nav;
+    nav.add_profile(map, profile);
+    double nav_ms = seconds_since(start) * 1e3;
+
+#ifdef RISE_EGL_HEADLESS
+    // With a context, the edits also go through the vertex buffers
+    const int EDITS_PER_FRAME = 8;
+    bool gpu = create_headless_gl_context();
+    ShaderProgram program;
+    if (gpu)
+    {
+        program.load("shaders/vertex_textured.glsl", "shaders/fragment_textured.glsl");
+        map.upload();
+    }
+    double submit_seconds = 0.0, apply_seconds = 0.0;
+#endif
+
+    std::vector<double> set_us, statics_us, nav_us;
+    unsigned int rng = 31u;
+    int changed = 0;
+    for (int edit = 0; edit < EDITS; edit++)
+    {
+        // Inside the border walls: clear a solid tile, change its kind, or fill an open one
+        rng = rng * 1664525u + 1013904223u;
+        int x = 1 + (int) ((rng >> 8) % (WIDTH - 2)), y = 1 + (int) ((rng >> 4) % (HEIGHT - 2));
+        rng = rng * 1664525u + 1013904223u;
+        unsigned int current = map.get_level_data()[y * WIDTH + x],
+                     tile    = current == 0 ? 1 + (rng >> 8) % 2 : ((rng >> 8) % 3 == 0 ? 3 - current : 0);
+
+        BenchClock::time_point edit_start = BenchClock::now();
+        changed += map.set_tile(x, y, tile);
+        BenchClock::time_point statics_start = BenchClock::now();
+        statics.patch_tiles(map, x, y, x, y);
+        BenchClock::time_point nav_start = BenchClock::now();
+        nav.patch(map, x, y, x, y);
+        BenchClock::time_point nav_end = BenchClock::now();
+
+        set_us.push_back(std::chrono::duration<double, std::micro>(statics_start - edit_start).count());
+        statics_us.push_back(std::chrono::duration<double, std::micro>(nav_start - statics_start).count());
+        nav_us.push_back(std::chrono::duration<double, std::micro>(nav_end - nav_start).count());
+
+#ifdef RISE_EGL_HEADLESS
+        if (gpu && edit % EDITS_PER_FRAME == EDITS_PER_FRAME - 1)
+        {
+            BenchClock::time_point submit_start = BenchClock::now();
+            map.submit_edits();
+            BenchClock::time_point apply_start = BenchClock::now();
+            map.render(&program);
+            glFinish();
+            submit_seconds += std::chrono::duration<double>(apply_start - submit_start).count();
+            apply_seconds  += seconds_since(apply_start);
+        }
+#endif
+    }
+
+    // The mesh: the same quads as a fresh build, in whatever slots, plus collapsed ones
+    Map fresh(WIDTH, HEIGHT, map.get_level_data(), 0, 1.0f, 3, 1);
+    auto get_quads = [](const Map &source) {
+        std::vector<std::vector<float>> quads;
+        for (size_t q = 0; q < source.get_vertices().size() / 12; q++)
+        {
+            std::vector<float> quad(source.get_vertices().begin() + q * 12, source.get_vertices().begin() + q * 12 + 12);
+            if (std::all_of(quad.begin(), quad.end(), [](float value) { return value == 0.0f; })) continue;
+            quad.insert(quad.end(), source.get_texture_coordinates().begin() + q * 12,
+                        source.get_texture_coordinates().begin() + q * 12 + 12);
+            quads.push_back(quad);
+        }
+        std::sort(quads.begin(), quads.end());
+        return quads;
+    };
+    bool mesh_same = get_quads(map) == get_quads(fresh);
+
+#ifdef RISE_EGL_HEADLESS
+    // What the GPU holds against the mesh, once the last edits are in
+    if (gpu)
+    {
+        map.submit_edits();
+        map.render(&program);
+        std::vector<float> held(map.get_vertices().size());
+        glBindBuffer(GL_ARRAY_BUFFER, map.get_vertex_buffer());
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, held.size() * sizeof(float), held.data());
+        mesh_same = mesh_same && std::equal(held.begin(), held.end(), map.get_vertices().begin());
+        glBindBuffer(GL_ARRAY_BUFFER, map.get_texture_coordinate_buffer());
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, held.size() * sizeof(float), held.data());
+        mesh_same = mesh_same && std::equal(held.begin(), held.end(), map.get_texture_coordinates().begin());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+#endif
+
+    // The pyramid and the colliders, tile by tile and over random boxes
+    StaticColliders fresh_statics(fresh, nullptr, 0);
+    bool solids_same = statics.get_source_count() == fresh_statics.get_source_count();
+    int found[16];
+    for (int y = 0; y < HEIGHT && solids_same; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            bool covered = statics.query(x - 0.25f, -y - 0.25f, x + 0.25f, -y + 0.25f, found, 16) > 0;
+            if (covered != fresh.get_tiles().is_solid(x, y)) solids_same = false;
+        }
+    }
+    for (int i = 0; i < 20000 && solids_same; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        int x0 = (int) ((rng >> 8) % WIDTH), y0 = (int) ((rng >> 4) % HEIGHT);
+        int x1 = std::min(WIDTH - 1, x0 + (int) (rng % 24)), y1 = std::min(HEIGHT - 1, y0 + (int) ((rng >> 20) % 24));
+        solids_same = map.any_solid(x0, y0, x1, y1) == fresh.any_solid(x0, y0, x1, y1);
+    }
+
+    // The graph: the same nodes, with the same links out of each
+    NavLevel fresh_nav;
+    fresh_nav.add_profile(fresh, profile);
+    const NavGraph &graph = nav.get_graph(0), &fresh_graph = fresh_nav.get_graph(0);
+    auto key = [](const NavLink &link) { return std::make_tuple(link.node, (int) link.type, link.cost); };
+    bool graph_same = true;
+    for (int node = 0; node < graph.get_node_count() && graph_same; node++)
+    {
+        std::vector<NavLink> links = graph.get_out_links(node), fresh_links = fresh_graph.get_out_links(node);
+        auto order = [&](const NavLink &a, const NavLink &b) { return key(a) < key(b); };
+        std::sort(links.begin(), links.end(), order);
+        std::sort(fresh_links.begin(), fresh_links.end(), order);
+        graph_same = graph.is_node(node) == fresh_graph.is_node(node) && links.size() == fresh_links.size() &&
+                     std::equal(links.begin(), links.end(), fresh_links.begin(),
+                                [&](const NavLink &a, const NavLink &b) { return key(a) == key(b); });
+    }
+
+    // A world on its own copy of level 1: a tile edited next to the player shows up in the
+    // very next observation, though the player has not moved, and so does undoing it
+    std::vector<unsigned int> level(LEVEL_1_DATA, LEVEL_1_DATA + LEVEL1_WIDTH * LEVEL1_HEIGHT);
+    Map level_map(LEVEL1_WIDTH, LEVEL1_HEIGHT, level.data(), 0, 1.0f, 3, 1);
+    StaticColliders level_statics(level_map, nullptr, 0);
+    NavLevel level_nav;
+    level_nav.add_profile(level_map, profile);
+    World world;
+    world.initialise(WorldTextures(), &level_map);
+
+    std::vector<float> observation_storage;
+    float *observation = align_floats(observation_storage, ObservationBuilder::FLOATS_PER_ENV,
+                                      ObservationBuilder::OBSERVATION_ALIGNMENT);
+    ObservationBuilder builder(1);
+    builder.build(0, world, &level_map, observation);
+
+    const int GRID_X = ObservationBuilder::VIEW_WIDTH / 2 + 2, GRID_Y = ObservationBuilder::VIEW_HEIGHT / 2 + 2;
+    int tile_x = level_map.get_tile_x(world.player.get_position().x) - ObservationBuilder::VIEW_WIDTH / 2 + GRID_X,
+        tile_y = level_map.get_tile_y(world.player.get_position().y) - ObservationBuilder::VIEW_HEIGHT / 2 + GRID_Y;
+    float &cell = observation[OBS_SOLID * ObservationBuilder::PLANE_SIZE + GRID_Y * ObservationBuilder::VIEW_WIDTH + GRID_X];
+
+    unsigned int original = level[tile_y * LEVEL1_WIDTH + tile_x];
+    bool observed = cell == (original != 0 ? 1.0f : 0.0f);
+    for (unsigned int tile : { original != 0 ? 0u : 1u, original })
+    {
+        observed = observed && edit_level_tile(&level_map, &level_nav, &level_statics, tile_x, tile_y, tile);
+        builder.build(0, world, &level_map, observation);
+        observed = observed && cell == (tile != 0 ? 1.0f : 0.0f) &&
+                   (level_statics.query(tile_x - 0.25f, -tile_y - 0.25f, tile_x + 0.25f, -tile_y + 0.25f, found, 16) > 0)
+                   == (tile != 0);
+    }
+
+    LOG("tile_edit: " << WIDTH << "x" << HEIGHT << " level, " << changed << " tiles changed");
+    LOG("  built from scratch: mesh " << build_ms << " ms, colliders " << bake_ms << " ms, nav graph "
+        << nav_ms << " ms");
+    // Mean and median: now and then an edit also grows the mesh or re-grids the colliders
+    auto describe = [](std::vector<double> &times) {
+        double total = 0.0;
+        for (double time : times) total += time;
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        std::ostringstream text;
+        text << total / times.size() << " us (median " << times[times.size() / 2] << ")";
+        return text.str();
+    };
+    LOG("  per edit: map " << describe(set_us) << ", colliders " << describe(statics_us) << ", nav graph "
+        << describe(nav_us));
+#ifdef RISE_EGL_HEADLESS
+    if (gpu)
+        LOG("  per frame of " << EDITS_PER_FRAME << " edits: submit " << submit_seconds * 1e6 * EDITS_PER_FRAME / EDITS
+            << " us, buffer patches and draw " << apply_seconds * 1e6 * EDITS_PER_FRAME / EDITS << " us ("
+            << (const char *) glGetString(GL_RENDERER) << ")");
+#endif
+    LOG("  " << statics.get_box_count() << " collider boxes patched, " << fresh_statics.get_box_count()
+        << " baked fresh; mesh " << (mesh_same ? "identical" : "DIFFERENT") << ", solidity "
+        << (solids_same ? "identical" : "DIFFERENT") << ", nav graph " << (graph_same ? "identical" : "DIFFERENT"));
+    LOG("  edit_level_tile() next to a standing player: " << (observed ? "seen" : "NOT SEEN")
+        << " in the next observation and by the colliders");
+    if (!mesh_same || !solids_same || !graph_same || !observed) g_failed = true;
+}
+
+// ————— SOLIDITY PYRAMID ————— //
+// Long rays and large box queries on a 4096x1024 level that is mostly open sky, with
+// and without skipping empty blocks
+static void bench_pyramid()
+{
+    const int WIDTH = 4096, HEIGHT = 1024, RAYS = 20000, BOXES = 20000;
+
+    // A floor, and a sprinkling of short platforms in the bottom few rows
+    std::vector<unsigned int> tiles(WIDTH * HEIGHT, 0);
+    unsigned int rng = 2024u;
+    for (int x = 0; x < WIDTH; x++) tiles[(HEIGHT - 1) * WIDTH + x] = 1;
+    for (int i = 0; i < 2000; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        int x = (int) ((rng >> 8) % (WIDTH - 8)), y = HEIGHT - 2 - (int) ((rng >> 4) % 64);
+        for (int j = 0; j < 6; j++) tiles[y * WIDTH + x + j] = 2;
+    }
+
+    BenchClock::time_point start = BenchClock::now();
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+    double build_ms = seconds_since(start) * 1e3;
+
+    std::vector<Ray> rays(RAYS);
+    for (Ray &ray : rays)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        ray.origin = glm::vec3((float) ((rng >> 8) % WIDTH), -(float) ((rng >> 4) % HEIGHT), 0.0f);
+        rng = rng * 1664525u + 1013904223u;
+        float angle = (rng >> 8) / 16777216.0f * 6.2831853f;
+        ray.direction    = glm::vec3(cosf(angle), sinf(angle), 0.0f);
+        ray.max_distance = 2048.0f;
+    }
+
+    std::vector<RaycastHit> ray_hits[2] = { std::vector<RaycastHit>(RAYS), std::vector<RaycastHit>(RAYS) };
+    int hits[2] = { 0, 0 };
+    start = BenchClock::now();
+    for (int i = 0; i < RAYS; i++)
+        hits[0] += map.raycast_tile_by_tile(rays[i].origin, rays[i].direction, rays[i].max_distance, &ray_hits[0][i]);
+    double flat_ray_us = seconds_since(start) * 1e6 / RAYS;
+
+    start = BenchClock::now();
+    for (int i = 0; i < RAYS; i++)
+        hits[1] += map.raycast(rays[i].origin, rays[i].direction, rays[i].max_distance, &ray_hits[1][i]);
+    double pyramid_ray_us = seconds_since(start) * 1e6 / RAYS;
+
+    // Both walks must stop in the same tile, at the same distance
+    int ray_mismatches = 0;
+    for (int i = 0; i < RAYS; i++)
+    {
+        const RaycastHit &flat = ray_hits[0][i], &pyramid = ray_hits[1][i];
+        if (flat.tile_x != pyramid.tile_x || flat.tile_y != pyramid.tile_y ||
+            fabsf(flat.distance - pyramid.distance) > 1e-3f * fmaxf(flat.distance, 1.0f)) ray_mismatches++;
+    }
+
+    // Boxes from 1x1 to 256x256 tiles anywhere on the level
+    std::vector<int> boxes(BOXES * 4);
+    for (int i = 0; i < BOXES; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        int size = 1 << ((rng >> 28) % 9);
+        boxes[i * 4 + 0] = (int) ((rng >> 8) % WIDTH);
+        boxes[i * 4 + 1] = (int) ((rng >> 2) % HEIGHT);
+        boxes[i * 4 + 2] = boxes[i * 4 + 0] + size - 1;
+        boxes[i * 4 + 3] = boxes[i * 4 + 1] + size - 1;
+    }
+
+    std::vector<char> box_overlaps[2] = { std::vector<char>(BOXES), std::vector<char>(BOXES) };
+    int overlaps[2] = { 0, 0 };
+    start = BenchClock::now();
+    for (int i = 0; i < BOXES; i++)
+    {
+        box_overlaps[0][i] = map.any_solid_tile_by_tile(boxes[i * 4], boxes[i * 4 + 1], boxes[i * 4 + 2], boxes[i * 4 + 3]);
+        overlaps[0] += box_overlaps[0][i];
+    }
+    double flat_box_us = seconds_since(start) * 1e6 / BOXES;
+
+    start = BenchClock::now();
+    for (int i = 0; i < BOXES; i++)
+    {
+        box_overlaps[1][i] = map.any_solid(boxes[i * 4], boxes[i * 4 + 1], boxes[i * 4 + 2], boxes[i * 4 + 3]);
+        overlaps[1] += box_overlaps[1][i];
+    }
+    double pyramid_box_us = seconds_since(start) * 1e6 / BOXES;
+
+    int box_mismatches = 0;
+    for (int i = 0; i < BOXES; i++) box_mismatches += box_overlaps[0][i] != box_overlaps[1][i];
+
+    // Toggle tiles and keep the pyramid in step
+    const int EDITS = 100000;
+    start = BenchClock::now();
+    for (int i = 0; i < EDITS; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        int x = (int) ((rng >> 8) % WIDTH), y = (int) ((rng >> 2) % HEIGHT);
+        tiles[y * WIDTH + x] = tiles[y * WIDTH + x] ? 0 : 1;
+        map.update_solidity(x, y);
+    }
+    double edit_ns = seconds_since(start) * 1e9 / EDITS;
+
+    LOG("pyramid: " << WIDTH << "x" << HEIGHT << " level, built in " << build_ms << " ms");
+    LOG("  raycasts up to 2048 tiles: " << flat_ray_us << " us tile by tile, " << pyramid_ray_us
+        << " us with the pyramid (" << flat_ray_us / pyramid_ray_us << "x), hits " << hits[0] << "/" << hits[1]
+        << ", " << ray_mismatches << " rays differ");
+    LOG("  box queries up to 256x256: " << flat_box_us << " us tile by tile, " << pyramid_box_us
+        << " us with the pyramid (" << flat_box_us / pyramid_box_us << "x), overlaps " << overlaps[0] << "/" << overlaps[1]
+        << ", " << box_mismatches << " boxes differ");
+    LOG("  " << edit_ns << " ns per tile edit to keep the pyramid current");
+    if (ray_mismatches != 0 || box_mismatches != 0) g_failed = true;
+}
+
+// ————— STATIC COLLIDERS ————— //
+// 2000 enemies running and hopping around a 512x48 level with 400 ledge platforms:
+// collision through map probes plus a scan of every platform, against the baked boxes
+static void bench_colliders()
+{
+    const int WIDTH = 512, HEIGHT = 48, PLATFORMS = 400, MOVERS = 2000, TICKS = 600;
+
+    std::vector<unsigned int> tiles;
+    make_platform_level(&tiles, WIDTH, HEIGHT, 777u);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    // Ledges in runs of four, end to end, in the open rows between the tile platforms
+    unsigned int rng = 31337u;
+    std::vector<Entity> platforms(PLATFORMS);
+    for (int i = 0; i < PLATFORMS; i += 4)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        float x = 2.0f + (float) ((rng >> 8) % (WIDTH - 8)), y = -(float) (2 * ((rng >> 4) % (HEIGHT / 2 - 1)) + 1);
+        for (int j = 0; j < 4 && i + j < PLATFORMS; j++)
+        {
+            platforms[i + j] = Entity(0, 0.0f, 1.0f, 0.4f, PLATFORM);
+            platforms[i + j].set_position(glm::vec3(x + j, y, 0.0f));
+        }
+    }
+
+    BenchClock::time_point start = BenchClock::now();
+    StaticColliders statics(map, platforms.data(), PLATFORMS);
+    double bake_ms = seconds_since(start) * 1e3;
+
+    int walking[4][4] = { {8, 9, 10, 11}, {4, 5, 6, 7}, {0, 1, 2, 3}, {12, 13, 14, 15} };
+    glm::vec3 gravity(0.0f, -4.905f, 0.0f);
+
+    // Each in an open tile clear of the ledges: a body that starts inside something is
+    // pushed out by a tile's centre on one path and by the box's edge on the other
+    std::vector<Entity> movers(MOVERS);
+    for (int i = 0; i < MOVERS; i++)
+    {
+        int  x, y;
+        bool clear;
+        do {
+            rng = rng * 1664525u + 1013904223u;
+            x = 1 + (int) ((rng >> 8) % (WIDTH - 2));
+            y = (int) ((rng >> 4) % (HEIGHT - 2));
+            clear = tiles[y * WIDTH + x] == 0;
+            for (const Entity &platform : platforms)
+                if (fabs(platform.get_position().x - x) < 0.9f && fabs(platform.get_position().y + y) < 0.6f) clear = false;
+        } while (!clear);
+
+        movers[i] = Entity(0, 2.0f, gravity, 4.0f, walking, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, ENEMY);
+        movers[i].set_position(glm::vec3((float) x, -(float) y, 0.0f));
+    }
+
+    // Feeds every mover the same moves and jumps on both paths
+    auto steer = [](std::vector<Entity> &run, int tick, unsigned int *input) {
+        if (tick % 30 != 0) return;
+        for (Entity &mover : run)
+        {
+            *input = *input * 1664525u + 1013904223u;
+            mover.set_movement(glm::vec3((float) ((int) ((*input >> 8) % 3) - 1), 0.0f, 0.0f));
+            if ((*input >> 20) % 4 == 0 && mover.get_collided_bottom()) mover.jump();
+        }
+    };
+
+    // The same run twice from the same start, once per way of colliding
+    double seconds[2] = { 0.0, 0.0 };
+    int    grounded[2] = { 0, 0 };
+    for (int baked = 0; baked < 2; baked++)
+    {
+        std::vector<Entity> run = movers;
+        unsigned int input = 5u;
+
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            steer(run, tick, &input);
+
+            start = BenchClock::now();
+            for (Entity &mover : run)
+            {
+                if (baked) mover.update(FIXED_TIMESTEP, nullptr, 0, &map, &statics);
+                else       mover.update(FIXED_TIMESTEP, platforms.data(), PLATFORMS, &map);
+            }
+            seconds[baked] += seconds_since(start);
+        }
+
+        for (const Entity &mover : run) grounded[baked] += mover.get_collided_bottom();
+    }
+
+    // Both paths again in step, to catch each mover the moment they part. The boxes are
+    // meant to differ in one case only: a body lying exactly along the edge of a tile or
+    // ledge, before or after the step. There a corner probe lands on the neighbouring tile
+    // and takes a wall for a floor (or keeps standing on a ledge it has walked off), and a
+    // body resting on a ledge entity, or bumping its head on one, reads as hitting its
+    // side and is pushed off sideways; the baked boxes ignore anything grazed by less than
+    // the collision skin. Anything else parting them is a bug.
+    const float EDGE_TOLERANCE = 2e-3f;
+    auto touches_edge = [&](glm::vec3 centre) {
+        float half_width = movers[0].get_width() / 2.0f, half_height = movers[0].get_height() / 2.0f;
+        float left   = centre.x - half_width,  right = centre.x + half_width,
+              bottom = centre.y - half_height, top   = centre.y + half_height;
+
+        int found[16];
+        int count = statics.query(left - EDGE_TOLERANCE, bottom - EDGE_TOLERANCE, right + EDGE_TOLERANCE,
+                                  top + EDGE_TOLERANCE, found, 16);
+        for (int k = 0; k < count; k++)
+        {
+            // Side by side with a tile or ledge, or on top of or under a ledge (against
+            // tiles, that is the same on both paths)
+            const StaticBox &box = statics.get_box(found[k]);
+            bool ledge = found[k] >= statics.get_tile_box_count();
+            if (fabs(box.left - right) < EDGE_TOLERANCE || fabs(left - box.right) < EDGE_TOLERANCE) return true;
+            if (ledge && (fabs(bottom - box.top) < EDGE_TOLERANCE || fabs(box.bottom - top) < EDGE_TOLERANCE)) return true;
+        }
+        return false;
+    };
+
+    std::vector<Entity> probed = movers, baked = movers;
+    std::vector<unsigned char> parted(MOVERS, 0);
+    int flush_partings = 0, other_partings = 0;
+    unsigned int probed_input = 5u, baked_input = 5u;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        steer(probed, tick, &probed_input);
+        steer(baked, tick, &baked_input);
+        for (int i = 0; i < MOVERS; i++)
+        {
+            glm::vec3 before = probed[i].get_position();
+            probed[i].update(FIXED_TIMESTEP, platforms.data(), PLATFORMS, &map);
+            baked[i].update(FIXED_TIMESTEP, nullptr, 0, &map, &statics);
+            if (parted[i] || (glm::distance(probed[i].get_position(), baked[i].get_position()) < 1e-3f &&
+                              probed[i].get_collided_bottom() == baked[i].get_collided_bottom())) continue;
+
+            parted[i] = 1;
+            bool flush = touches_edge(before) || touches_edge(probed[i].get_position()) ||
+                         touches_edge(baked[i].get_position());
+            if (flush) flush_partings++;
+            else       other_partings++;
+        }
+    }
+
+    double probe_ns = seconds[0] * 1e9 / ((double) TICKS * MOVERS),
+           baked_ns = seconds[1] * 1e9 / ((double) TICKS * MOVERS);
+
+    LOG("colliders: " << WIDTH << "x" << HEIGHT << " level with " << PLATFORMS << " platforms, "
+        << MOVERS << " movers for " << TICKS << " ticks");
+    LOG("  " << statics.get_source_count() << " solid tiles and platforms baked into " << statics.get_box_count()
+        << " boxes (" << statics.get_tile_box_count() << " from tiles) in " << bake_ms << " ms");
+    LOG("  per mover update: " << probe_ns << " ns probing tiles and scanning platforms, " << baked_ns
+        << " ns against the baked boxes (" << probe_ns / baked_ns << "x)");
+    LOG("  on the ground at the end: " << grounded[0] << " / " << grounded[1] << "; " << flush_partings
+        << " movers part ways flush against an edge, " << other_partings << " otherwise"
+        << (other_partings == 0 ? "" : " (UNEXPECTED)"));
+    if (other_partings != 0) g_failed = true;
+}
+
+// ————— SPRITE MASKS ————— //
+// Player and enemy frames thrown at each other at random: how often the hand-tuned boxes
+// disagree with the drawn pixels, and what a pixel test costs per pair
+static void bench_masks()
+{
+    const int PAIRS = 1000000;
+
+    WorldMasks masks;
+    BenchClock::time_point start = BenchClock::now();
+    if (!masks.load("assets/images/player0.png", "assets/images/enemy.png",
+                    "assets/images/bullet.png", "assets/images/bullet2.png"))
+    {
+        LOG("masks: sprite sheets not found; run from the directory holding assets/");
+        return;
+    }
+    double load_ms = seconds_since(start) * 1e3;
+
+    // Box sizes as World::initialise sets them; positions within 1.5 units of each other
+    const float BOX = 0.65f;
+    std::vector<glm::vec3> offsets(PAIRS);
+    std::vector<int>       frames(PAIRS * 2);
+    unsigned int rng = 1234u;
+    for (int i = 0; i < PAIRS; i++)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        offsets[i].x = ((rng >> 8) & 0xFFFF) / 65535.0f * 3.0f - 1.5f;
+        rng = rng * 1664525u + 1013904223u;
+        offsets[i].y = ((rng >> 8) & 0xFFFF) / 65535.0f * 3.0f - 1.5f;
+        offsets[i].z = 0.0f;
+        frames[i * 2]     = (int) ((rng >> 4) % masks.player.get_frame_count());
+        frames[i * 2 + 1] = (int) ((rng >> 12) % masks.enemy.get_frame_count());
+    }
+
+    glm::vec3 player(100.0f, -50.0f, 0.0f);
+    int box_hits = 0, pixel_hits = 0, unfair = 0, missed = 0, narrow = 0;
+    start = BenchClock::now();
+    for (int i = 0; i < PAIRS; i++)
+    {
+        bool hit = masks_overlap(masks.player, frames[i * 2], player, masks.enemy, frames[i * 2 + 1], player + offsets[i]);
+        pixel_hits += hit;
+
+        bool box = fabs(offsets[i].x) < BOX && fabs(offsets[i].y) < BOX;
+        box_hits += box;
+        unfair   += box && !hit;
+        missed   += hit && !box;
+    }
+    double all_ns = seconds_since(start) * 1e9 / PAIRS;
+
+    // Only the pairs whose trimmed boxes overlap, where the rows actually get ANDed
+    std::vector<int> close;
+    for (int i = 0; i < PAIRS; i++)
+    {
+        const MaskFrame &a = masks.player.get_frame(frames[i * 2]), &b = masks.enemy.get_frame(frames[i * 2 + 1]);
+        glm::vec3 other = player + offsets[i];
+        int dx = masks.enemy.get_quad_texel_x(other) + b.x0 - masks.player.get_quad_texel_x(player) - a.x0,
+            dy = masks.enemy.get_quad_texel_y(other) + b.y0 - masks.player.get_quad_texel_y(player) - a.y0;
+        if (dx < a.width && -dx < b.width && dy < a.height && -dy < b.height) close.push_back(i);
+    }
+
+    const int REPEATS = 10;
+    start = BenchClock::now();
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+        for (int i : close)
+            narrow += masks_overlap(masks.player, frames[i * 2], player, masks.enemy, frames[i * 2 + 1], player + offsets[i]);
+    double narrow_ns = seconds_since(start) * 1e9 / ((double) REPEATS * close.size());
+
+    LOG("masks: player and enemy sheets loaded in " << load_ms << " ms, "
+        << SpriteMask::TEXELS_PER_UNIT << " texels per unit");
+    LOG("  " << PAIRS << " random pairs: " << box_hits << " box hits, " << pixel_hits << " pixel hits");
+    LOG("  boxes hit where no pixels touch: " << unfair << "; pixels touch where boxes miss: " << missed);
+    LOG("  " << all_ns << " ns per pair overall, " << narrow_ns << " ns per pair whose bounds overlap ("
+        << close.size() << " of them, " << narrow / REPEATS << " touching)");
+}
+
+// ————— PROJECTILES ————— //
+// 100k shots in flight over a 512x48 level, topped up from 64 emitters every tick: the
+// pool's whole tick (move, cull, refill, hit test, vertex build) against the 60 Hz budget
+static void bench_projectiles()
+{
+    const int   CAPACITY = 100000, EMITTERS = 64, TICKS = 600;
+    const float LEFT = -0.5f, RIGHT = 511.5f, BOTTOM = -47.5f, TOP = 0.5f;
+
+    ProjectilePool pool(CAPACITY);
+    WorldMasks masks;
+    bool have_masks = masks.load("assets/images/player0.png", "assets/images/enemy.png",
+                                 "assets/images/bullet.png", "assets/images/bullet2.png");
+    if (have_masks)
+    {
+        ProjectileSprite sprite;
+        sprite.mask = &masks.projectile_1;
+        pool.set_sprite(0, sprite);
+        sprite.mask = &masks.projectile_2;
+        pool.set_sprite(1, sprite);
+    }
+
+    std::vector<glm::vec3> emitters(EMITTERS);
+    unsigned int rng = 8675309u;
+    for (glm::vec3 &emitter : emitters)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        emitter = glm::vec3(LEFT + 1.0f + (rng >> 8) % 510, BOTTOM + 1.0f + (rng >> 4) % 46, 0.0f);
+    }
+
+    auto refill = [&]() {
+        int spawned = 0;
+        while (pool.get_count() < CAPACITY)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            float angle = (rng >> 8) / 16777216.0f * 6.2831853f, speed = 2.0f + (rng & 7);
+            pool.spawn(emitters[rng % EMITTERS], glm::vec3(cosf(angle) * speed, sinf(angle) * speed, 0.0f),
+                       (rng >> 3) & 1);
+            spawned++;
+        }
+        return spawned;
+    };
+    refill();
+
+    std::vector<float> vertices((size_t) CAPACITY * 12), texture_coordinates((size_t) CAPACITY * 12);
+    glm::vec3 player(256.0f, -24.0f, 0.0f);
+
+    double update_s = 0.0, refill_s = 0.0, hit_s = 0.0, quads_s = 0.0;
+    long long spawned = 0, hit_ticks = 0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        player.x = 256.0f + 100.0f * sinf(tick * 0.01f);
+
+        BenchClock::time_point start = BenchClock::now();
+        pool.update(FIXED_TIMESTEP, LEFT, RIGHT, BOTTOM, TOP);
+        update_s += seconds_since(start);
+
+        start = BenchClock::now();
+        spawned += refill();
+        refill_s += seconds_since(start);
+
+        start = BenchClock::now();
+        bool hit = have_masks ? pool.hits_mask(masks.player, tick % 16, player, 2.0f, 2.0f)
+                              : !pool.find_overlapping(player.x - 0.325f, player.x + 0.325f,
+                                                       player.y - 0.325f, player.y + 0.325f, 0.1f).empty();
+        hit_s += seconds_since(start);
+        hit_ticks += hit;
+
+        start = BenchClock::now();
+        pool.write_quads(vertices.data(), texture_coordinates.data());
+        quads_s += seconds_since(start);
+    }
+
+    // The same motion as one struct per shot, tested and moved one at a time, the way
+    // each shooter's single projectile used to be
+    struct OldProjectile { glm::vec3 position; float speed_x, speed_y; bool active; GLuint texture; };
+    std::vector<OldProjectile> old(CAPACITY);
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        glm::vec3 velocity = pool.get_velocity(i);
+        old[i] = { pool.get_position(i), velocity.x, velocity.y, true, 0 };
+    }
+    BenchClock::time_point start = BenchClock::now();
+    int live = 0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        for (OldProjectile &shot : old)
+        {
+            if (!shot.active) continue;
+            shot.position.x += shot.speed_x * FIXED_TIMESTEP;
+            shot.position.y += shot.speed_y * FIXED_TIMESTEP;
+            if (shot.position.x > RIGHT || shot.position.x < LEFT || shot.position.y > TOP || shot.position.y < BOTTOM)
+                shot.active = false;
+        }
+    }
+    double old_ms = seconds_since(start) * 1e3 / TICKS;
+    for (const OldProjectile &shot : old) live += shot.active;
+
+    double update_ms = update_s * 1e3 / TICKS, refill_ms = refill_s * 1e3 / TICKS,
+           hit_ms    = hit_s * 1e3 / TICKS,    quads_ms  = quads_s * 1e3 / TICKS;
+
+    LOG("projectiles: " << CAPACITY << " in flight for " << TICKS << " ticks ("
+#ifdef __SSE2__
+        << "SSE2"
+#elif defined(__ARM_NEON)
+        << "NEON"
+#else
+        << "scalar"
+#endif
+        << ", " << (have_masks ? "pixel" : "box") << " hits)");
+    LOG("  move and cull " << update_ms << " ms, refill " << refill_ms << " ms (" << spawned / TICKS
+        << " shots per tick), player hit test " << hit_ms << " ms (hit on " << hit_ticks << " ticks)");
+    LOG("  quads for the single draw " << quads_ms << " ms; total " << update_ms + refill_ms + hit_ms + quads_ms
+        << " ms of the 16.7 ms tick");
+    LOG("  one struct per shot, moving only: " << old_ms << " ms per tick (" << live << " left)");
+}
+
+// ————— PARTICLES ————— //
+// Steady streams of bursts over an open level: the pool's update and quad building at
+// 10k and 100k live particles against the 60 Hz budget, three textures, and the same
+// effect made of Entities the way any other object in the game would be
+static void bench_particles()
+{
+    const int   TICKS = 600, BURST = 40;
+    const float DEBRIS_LIFETIME = 1.0f;
+
+    LOG("particles: " << TICKS << " ticks of steady bursts ("
+#ifdef FLOAT4_LANES
+        << "SIMD"
+#else
+        << "scalar"
+#endif
+        << "), ms per tick");
+
+    const int LIVE[] = { 10000, 100000 };
+    for (int live : LIVE)
+    {
+        ParticleSystem particles(live);
+        for (int style = 0; style < EFFECT_COUNT; style++)
+        {
+            ParticleStyle look;
+            look.texture  = style + 1;
+            look.lifetime = DEBRIS_LIFETIME;
+            look.gravity  = style == EFFECT_DEBRIS ? -9.81f : 0.0f;
+            look.drag     = style == EFFECT_DEBRIS ? 0.5f : 2.0f;
+            particles.set_style(style, look);
+        }
+
+        // Lifetimes average 0.75 s, so this many bursts a tick keeps the pool about full
+        int bursts = (int) (live / (0.75f / FIXED_TIMESTEP) / BURST) + 1;
+
+        std::vector<float> vertices((size_t) live * 12), texture_coordinates((size_t) live * 12);
+        int first[ParticleSystem::MAX_STYLES + 1];
+
+        double update_s = 0.0, quads_s = 0.0;
+        int    draws    = 0;
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            for (int burst = 0; burst < bursts; burst++)
+            {
+                glm::vec3 position((float) ((tick * 7 + burst * 13) % 500), -(float) (burst % 40), 0.0f);
+                particles.emit(burst % EFFECT_COUNT, position, glm::vec3(0.0f, 2.0f, 0.0f), 3.0f, BURST);
+            }
+
+            BenchClock::time_point start = BenchClock::now();
+            particles.update(FIXED_TIMESTEP);
+            update_s += seconds_since(start);
+
+            start = BenchClock::now();
+            int batches = particles.write_quads(vertices.data(), texture_coordinates.data(), first);
+            quads_s += seconds_since(start);
+
+            draws = 0;
+            for (int batch = 0; batch < batches; batch++) draws += first[batch + 1] > first[batch];
+        }
+
+        const ParticleStats &stats = particles.get_stats();
+        double update_ms = update_s * 1e3 / TICKS, quads_ms = quads_s * 1e3 / TICKS;
+        LOG("  " << live << " budget: " << stats.count << " alive (" << stats.dropped << " dropped), update "
+            << update_ms << ", quads " << quads_ms << " for " << draws << " draws; "
+            << (update_ms + quads_ms) / 16.7 * 100.0 << "% of the tick");
+    }
+
+    // The same debris as Entities: gravity and collisions through Entity::update over an
+    // open map, one particle each
+    const int ENTITY_PARTICLES = 10000, WIDTH = 512, HEIGHT = 48;
+    std::vector<unsigned int> tiles(WIDTH * HEIGHT, 0);
+    Map map(WIDTH, HEIGHT, tiles.data(), 0, 1.0f, 3, 1);
+
+    int still[4][4] = {};
+    Entity player(0, 3.0f, glm::vec3(0.0f), 5.0f, still, 0.0f, 4, 0, 4, 4, 0.65f, 0.65f, PLAYER);
+    std::vector<Entity> debris(ENTITY_PARTICLES);
+    for (int i = 0; i < ENTITY_PARTICLES; i++)
+    {
+        debris[i] = Entity(0, 1.0f, glm::vec3(0.0f, -9.81f, 0.0f), 0.0f, still, 0.0f, 1, 0, 1, 1, 0.1f, 0.1f, PLATFORM);
+        debris[i].set_position(glm::vec3((float) (i % 500), -(float) (i / 500), 0.0f));
+        debris[i].set_movement(glm::vec3((i & 1) ? 1.0f : -1.0f, 0.0f, 0.0f));
+    }
+    BenchClock::time_point start = BenchClock::now();
+    for (int tick = 0; tick < TICKS; tick++)
+        for (Entity &speck : debris) speck.update(FIXED_TIMESTEP, nullptr, 0, &map);
+    double entity_ms = seconds_since(start) * 1e3 / TICKS;
+
+    LOG("  " << ENTITY_PARTICLES << " as Entities: update " << entity_ms << " (" << sizeof(Entity)
+        << " bytes each, against " << 9 * sizeof(float) + 1 << " in the pool)");
+}
+
+// ————— JOB SYSTEM ————— //
+// The same 4096 worlds stepped on job systems of 1 to 32 threads, and the particle quads
+// written serially and as jobs, which must come out the same
+static void bench_jobs()
+{
+    const int ENV_COUNT = 4096, STEPS = 100;
+    LOG("jobs: " << ENV_COUNT << " worlds for " << STEPS << " steps, " << std::thread::hardware_concurrency()
+        << " hardware threads");
+
+    std::vector<int>           actions(ENV_COUNT);
+    std::vector<float>         rewards(ENV_COUNT);
+    std::vector<unsigned char> dones(ENV_COUNT);
+
+    double single_ms = 0.0;
+    const int THREADS[] = { 1, 2, 4, 8, 16, 32 };
+    for (int threads : THREADS)
+    {
+        VecEnv env(ENV_COUNT, threads);
+        unsigned int rng = 12345u;
+
+        BenchClock::time_point start = BenchClock::now();
+        for (int step = 0; step < STEPS; step++)
+        {
+            for (int i = 0; i < ENV_COUNT; i++)
+            {
+                rng = rng * 1664525u + 1013904223u;
+                actions[i] = (int) ((rng >> 16) % ACTION_COUNT);
+            }
+            env.step(actions.data(), rewards.data(), dones.data());
+        }
+        double step_ms = seconds_since(start) * 1e3 / STEPS;
+        if (threads == 1) single_ms = step_ms;
+
+        LOG("  " << threads << " threads: " << step_ms << " ms per step, " << single_ms / step_ms << "x");
+    }
+
+    // Particle quads over a full pool of 100k
+    const int LIVE = 100000;
+    ParticleSystem particles(LIVE);
+    for (int burst = 0; burst < LIVE / 40; burst++)
+    {
+        glm::vec3 position((float) (burst % 500), -(float) (burst % 40), 0.0f);
+        particles.emit(burst % EFFECT_COUNT, position, glm::vec3(0.0f, 2.0f, 0.0f), 3.0f, 40);
+    }
+    particles.update(FIXED_TIMESTEP);
+
+    std::vector<float> serial_vertices((size_t) LIVE * 12), serial_uvs((size_t) LIVE * 12),
+                       job_vertices((size_t) LIVE * 12), job_uvs((size_t) LIVE * 12);
+    int serial_first[ParticleSystem::MAX_STYLES + 1], job_first[ParticleSystem::MAX_STYLES + 1];
+
+    const int REPEATS = 50;
+    JobSystem jobs;
+    BenchClock::time_point start = BenchClock::now();
+    int batches = 0;
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+        batches = particles.write_quads(serial_vertices.data(), serial_uvs.data(), serial_first);
+    double serial_ms = seconds_since(start) * 1e3 / REPEATS;
+
+    start = BenchClock::now();
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+        particles.write_quads(job_vertices.data(), job_uvs.data(), job_first, &jobs);
+    double job_ms = seconds_since(start) * 1e3 / REPEATS;
+
+    bool same = memcmp(serial_first, job_first, sizeof(int) * (batches + 1)) == 0 &&
+                memcmp(serial_vertices.data(), job_vertices.data(), sizeof(float) * 12 * serial_first[batches]) == 0 &&
+                memcmp(serial_uvs.data(), job_uvs.data(), sizeof(float) * 12 * serial_first[batches]) == 0;
+
+    LOG("  " << particles.get_stats().count << " particle quads: serial " << serial_ms << " ms, on "
+        << jobs.get_thread_count() << " threads " << job_ms << " ms (" << serial_ms / job_ms << "x), "
+        << (same ? "identical" : "DIFFERENT"));
+    if (!same) g_failed = true;
+}
+
+// ————— PIXEL OBSERVATIONS ————— //
+#ifdef RISE_EGL_HEADLESS
+// Renders 256 worlds into 64x48 tiles per pass; the readback of each pass overlaps the
+// simulation step that follows it
+static void bench_pixels()
+{
+    if (!create_headless_gl_context())
+    {
+        LOG("pixels: could not create a surfaceless EGL context");
+        return;
+    }
+
+    const int ENV_COUNT = 256, TILE_WIDTH = 64, TILE_HEIGHT = 48, FRAMES = 200;
+
+    ShaderProgram program;
+    program.load("shaders/vertex_textured.glsl", "shaders/fragment_textured.glsl");
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    WorldTextures textures;
+    textures.player       = load_texture("assets/images/player0.png");
+    textures.enemy        = load_texture("assets/images/enemy.png");
+    const char *projectile_files[] = { "assets/images/bullet.png", "assets/images/bullet2.png" };
+    textures.projectiles = load_texture_atlas(projectile_files, 2, textures.projectile_uvs);
+
+    VecEnv env(ENV_COUNT);
+    Map map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, load_texture("assets/images/tileset_1.png"), 1.0f, 3, 1);
+    PixelRenderer renderer(ENV_COUNT, TILE_WIDTH, TILE_HEIGHT);
+    if (!renderer.is_complete())
+    {
+        LOG("pixels: render target incomplete (status 0x" << std::hex << renderer.get_framebuffer_status() << std::dec << ")");
+        g_failed = true;
+        return;
+    }
+
+    // Headless worlds carry no textures; give these ones the real sprites
+    std::vector<World> worlds(env.get_worlds(), env.get_worlds() + ENV_COUNT);
+    for (int i = 0; i < ENV_COUNT; i++) worlds[i].initialise(textures, &map, (i % 16) * 0.05f);
+
+    std::vector<int>           actions(ENV_COUNT, ACTION_RIGHT);
+    std::vector<float>         rewards(ENV_COUNT);
+    std::vector<unsigned char> dones(ENV_COUNT);
+
+    double render_seconds = 0.0, read_seconds = 0.0;
+    unsigned long long checksum = 0;
+
+    BenchClock::time_point start = BenchClock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        BenchClock::time_point render_start = BenchClock::now();
+        renderer.render(worlds.data(), &map, &program);
+        render_seconds += seconds_since(render_start);
+
+        // CPU work while the pixels travel
+        env.step(actions.data(), rewards.data(), dones.data());
+        for (int i = 0; i < ENV_COUNT; i++)
+        {
+            worlds[i].apply_action(ACTION_RIGHT);
+            worlds[i].update(FIXED_TIMESTEP, &map);
+        }
+
+        BenchClock::time_point read_start = BenchClock::now();
+        const unsigned char *pixels = renderer.read_pixels();
+        read_seconds += seconds_since(read_start);
+        if (pixels) checksum += pixels[(renderer.get_atlas_width() * 24 + 32) * 4];
+    }
+    double elapsed = seconds_since(start);
+
+    LOG("pixels: " << ENV_COUNT << " worlds in a " << renderer.get_atlas_width() << "x"
+        << renderer.get_atlas_height() << " target, " << (const char *) glGetString(GL_RENDERER));
+    LOG("  " << render_seconds * 1e3 / FRAMES << " ms submit, " << read_seconds * 1e3 / FRAMES
+        << " ms readback wait per pass");
+    LOG("  " << (long long) (ENV_COUNT * (double) FRAMES / elapsed) << " world frames/s including simulation"
+        << " (checksum " << checksum << ")");
+}
+#endif
+
+// ————— DISPATCH ————— //
+struct Benchmark
+{
+    const char *name;
+    void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] =
+{
+    { "vec_env",     bench_vec_env     },
+    { "jobs",        bench_jobs        },
+    { "pipeline",    bench_pipeline    },
+    { "render_thread", bench_render_thread },
+    { "arena",       bench_arena       },
+    { "allocations", bench_allocations },
+    { "observation", bench_observation },
+    { "ai_dispatch", bench_ai_dispatch },
+    { "nav",         bench_nav         },
+    { "flow",        bench_flow        },
+    { "los",         bench_los         },
+    { "pyramid",     bench_pyramid     },
+    { "map_build",   bench_map_build   },
+    { "tiles",       bench_tiles       },
+    { "tile_edit",   bench_tile_edit   },
+    { "colliders",   bench_colliders   },
+    { "masks",       bench_masks       },
+    { "projectiles", bench_projectiles },
+    { "particles",   bench_particles   },
+    { "entity_pool", bench_entity_pool },
+    { "hot_cold",    bench_hot_cold    },
+    { "archetypes",  bench_archetypes  },
+    { "partition",   bench_partition   },
+    { "kinematics",  bench_kinematics  },
+#ifdef RISE_EGL_HEADLESS
+    { "pixels",      bench_pixels      },
+#endif
+};
+
+int run_benchmark(const char *name)
+{
+    bool found = false;
+
+    for (const Benchmark &benchmark : BENCHMARKS)
+    {
+        if (strcmp(name, "all") != 0 && strcmp(name, benchmark.name) != 0) continue;
+        benchmark.run();
+        found = true;
+    }
+
+    if (!found)
+    {
+        LOG("Unknown benchmark '" << name << "'. Available:");
+        for (const Benchmark &benchmark : BENCHMARKS) LOG("  " << benchmark.name);
+        return 1;
+    }
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Headless micro-benchmarks, run with `SDLProject --bench <name>` (or `--bench all`).
+// None of them open a window, so they also run on CI machines; the ones that need OpenGL
+// are only compiled in with RISE_EGL_HEADLESS (EGL surfaceless, e.g. Mesa llvmpipe).
+// Some also check what they measure, and run_benchmark() returns 1 if any check failed;
+// `allocations` needs a build with RISE_TRACK_ALLOCATIONS to check anything.
+int run_benchmark(const char *name);
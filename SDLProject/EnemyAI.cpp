@@ -0,0 +1,86 @@
+#include <algorithm>
+#include "EnemyAI.h"
+
+void sort_by_ai_type(Entity *enemies, int enemy_count, AIGroups *groups)
+{
+    std::stable_sort(enemies, enemies + enemy_count, [](const Entity &a, const Entity &b) {
+        return a.get_ai_type() < b.get_ai_type();
+    });
+
+    for (int type = 0; type <= AI_TYPE_COUNT; type++) groups->begin[type] = 0;
+    for (int i = 0; i < enemy_count; i++) groups->begin[enemies[i].get_ai_type() + 1]++;
+    for (int type = 0; type < AI_TYPE_COUNT; type++) groups->begin[type + 1] += groups->begin[type];
+}
+
+bool AIBehaviour<GUARD>::follow_path(AIAgent &enemy, AIContext &context)
+{
+    if (context.nav == nullptr || context.map == nullptr) return false;
+    if (context.planner == nullptr && context.flow_fields == nullptr) return false;
+
+    // Which of the level's graphs fits this enemy's jump is worked out once
+    if (enemy.ai.nav_graph == AIComponent::NAV_GRAPH_UNKNOWN) {
+        enemy.ai.nav_graph = context.nav->find_graph(make_nav_profile(enemy.body, context.map->get_tile_size()));
+        if (enemy.ai.nav_graph < 0) enemy.ai.nav_graph = AIComponent::NAV_GRAPH_NONE;
+    }
+    if (enemy.ai.nav_graph < 0) return false;
+
+    // In the air there is nothing to decide; keep going the way the last link pointed. The
+    // bottom flag is still set on the tick after a jump, hence the velocity check.
+    if (!enemy.body.collided_bottom || enemy.body.velocity.y > 0.0f) return enemy.body.movement.x != 0.0f;
+
+    const NavGraph &graph = context.nav->get_graph(enemy.ai.nav_graph);
+    int from = graph.find_node(*context.map, enemy.body.position),
+        goal = graph.find_node(*context.map, context.player.get_position());
+
+    if (from < 0 || goal < 0) return false;
+
+    NavLink link;
+    if (context.flow_fields != nullptr) {
+        FlowField &flow = context.flow_fields[enemy.ai.nav_graph];
+        flow.update(graph, goal); // no-op unless the player reached another node
+        if (!flow.next_link(from, &link)) return false;
+    } else if (!context.planner->next_link(graph, from, goal, &link)) {
+        return false;
+    }
+
+    if (graph.get_node_x(link.node) < graph.get_node_x(from)) {
+        enemy.body.movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+        enemy.animation.direction = LEFT;
+    } else {
+        enemy.body.movement = glm::vec3(1.0f, 0.0f, 0.0f);
+        enemy.animation.direction = RIGHT;
+    }
+    if (link.type == NAV_JUMP) enemy.body.is_jumping = true;
+
+    return true;
+}
+
+template <AIType TYPE>
+static void run_ai_group(Entity *enemies, const AIGroups &groups, AIContext &context)
+{
+    for (int i = groups.begin[TYPE]; i < groups.begin[TYPE + 1]; i++)
+    {
+        AIAgent agent(enemies[i]);
+        AIBehaviour<TYPE>::run(agent, context);
+    }
+}
+
+void run_ai(Entity *enemies, const AIGroups &groups, AIContext &context)
+{
+    run_ai_group<WALKER>(enemies, groups, context);
+    run_ai_group<GUARD>(enemies, groups, context);
+    run_ai_group<JUMPER>(enemies, groups, context);
+    run_ai_group<PATROL>(enemies, groups, context);
+    run_ai_group<SHOOTER>(enemies, groups, context);
+}
+
+void run_ai_agent(AIAgent &agent, AIContext &context)
+{
+    switch (agent.ai.type) {
+        case WALKER:  AIBehaviour<WALKER>::run(agent, context);  break;
+        case GUARD:   AIBehaviour<GUARD>::run(agent, context);   break;
+        case JUMPER:  AIBehaviour<JUMPER>::run(agent, context);  break;
+        case PATROL:  AIBehaviour<PATROL>::run(agent, context);  break;
+        case SHOOTER: AIBehaviour<SHOOTER>::run(agent, context); break;
+    }
+}
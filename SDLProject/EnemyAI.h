@@ -0,0 +1,173 @@
+#pragma once
+#include "Entity.h"
+#include "Navigation.h"
+#include "Projectiles.h"
+#include "EntityPool.h"
+
+constexpr int AI_TYPE_COUNT = SHOOTER + 1;
+
+// What the behaviours may look at besides the enemy itself. Navigation is optional: with
+// no level graphs or no planner, chasers walk straight at the player. When flow_fields
+// is set (one per graph in nav), chasers read their way from those instead of the planner.
+// Shooters fire into projectiles, and hold fire without one; a pooled shooter's shots carry
+// its EntityHandle id as their owner.
+struct AIContext
+{
+    const Entity   &player;
+    const Map      *map         = nullptr;
+    const NavLevel *nav         = nullptr;
+    NavPlanner     *planner     = nullptr;
+    FlowField      *flow_fields = nullptr;
+    ProjectilePool *projectiles = nullptr;
+
+    AIContext(const Entity &player) : player(player) { }
+    AIContext(const Entity &player, const Map *map, const NavLevel *nav, NavPlanner *planner) :
+        player(player), map(map), nav(nav), planner(planner) { }
+};
+
+// Whether enemy can see the player past the map's tiles. Without a map there is nothing
+// to block the view.
+inline bool can_see_player(const EntityBody &enemy, const AIContext &context)
+{
+    return context.map == nullptr || context.map->has_line_of_sight(enemy.position, context.player.get_position());
+}
+
+// The parts of one enemy a behaviour reads and writes, wherever they are kept: an Entity,
+// or a row of a ComponentStore's columns. id is what its shots carry as their owner.
+struct AIAgent
+{
+    EntityBody         &body;
+    AIComponent        &ai;
+    AnimationComponent &animation;
+    int                 id;
+
+    AIAgent(EntityBody &body, AIComponent &ai, AnimationComponent &animation, int id = -1) :
+        body(body), ai(ai), animation(animation), id(id) { }
+    explicit AIAgent(Entity &entity) :
+        body(entity.get_body()), ai(entity.get_ai()), animation(entity.get_animation()), id(entity.get_pool_id()) { }
+};
+
+// ————— BEHAVIOURS ————— //
+// One specialisation per AIType. Each is resolved at compile time, so a loop over enemies
+// of a single type has no switch and no virtual call in it, and the body can be inlined.
+template <AIType TYPE> struct AIBehaviour;
+
+template <> struct AIBehaviour<WALKER>
+{
+    static void run(AIAgent &enemy, AIContext &)
+    {
+        enemy.body.movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+    }
+};
+
+template <> struct AIBehaviour<GUARD>
+{
+    // Steers along the level's navigation graph; false if there is no usable path this tick
+    static bool follow_path(AIAgent &enemy, AIContext &context);
+
+    static void run(AIAgent &enemy, AIContext &context)
+    {
+        const Entity &player = context.player;
+
+        switch (enemy.ai.state) {
+            case IDLE:
+                if (glm::distance(enemy.body.position, player.get_position()) < 3.0f &&
+                    can_see_player(enemy.body, context)) {
+                    enemy.ai.state = WALKING;
+                }
+                break;
+
+            case WALKING:
+                if (follow_path(enemy, context)) break;
+
+                if (enemy.body.position.x > player.get_position().x) {
+                    enemy.body.movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+                } else {
+                    enemy.body.movement = glm::vec3(1.0f, 0.0f, 0.0f);
+                }
+                break;
+
+            case ATTACKING:
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+template <> struct AIBehaviour<JUMPER>
+{
+    static void run(AIAgent &enemy, AIContext &)
+    {
+        if (enemy.ai.state == JUMPING && enemy.body.collided_bottom) {
+            enemy.body.is_jumping = true;
+        }
+    }
+};
+
+template <> struct AIBehaviour<PATROL>
+{
+    static void run(AIAgent &enemy, AIContext &)
+    {
+        if (enemy.ai.state != PATROLLING) return;
+
+        if (enemy.body.movement.x < 0) { // Moving left
+            enemy.body.movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+            enemy.animation.direction = LEFT; // set entity texture to left-facing animation frames
+        } else { // Moving right
+            enemy.body.movement = glm::vec3(1.0f, 0.0f, 0.0f);
+            enemy.animation.direction = RIGHT; // Set entity texture to right-facing animation frames
+        }
+
+        // Flip direction if a collision (into a wall) is detected
+        if (enemy.body.collided_left) {
+            enemy.body.movement.x = 1.0f;  // Flip to move right
+            enemy.animation.direction = RIGHT; // right-facing animation frames
+        } else if (enemy.body.collided_right) {
+            enemy.body.movement.x = -1.0f; // Flip to move left
+            enemy.animation.direction = LEFT; // left-facing animation frames
+        }
+    }
+};
+
+template <> struct AIBehaviour<SHOOTER>
+{
+    static void run(AIAgent &enemy, AIContext &context)
+    {
+        if (!enemy.ai.projectile_active && context.projectiles != nullptr && can_see_player(enemy.body, context)) {
+            // Straight along +x, one shot at a time
+            enemy.ai.projectile_active = context.projectiles->spawn(enemy.body.position, glm::vec3(5.0f, 0.0f, 0.0f),
+                                                                   enemy.ai.projectile_sprite, enemy.id);
+        }
+    }
+};
+
+// ————— BATCHED DISPATCH ————— //
+// Enemies sorted so that each AIType occupies one contiguous run:
+// type t lives in [begin[t], begin[t + 1])
+struct AIGroups
+{
+    int begin[AI_TYPE_COUNT + 1] = { 0 };
+};
+
+// Stable-sorts enemies by AI type (keeping their relative order within a type) and
+// records where each type's run starts
+void sort_by_ai_type(Entity *enemies, int enemy_count, AIGroups *groups);
+
+// The runs of a pool whose groups are AI types (one group per AIType), which it keeps
+// contiguous as enemies come and go, so no sort is needed
+inline AIGroups get_ai_groups(const EntityPool &enemies)
+{
+    AIGroups groups;
+    for (int type = 0; type <= AI_TYPE_COUNT; type++) groups.begin[type] = enemies.get_group_begin(type);
+    return groups;
+}
+
+// Runs one tight, specialised loop per AI type over every enemy given, all of which must be
+// active (an EntityPool keeps them so). This is the only place AI runs each tick.
+void run_ai(Entity *enemies, const AIGroups &groups, AIContext &context);
+
+// Runs the behaviour of agent's AI type, picked with a switch, for callers whose enemies
+// are not sorted by type
+void run_ai_agent(AIAgent &agent, AIContext &context);
@@ -15,15 +15,22 @@
 #endif
 
 #define GL_GLEXT_PROTOTYPES 1
+#include <algorithm>
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
 #include "Entity.h"
+#include "EnemyAI.h"
+#include "StaticColliders.h"
+#include "SpriteMask.h"
+#include "Kinematics.h"
+#include "RenderThread.h"
 
+// Single-enemy entry point; per-tick AI goes through run_ai() in EnemyAI.cpp instead
 void Entity::ai_activate(Entity *player) {
-    switch (m_ai_type) {
+    switch (m_ai.type) {
         case WALKER:
             ai_walk();
             break;
@@ -43,122 +50,68 @@ void Entity::ai_activate(Entity *player) {
     }
 }
 
-void Entity::ai_walk()
-{
-    m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-}
-
-void Entity::ai_guard(Entity *player)
-{
-    switch (m_ai_state) {
-        case IDLE:
-            if (glm::distance(m_position, player->get_position()) < 3.0f) {
-                m_ai_state = WALKING;
-            }
-            break;
-            
-        case WALKING:
-            if (m_position.x > player->get_position().x) {
-                m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-            } else {
-                m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
-            }
-            break;
-            
-        case ATTACKING:
-            break;
-            
-        default:
-            break;
-    }
-}
-
-
-void Entity::ai_jump() {
-    if (m_ai_state == JUMPING && m_collided_bottom) {
-        m_is_jumping = true;
-    }
-}
-
-void Entity::ai_patrol() {
-    if (m_ai_state != PATROLLING) return;
-
-    if (m_movement.x < 0) { // Moving left
-        m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-        m_animation_indices = m_walking[0]; // set entity texture to left-facing animation frames
-    } else { // Moving right
-        m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
-        m_animation_indices = m_walking[1]; // Set entity texture to right-facing animation frames
-    }
-
-    // Flip direction if a collision (into a wall) is detected
-    if (m_collided_left) {
-        m_movement.x = 1.0f;  // Flip to move right
-        m_animation_indices = m_walking[1]; // right-facing animation frames
-    } else if (m_collided_right) {
-        m_movement.x = -1.0f; // Flip to move left
-        m_animation_indices = m_walking[0]; // left-facing animation frames
-    }
-}
-
-
-void Entity::ai_shoot(Entity* player) {
-    if (!m_projectile_active) {
-        m_projectile_position = m_position;
-        m_projectile_active = true;
-        m_projectile_speed = 5.0f;
-    }
-}
+// These have no level to navigate, so a guard called this way walks straight at the player
+void Entity::ai_walk()                { AIContext context(*this);   AIAgent agent(*this); AIBehaviour<WALKER>::run(agent, context); }
+void Entity::ai_guard(Entity *player) { AIContext context(*player); AIAgent agent(*this); AIBehaviour<GUARD>::run(agent, context); }
+void Entity::ai_jump()                { AIContext context(*this);   AIAgent agent(*this); AIBehaviour<JUMPER>::run(agent, context); }
+void Entity::ai_patrol()              { AIContext context(*this);   AIAgent agent(*this); AIBehaviour<PATROL>::run(agent, context); }
+void Entity::ai_shoot(Entity* player) { AIContext context(*player); AIAgent agent(*this); AIBehaviour<SHOOTER>::run(agent, context); }
 
 
 // Default constructor
-Entity::Entity()
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(0.0f), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(0), m_velocity(0.0f), m_acceleration(0.0f), m_width(0.0f), m_height(0.0f)
+Entity::Entity() : m_scale(1.0f, 1.0f, 0.0f)
 {
-    // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    m_body.width  = 0.0f;
+    m_body.height = 0.0f;
 }
 
 // Parameterized constructor
 Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float jump_power, int walking[4][4], float animation_time,
     int animation_frames, int animation_index, int animation_cols,
     int animation_rows, float width, float height, EntityType EntityType)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed),m_acceleration(acceleration), m_jumping_power(jump_power), m_animation_cols(animation_cols),
-    m_animation_frames(animation_frames), m_animation_index(animation_index),
-    m_animation_rows(animation_rows), m_animation_indices(nullptr),
-    m_animation_time(animation_time), m_texture_id(texture_id), m_velocity(0.0f),
-    m_width(width), m_height(height), m_entity_type(EntityType)
+    : m_entity_type(EntityType), m_scale(1.0f, 1.0f, 0.0f)
 {
+    m_sprite.texture = texture_id;
+
+    m_body.speed         = speed;
+    m_body.acceleration  = glm::vec2(acceleration);
+    m_body.jumping_power = jump_power;
+    m_body.width         = width;
+    m_body.height        = height;
+
+    m_animation.time   = animation_time;
+    m_animation.frames = animation_frames;
+    m_animation.index  = animation_index;
+    m_animation.cols   = animation_cols;
+    m_animation.rows   = animation_rows;
+
     face_right();
     set_walking(walking);
 }
 
 // Simpler constructor for partial initialization
 Entity::Entity(GLuint texture_id, float speed,  float width, float height, EntityType EntityType)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(0.0f), m_width(width), m_height(height),m_entity_type(EntityType)
+    : m_entity_type(EntityType), m_scale(1.0f, 1.0f, 0.0f)
 {
-    // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    m_sprite.texture = texture_id;
+
+    m_body.speed  = speed;
+    m_body.width  = width;
+    m_body.height = height;
 }
 
 
-Entity::Entity(GLuint texture_id, float speed, float width, float height, EntityType EntityType, AIType AIType, AIState AIState): m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(0.0f), m_width(width), m_height(height),m_entity_type(EntityType), m_ai_type(AIType), m_ai_state(AIState)
+Entity::Entity(GLuint texture_id, float speed, float width, float height, EntityType EntityType, AIType AIType, AIState AIState)
+    : m_entity_type(EntityType), m_scale(1.0f, 1.0f, 0.0f)
 {
-// Initialize m_walking with zeros or any default value
-for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-    for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    m_sprite.texture = texture_id;
+
+    m_body.speed  = speed;
+    m_body.width  = width;
+    m_body.height = height;
+
+    m_ai.type  = AIType;
+    m_ai.state = AIState;
 }
 
 Entity::~Entity() { }
@@ -166,12 +119,12 @@ Entity::~Entity() { }
 void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index)
 {
     // Step 1: Calculate the UV location of the indexed frame
-    float u_coord = (float)(index % m_animation_cols) / (float)m_animation_cols;
-    float v_coord = (float)(index / m_animation_cols) / (float)m_animation_rows;
+    float u_coord = (float)(index % m_animation.cols) / (float)m_animation.cols;
+    float v_coord = (float)(index / m_animation.cols) / (float)m_animation.rows;
 
     // Step 2: Calculate its UV size
-    float width = 1.0f / (float)m_animation_cols;
-    float height = 1.0f / (float)m_animation_rows;
+    float width = 1.0f / (float)m_animation.cols;
+    float height = 1.0f / (float)m_animation.rows;
 
     // Step 3: Just as we have done before, match the texture coordinates to the vertices
     float tex_coords[] =
@@ -201,14 +154,62 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint textu
     glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
 }
 
+// ————— ANIMATION ————— //
+void AnimationComponent::step(const EntityBody &body, float delta_time)
+{
+    // Updating the animation only if the entity is moving
+    if (glm::length(body.movement) != 0) {
+        time += delta_time;
+        float frames_per_second = (float) 1 / Entity::SECONDS_PER_FRAME;
+
+        if (time >= frames_per_second) {
+            time = 0.0f;
+            index++;
+
+            if (index >= frames) {
+                index = 0;
+            }
+        }
+    }
+}
+
+int AnimationComponent::get_frame() const
+{
+    return direction < 0 ? 0 : walking[direction][index];
+}
+
+glm::vec4 AnimationComponent::get_uv_rect() const
+{
+    if (direction < 0) return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+    int frame = walking[direction][index];
+    return glm::vec4((float)(frame % cols) / (float)cols,
+                     (float)(frame / cols) / (float)rows,
+                     1.0f / (float)cols,
+                     1.0f / (float)rows);
+}
+
+// The (u, v, width, height) of the frame render() would draw; the whole texture when not animated
+glm::vec4 const Entity::get_sprite_uv_rect() const { return m_animation.get_uv_rect(); }
+int       const Entity::get_sprite_frame()   const { return m_animation.get_frame();   }
+
 bool const Entity::check_collision(Entity* other) const
 {
-    float x_distance = fabs(m_position.x - other->m_position.x) - ((m_width + other->m_width) / 2.0f);
-    float y_distance = fabs(m_position.y - other->m_position.y) - ((m_height + other->m_height) / 2.0f);
+    float x_distance = fabs(m_body.position.x - other->m_body.position.x) - ((m_body.width + other->m_body.width) / 2.0f);
+    float y_distance = fabs(m_body.position.y - other->m_body.position.y) - ((m_body.height + other->m_body.height) / 2.0f);
 
     return x_distance < 0.0f && y_distance < 0.0f;
 }
 
+bool const Entity::check_sprite_collision(const Entity *other) const
+{
+    if (m_sprite.mask == nullptr || other->m_sprite.mask == nullptr)
+        return check_collision(const_cast<Entity *>(other));
+
+    return masks_overlap(*m_sprite.mask, get_sprite_frame(), m_body.position,
+                         *other->m_sprite.mask, other->get_sprite_frame(), other->m_body.position);
+}
+
 void const Entity::check_collision_y(Entity *collidable_entities, int collidable_entity_count)
 {
     for (int i = 0; i < collidable_entity_count; i++)
@@ -217,22 +218,22 @@ void const Entity::check_collision_y(Entity *collidable_entities, int collidable
         
         if (check_collision(collidable_entity))
         {
-            float y_distance = fabs(m_position.y - collidable_entity->m_position.y);
-            float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->m_height / 2.0f));
-            if (m_velocity.y > 0)
+            float y_distance = fabs(m_body.position.y - collidable_entity->m_body.position.y);
+            float y_overlap = fabs(y_distance - (m_body.height / 2.0f) - (collidable_entity->m_body.height / 2.0f));
+            if (m_body.velocity.y > 0)
             {
-                m_position.y   -= y_overlap;
-                m_velocity.y    = 0;
+                m_body.position.y   -= y_overlap;
+                m_body.velocity.y    = 0;
 
                 // Collision!
-                m_collided_top  = true;
-            } else if (m_velocity.y < 0)
+                m_body.collided_top  = true;
+            } else if (m_body.velocity.y < 0)
             {
-                m_position.y      += y_overlap;
-                m_velocity.y       = 0;
+                m_body.position.y      += y_overlap;
+                m_body.velocity.y       = 0;
 
                 // Collision!
-                m_collided_bottom  = true;
+                m_body.collided_bottom  = true;
             }
         }
     }
@@ -246,17 +247,17 @@ void const Entity::check_collision_x(Entity *collidable_entities, int collidable
         if (!collidable_entity->is_active()) continue;
 
         if (check_collision(collidable_entity)) {
-            float x_distance = fabs(m_position.x - collidable_entity->m_position.x);
-            float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->m_width / 2.0f));
-
-            if (m_velocity.x > 0) {
-                m_position.x -= x_overlap;
-                m_velocity.x = 0;
-                m_collided_right = true;
-            } else if (m_velocity.x < 0) {
-                m_position.x += x_overlap;
-                m_velocity.x = 0;
-                m_collided_left = true;
+            float x_distance = fabs(m_body.position.x - collidable_entity->m_body.position.x);
+            float x_overlap = fabs(x_distance - (m_body.width / 2.0f) - (collidable_entity->m_body.width / 2.0f));
+
+            if (m_body.velocity.x > 0) {
+                m_body.position.x -= x_overlap;
+                m_body.velocity.x = 0;
+                m_body.collided_right = true;
+            } else if (m_body.velocity.x < 0) {
+                m_body.position.x += x_overlap;
+                m_body.velocity.x = 0;
+                m_body.collided_left = true;
             }
 
             // Check if the collision is with a projectile
@@ -271,202 +272,314 @@ void const Entity::check_collision_x(Entity *collidable_entities, int collidable
     }
 }
 
-void const Entity::check_collision_y(Map *map)
+// ————— BODY COLLISIONS ————— //
+// These touch nothing but the body, so they serve Entity::update and update_bodies() alike
+static void collide_y(EntityBody &body, Map *map)
 {
     // Probes for tiles above
-    glm::vec3 top = glm::vec3(m_position.x, m_position.y + (m_height / 2), m_position.z);
-    glm::vec3 top_left = glm::vec3(m_position.x - (m_width / 2), m_position.y + (m_height / 2), m_position.z);
-    glm::vec3 top_right = glm::vec3(m_position.x + (m_width / 2), m_position.y + (m_height / 2), m_position.z);
+    glm::vec3 top = glm::vec3(body.position.x, body.position.y + (body.height / 2), body.position.z);
+    glm::vec3 top_left = glm::vec3(body.position.x - (body.width / 2), body.position.y + (body.height / 2), body.position.z);
+    glm::vec3 top_right = glm::vec3(body.position.x + (body.width / 2), body.position.y + (body.height / 2), body.position.z);
     
     // Probes for tiles below
-    glm::vec3 bottom = glm::vec3(m_position.x, m_position.y - (m_height / 2), m_position.z);
-    glm::vec3 bottom_left = glm::vec3(m_position.x - (m_width / 2), m_position.y - (m_height / 2), m_position.z);
-    glm::vec3 bottom_right = glm::vec3(m_position.x + (m_width / 2), m_position.y - (m_height / 2), m_position.z);
+    glm::vec3 bottom = glm::vec3(body.position.x, body.position.y - (body.height / 2), body.position.z);
+    glm::vec3 bottom_left = glm::vec3(body.position.x - (body.width / 2), body.position.y - (body.height / 2), body.position.z);
+    glm::vec3 bottom_right = glm::vec3(body.position.x + (body.width / 2), body.position.y - (body.height / 2), body.position.z);
     
     float penetration_x = 0;
     float penetration_y = 0;
     
     // If the map is solid, check the top three points
-    if (map->is_solid(top, &penetration_x, &penetration_y) && m_velocity.y > 0)
+    if (map->is_solid(top, &penetration_x, &penetration_y) && body.velocity.y > 0)
     {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
+        body.position.y -= penetration_y;
+        body.velocity.y = 0;
+        body.collided_top = true;
     }
-    else if (map->is_solid(top_left, &penetration_x, &penetration_y) && m_velocity.y > 0)
+    else if (map->is_solid(top_left, &penetration_x, &penetration_y) && body.velocity.y > 0)
     {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
+        body.position.y -= penetration_y;
+        body.velocity.y = 0;
+        body.collided_top = true;
     }
-    else if (map->is_solid(top_right, &penetration_x, &penetration_y) && m_velocity.y > 0)
+    else if (map->is_solid(top_right, &penetration_x, &penetration_y) && body.velocity.y > 0)
     {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
+        body.position.y -= penetration_y;
+        body.velocity.y = 0;
+        body.collided_top = true;
     }
     
     // And the bottom three points
-    if (map->is_solid(bottom, &penetration_x, &penetration_y) && m_velocity.y < 0)
+    if (map->is_solid(bottom, &penetration_x, &penetration_y) && body.velocity.y < 0)
     {
-        m_position.y += penetration_y;
-        m_velocity.y = 0;
-        m_collided_bottom = true;
+        body.position.y += penetration_y;
+        body.velocity.y = 0;
+        body.collided_bottom = true;
     }
-    else if (map->is_solid(bottom_left, &penetration_x, &penetration_y) && m_velocity.y < 0)
+    else if (map->is_solid(bottom_left, &penetration_x, &penetration_y) && body.velocity.y < 0)
     {
-            m_position.y += penetration_y;
-            m_velocity.y = 0;
-            m_collided_bottom = true;
+            body.position.y += penetration_y;
+            body.velocity.y = 0;
+            body.collided_bottom = true;
     }
-    else if (map->is_solid(bottom_right, &penetration_x, &penetration_y) && m_velocity.y < 0)
+    else if (map->is_solid(bottom_right, &penetration_x, &penetration_y) && body.velocity.y < 0)
     {
-        m_position.y += penetration_y;
-        m_velocity.y = 0;
-        m_collided_bottom = true;
+        body.position.y += penetration_y;
+        body.velocity.y = 0;
+        body.collided_bottom = true;
         
     }
 }
 
-void const Entity::check_collision_x(Map *map)
+static void collide_x(EntityBody &body, Map *map)
 {
     // Probes for tiles; the x-checking is much simpler
-    glm::vec3 left  = glm::vec3(m_position.x - (m_width / 2), m_position.y, m_position.z);
-    glm::vec3 right = glm::vec3(m_position.x + (m_width / 2), m_position.y, m_position.z);
+    glm::vec3 left  = glm::vec3(body.position.x - (body.width / 2), body.position.y, body.position.z);
+    glm::vec3 right = glm::vec3(body.position.x + (body.width / 2), body.position.y, body.position.z);
     
     float penetration_x = 0;
     float penetration_y = 0;
     
-    if (map->is_solid(left, &penetration_x, &penetration_y) && m_velocity.x < 0)
+    if (map->is_solid(left, &penetration_x, &penetration_y) && body.velocity.x < 0)
     {
-        m_position.x += penetration_x;
-        m_velocity.x = 0;
-        m_collided_left = true;
+        body.position.x += penetration_x;
+        body.velocity.x = 0;
+        body.collided_left = true;
     }
-    if (map->is_solid(right, &penetration_x, &penetration_y) && m_velocity.x > 0)
+    if (map->is_solid(right, &penetration_x, &penetration_y) && body.velocity.x > 0)
     {
-        m_position.x -= penetration_x;
-        m_velocity.x = 0;
-        m_collided_right = true;
+        body.position.x -= penetration_x;
+        body.velocity.x = 0;
+        body.collided_right = true;
     }
 }
 
+// Merged boxes can be much bigger than a tile, so the push is measured from the edge of
+// the box the entity moved into, and the deepest one wins. Boxes that only graze the
+// entity along the other axis (by less than COLLISION_SKIN) are not walls or floors for
+// this move: without that, standing on a floor would read as running into its side.
+// An entity already inside a box before this move (spawned into a wall, say) is pushed
+// out whichever way is shorter: vertically, or sideways against its walking direction.
+static const float COLLISION_SKIN = 0.001f;
+static const int   MAX_STATIC_CONTACTS = 32;
 
-void Entity::update(float delta_time, Entity *player, Entity *collidable_entities, int collidable_entity_count, Map *map)
+static void collide_y(EntityBody &body, const StaticColliders *statics, float distance_moved)
 {
-    if (!m_is_active) return;
+    if (body.velocity.y == 0) return;
 
-    m_collided_top = false;
-    m_collided_bottom = false;
-    m_collided_left = false;
-    m_collided_right = false;
+    float left   = body.position.x - (body.width / 2),  right = body.position.x + (body.width / 2),
+          bottom = body.position.y - (body.height / 2), top   = body.position.y + (body.height / 2);
 
-    if (m_entity_type == ENEMY) ai_activate(player);
+    int boxes[MAX_STATIC_CONTACTS];
+    int count = statics->query(left + COLLISION_SKIN, bottom, right - COLLISION_SKIN, top, boxes, MAX_STATIC_CONTACTS);
+    if (count == 0) return;
 
-    if (m_projectile_active) {
-        m_projectile_position.x += m_projectile_speed * delta_time;
-
-        // Deactivate projectile if it moves out of screen bounds
-        if (m_projectile_position.x > map->get_right_bound() || m_projectile_position.x < map->get_left_bound()) {
-            m_projectile_active = false;
+    float push = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        const StaticBox &box = statics->get_box(boxes[i]);
+        float depth = body.velocity.y > 0 ? top - box.bottom : box.top - bottom;
+        if (depth > fabs(distance_moved) + COLLISION_SKIN && body.velocity.x != 0)
+        {
+            float sideways = body.velocity.x > 0 ? right - box.left : box.right - left;
+            if (sideways < depth) continue; // check_collision_x will get it out
         }
+        push = std::max(push, depth);
     }
+    if (push == 0.0f) return;
 
-    // Updating the animation only if the entity is moving
-    if (glm::length(m_movement) != 0) {
-        m_animation_time += delta_time;
-        float frames_per_second = (float) 1 / SECONDS_PER_FRAME;
-        
-        if (m_animation_time >= frames_per_second) {
-            m_animation_time = 0.0f;
-            m_animation_index++;
-
-            if (m_animation_index >= m_animation_frames) {
-                m_animation_index = 0;
-            }
-        }
+    if (body.velocity.y > 0)
+    {
+        body.position.y -= push;
+        body.collided_top = true;
+    }
+    else
+    {
+        body.position.y += push;
+        body.collided_bottom = true;
     }
+    body.velocity.y = 0;
+}
 
-    m_velocity.x = m_movement.x * m_speed;
-    m_velocity += m_acceleration * delta_time;
+static void collide_x(EntityBody &body, const StaticColliders *statics)
+{
+    if (body.velocity.x == 0) return;
 
-    m_position.y += m_velocity.y * delta_time;
-    check_collision_y(collidable_entities, collidable_entity_count);
-    check_collision_y(map);
+    float left   = body.position.x - (body.width / 2),  right = body.position.x + (body.width / 2),
+          bottom = body.position.y - (body.height / 2), top   = body.position.y + (body.height / 2);
 
-    m_position.x += m_velocity.x * delta_time;
-    check_collision_x(collidable_entities, collidable_entity_count);
-    check_collision_x(map);
+    int boxes[MAX_STATIC_CONTACTS];
+    int count = statics->query(left, bottom + COLLISION_SKIN, right, top - COLLISION_SKIN, boxes, MAX_STATIC_CONTACTS);
+    if (count == 0) return;
 
-    if (m_is_jumping) {
-        m_is_jumping = false;
-        m_velocity.y += m_jumping_power;
+    float push = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        const StaticBox &box = statics->get_box(boxes[i]);
+        push = body.velocity.x > 0 ? std::max(push, right - box.left) : std::max(push, box.right - left);
     }
 
-    m_model_matrix = glm::mat4(1.0f);
-    m_model_matrix = glm::translate(m_model_matrix, m_position);
+    if (body.velocity.x > 0)
+    {
+        body.position.x -= push;
+        body.collided_right = true;
+    }
+    else
+    {
+        body.position.x += push;
+        body.collided_left = true;
+    }
+    body.velocity.x = 0;
 }
 
+void const Entity::check_collision_y(Map *map) { collide_y(m_body, map); }
+void const Entity::check_collision_x(Map *map) { collide_x(m_body, map); }
 
-void Entity::render(ShaderProgram* program) {
-    // Render the main entity
-    m_model_matrix = glm::mat4(1.0f);
-    m_model_matrix = glm::translate(m_model_matrix, m_position);
-    m_model_matrix = glm::scale(m_model_matrix, glm::vec3(m_visual_scale, m_visual_scale, 1.0f));
-    program->set_model_matrix(m_model_matrix);
-
-    if (m_animation_indices != NULL) {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
-    } else {
-        float vertices[] = {
-            -0.5, -0.5, 0.5, -0.5, 0.5, 0.5,
-            -0.5, -0.5, 0.5, 0.5, -0.5, 0.5
-        };
-        float tex_coords[] = {
-            0.0, 1.0, 1.0, 1.0, 1.0, 0.0,
-            0.0, 1.0, 1.0, 0.0, 0.0, 0.0
-        };
-
-        glBindTexture(GL_TEXTURE_2D, m_texture_id);
-
-        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program->get_position_attribute());
-        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-        glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        glDisableVertexAttribArray(program->get_position_attribute());
-        glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
-    }
+void const Entity::check_collision_y(const StaticColliders *statics, float distance_moved)
+{
+    collide_y(m_body, statics, distance_moved);
+}
+void const Entity::check_collision_x(const StaticColliders *statics) { collide_x(m_body, statics); }
+
+// The velocity a step starts from: walking speed along x, and gravity
+static inline void begin_step(EntityBody &body, float delta_time)
+{
+    body.clear_collisions();
+    integrate_velocity(body.velocity.x, body.velocity.y, body.movement.x, body.speed,
+                       body.acceleration.x, body.acceleration.y, delta_time);
+}
 
-    // Render the projectile if active
-    if (m_projectile_active) {
-        glm::mat4 projectile_matrix = glm::mat4(1.0f);
-        projectile_matrix = glm::translate(projectile_matrix, m_projectile_position);
-        program->set_model_matrix(projectile_matrix);
+static inline void end_step(EntityBody &body)
+{
+    if (body.is_jumping) {
+        body.is_jumping = false;
+        body.velocity.y += body.jumping_power;
+    }
+}
 
-        float projectile_vertices[] = {
-            -0.2f, -0.2f, 0.2f, -0.2f, 0.2f, 0.2f,
-            -0.2f, -0.2f, 0.2f, 0.2f, -0.2f, 0.2f
-        };
+void update_bodies(EntityBody *bodies, int count, float delta_time, Map *map, const StaticColliders *statics,
+                   KinematicBatch *batch)
+{
+    // Nothing a collision does feeds back into this step's velocity along x, so where each
+    // body moves to along both axes can be worked out for all of them up front; each then
+    // resolves y from its new y and old x, as before, and x after that
+    if (batch)
+    {
+        batch->load(bodies, count);
+        batch->integrate(delta_time);
+    }
 
-        float projectile_tex_coords[] = {
-            0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f,
-            0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f
-        };
+    for (int i = 0; i < count; i++)
+    {
+        EntityBody &body = bodies[i];
+        if (!body.is_active) continue;
 
-        glBindTexture(GL_TEXTURE_2D, m_projectile_texture_id);
+        float next_x;
+        if (batch)
+        {
+            body.clear_collisions();
+            body.velocity.x = batch->get_velocity_x(i);
+            body.velocity.y = batch->get_velocity_y(i);
+            body.position.y = batch->get_y(i);
+            next_x          = batch->get_x(i);
+        }
+        else
+        {
+            begin_step(body, delta_time);
+            body.position.y = integrate_position(body.position.y, body.velocity.y, delta_time);
+        }
 
-        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, projectile_vertices);
-        glEnableVertexAttribArray(program->get_position_attribute());
-        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, projectile_tex_coords);
-        glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+        if (statics) collide_y(body, statics, body.velocity.y * delta_time);
+        else         collide_y(body, map);
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        body.position.x = batch ? next_x : integrate_position(body.position.x, body.velocity.x, delta_time);
+        if (statics) collide_x(body, statics);
+        else         collide_x(body, map);
 
-        glDisableVertexAttribArray(program->get_position_attribute());
-        glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+        end_step(body);
     }
 }
 
+void Entity::update(float delta_time, Entity *collidable_entities, int collidable_entity_count, Map *map,
+                    const StaticColliders *statics)
+{
+    if (!m_body.is_active) return;
+    resolve(integrate(delta_time), delta_time, collidable_entities, collidable_entity_count, map, statics);
+}
+
+glm::vec2 Entity::integrate(float delta_time)
+{
+    if (!m_body.is_active) return glm::vec2(m_body.position);
+
+    m_animation.step(m_body, delta_time);
+    begin_step(m_body, delta_time);
+
+    return glm::vec2(integrate_position(m_body.position.x, m_body.velocity.x, delta_time),
+                     integrate_position(m_body.position.y, m_body.velocity.y, delta_time));
+}
+
+// Nothing that happens along y changes the velocity along x, so where x ends up before
+// its collisions is already known
+void Entity::resolve(glm::vec2 next_position, float delta_time, Entity *collidable_entities, int collidable_entity_count,
+                     Map *map, const StaticColliders *statics)
+{
+    if (!m_body.is_active) return;
+
+    m_body.position.y = next_position.y;
+    check_collision_y(collidable_entities, collidable_entity_count);
+    if (statics) collide_y(m_body, statics, m_body.velocity.y * delta_time);
+    else         collide_y(m_body, map);
+
+    m_body.position.x = next_position.x;
+    check_collision_x(collidable_entities, collidable_entity_count);
+    if (statics) collide_x(m_body, statics);
+    else         collide_x(m_body, map);
+
+    end_step(m_body);
+}
+
+
+// Shared by Entity::render and render_system() (Archetypes.h)
+void draw_sprite(ShaderProgram *program, glm::vec3 position, const SpriteComponent &sprite, glm::vec4 uv_rect)
+{
+    // The matrix is only ever needed here, so it isn't kept
+    glm::mat4 model_matrix = glm::mat4(1.0f);
+    model_matrix = glm::translate(model_matrix, position);
+    model_matrix = glm::scale(model_matrix, glm::vec3(sprite.visual_scale, sprite.visual_scale, 1.0f));
+    program->set_model_matrix(model_matrix);
+
+    // The frame's top edge is at uv.y, as in draw_sprite_from_texture_atlas
+    float u = uv_rect.x, v = uv_rect.y, width = uv_rect.z, height = uv_rect.w;
+    float tex_coords[] =
+    {
+        u, v + height, u + width, v + height, u + width, v,
+        u, v + height, u + width, v,          u,         v
+    };
+    float vertices[] =
+    {
+        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
+        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
+    };
+
+    glBindTexture(GL_TEXTURE_2D, sprite.texture);
+
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+}
+
+// The animated frame, or the whole texture for a static sprite
+void Entity::render(ShaderProgram* program) {
+    draw_sprite(program, m_body.position, m_sprite, m_animation.get_uv_rect());
+}
+
+void Entity::snapshot(RenderSnapshot *snapshot) const
+{
+    snapshot->add_sprite(m_body.position, m_sprite.texture, m_sprite.visual_scale, m_animation.get_uv_rect());
+}
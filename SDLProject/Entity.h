@@ -11,59 +11,131 @@ enum AIState { WALKING, IDLE, ATTACKING, JUMPING, PATROLLING, SHOOTING };
 
 enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
 
-class Entity
+template <AIType TYPE> struct AIBehaviour;
+class StaticColliders;
+class SpriteMask;
+class KinematicBatch;
+struct RenderSnapshot;
+
+// ————— HOT BODY ————— //
+// Everything the integrator and collision passes of Entity::update read and write, and
+// nothing else, in one 64-byte cache line. An Entity keeps its body first; update_bodies()
+// runs the same passes over bodies packed on their own. Acceleration is only ever in the
+// xy plane, so it is stored as a vec2 to leave room for the flags. Over-aligned, so the
+// project builds as C++17, where new and std::allocator honour the alignment.
+struct alignas(64) EntityBody
 {
-private:
-    bool m_projectile_active;
-    bool m_is_active = true;
-    glm::vec3 m_projectile_position;
-    float m_projectile_speed = 5.0f;
-    GLuint m_projectile_texture_id;
-    
-    int m_walking[4][4]; // 4x4 array for walking animations
+    glm::vec3 position, velocity, movement;
+    glm::vec2 acceleration;
+    float     speed, jumping_power;
+    float     width, height;
 
-    
-    EntityType m_entity_type;
-    AIType     m_ai_type;
-    AIState    m_ai_state;
-    // ————— TRANSFORMATIONS ————— //
-    glm::vec3 m_movement;
-    glm::vec3 m_position;
-    glm::vec3 m_scale;
-    glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
+    bool is_active       : 1;
+    bool is_jumping      : 1; // a jump is wanted and is applied at the end of the step
+    bool collided_top    : 1;
+    bool collided_bottom : 1;
+    bool collided_left   : 1;
+    bool collided_right  : 1;
 
-    glm::mat4 m_model_matrix;
+    EntityBody() : position(0.0f), velocity(0.0f), movement(0.0f), acceleration(0.0f), speed(0.0f),
+        jumping_power(0.0f), width(1.0f), height(1.0f), is_active(true), is_jumping(false),
+        collided_top(false), collided_bottom(false), collided_left(false), collided_right(false) { }
 
-    float     m_speed,
-              m_jumping_power;
-    
-    bool m_is_jumping;
+    void clear_collisions() { collided_top = collided_bottom = collided_left = collided_right = false; }
+};
+static_assert(sizeof(EntityBody) == 64, "EntityBody must fill exactly one cache line");
 
-    // ————— TEXTURES ————— //
-    GLuint    m_texture_id;
+// Moves count bodies by one step and resolves them against the map (or statics, when
+// given), exactly as Entity::update does. Inactive bodies are skipped. Collisions with
+// other entities, and animation, are the owner's business. With a batch, every body is
+// integrated in it lanes at a time before any is resolved (Kinematics.h); the result is
+// the same either way.
+void update_bodies(EntityBody *bodies, int count, float delta_time, Map *map, const StaticColliders *statics = nullptr,
+                   KinematicBatch *batch = nullptr);
+
+// ————— COMPONENTS ————— //
+// The rest of an object's state, in the pieces different kinds of object need. An Entity
+// carries all of them; a ComponentStore (Archetypes.h) keeps each kind of object with only
+// the ones it uses.
+
+// Sprite-sheet animation. The first three fields are stepped every tick while moving.
+struct AnimationComponent
+{
+    float time   = 0.0f;
+    int   frames = 0,
+          index  = 0;
+
+    // Row of walking currently being played, or -1 for a static texture. Stored as an
+    // index rather than a pointer into walking so that copies stay self-contained
+    int direction = -1;
+    int cols = 0,
+        rows = 0;
+    int walking[4][4] = {}; // sheet frame of each step of each direction
+
+    // Advances the frame if the owner is trying to move
+    void step(const EntityBody &body, float delta_time);
+
+    int       get_frame()   const; // frame of the sheet being shown
+    glm::vec4 get_uv_rect() const; // (u, v, width, height) of that frame; the whole texture when not animated
+};
+
+// An enemy's behaviour and what it remembers between ticks
+struct AIComponent
+{
+    static constexpr int NAV_GRAPH_UNKNOWN = -1,
+                         NAV_GRAPH_NONE    = -2;
+
+    AIType  type  = WALKER;
+    AIState state = IDLE;
 
-    // ————— ANIMATION ————— //
-    int m_animation_cols;
-    int m_animation_frames,
-        m_animation_index,
-        m_animation_rows;
+    // Which NavLevel graph fits this enemy's jump, once AI has looked it up
+    int nav_graph = NAV_GRAPH_UNKNOWN;
 
-    int* m_animation_indices = nullptr;
-    float m_animation_time = 0.0f;
+    // A shooter fires into its world's ProjectilePool and holds fire while its shot is in flight
+    bool projectile_active = false;
+    int  projectile_sprite = 0; // which of the pool's sprites it fires
+};
+
+// How an object is drawn
+struct SpriteComponent
+{
+    GLuint            texture      = 0;
+    float             visual_scale = 1.0f;
+    const SpriteMask *mask         = nullptr; // opaque texels of each frame of the texture
+};
+
+// Draws the uv_rect (u, v, width, height) of sprite's texture as a unit quad at position
+void draw_sprite(ShaderProgram *program, glm::vec3 position, const SpriteComponent &sprite, glm::vec4 uv_rect);
+
+class Entity
+{
+private:
+    friend class EntityPool;
+
+    // ————— HOT ————— //
+    // Read and written every tick by every entity: see EntityBody
+    EntityBody m_body;
 
-    float m_width = 1.0f,
-          m_height = 1.0f;
-    // ————— COLLISIONS ————— //
-    bool m_collided_top    = false;
-    bool m_collided_bottom = false;
-    bool m_collided_left   = false;
-    bool m_collided_right  = false;
+    // ————— WARM ————— //
+    // Its first fields are stepped every tick while the entity moves
+    AnimationComponent m_animation;
+
+    // ————— COLD ————— //
+    // Looked at by AI, rendering and set-up, but not by the movement passes
+    EntityType  m_entity_type = PLATFORM;
+    AIComponent m_ai;
+    int         m_pool_id = -1; // this entity's EntityHandle id while it lives in an EntityPool
+
+    glm::vec3 m_scale;
+
+    // ————— TEXTURES ————— //
+    SpriteComponent m_sprite;
 
 public:
     // ————— STATIC VARIABLES ————— //
     static constexpr int SECONDS_PER_FRAME = 4;
-    float m_visual_scale = 1.0f;
+    static constexpr int NAV_GRAPH_UNKNOWN = AIComponent::NAV_GRAPH_UNKNOWN,
+                         NAV_GRAPH_NONE    = AIComponent::NAV_GRAPH_NONE;
 
     // ————— METHODS ————— //
     Entity();
@@ -77,6 +149,9 @@ public:
     void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index);
     bool const check_collision(Entity* other) const;
     
+    // Pixel-accurate when both entities have sprite masks, check_collision() otherwise
+    bool const check_sprite_collision(const Entity *other) const;
+    
     void const check_collision_y(Entity* collidable_entities, int collidable_entity_count);
     void const check_collision_x(Entity* collidable_entities, int collidable_entity_count);
     
@@ -84,8 +159,25 @@ public:
     void const check_collision_y(Map *map);
     void const check_collision_x(Map *map);
     
-    void update(float delta_time, Entity *player, Entity *collidable_entities, int collidable_entity_count, Map *map);
+    // And against the baked tiles and platforms, in place of both of the above;
+    // distance_moved is this tick's step along y
+    void const check_collision_y(const StaticColliders *statics, float distance_moved);
+    void const check_collision_x(const StaticColliders *statics);
+    
+    // With statics, the map is only used for projectile bounds and collisions go through
+    // the baked boxes; the collidable entities are still checked either way
+    void update(float delta_time, Entity *collidable_entities, int collidable_entity_count, Map *map,
+                const StaticColliders *statics = nullptr);
+
+    // update() in its two halves, for a tick that runs each half over every entity before
+    // starting the next: integrate() steps the animation and velocity and returns where the
+    // entity is headed; resolve() moves it there against the collidables, map or statics.
+    // Neither reads any other entity's body, and only resolve() reads the collidables.
+    glm::vec2 integrate(float delta_time);
+    void resolve(glm::vec2 next_position, float delta_time, Entity *collidable_entities, int collidable_entity_count,
+                 Map *map, const StaticColliders *statics = nullptr);
     void render(ShaderProgram* program);
+    void snapshot(RenderSnapshot *snapshot) const; // what render() would draw, for the render thread
 
     void ai_activate(Entity *player);
     void ai_walk();
@@ -94,74 +186,90 @@ public:
     void ai_patrol();
     void ai_shoot(Entity *player);
     
-    void normalise_movement() { m_movement = glm::normalize(m_movement); }
+    void normalise_movement() { m_body.movement = glm::normalize(m_body.movement); }
 
-    void face_left() { m_animation_indices = m_walking[LEFT]; }
-    void face_right() { m_animation_indices = m_walking[RIGHT]; }
-    void face_up() { m_animation_indices = m_walking[UP]; }
-    void face_down() { m_animation_indices = m_walking[DOWN]; }
+    void face_left() { m_animation.direction = LEFT; }
+    void face_right() { m_animation.direction = RIGHT; }
+    void face_up() { m_animation.direction = UP; }
+    void face_down() { m_animation.direction = DOWN; }
 
-    void move_left() { m_movement.x = -1.0f; face_left(); }
-    void move_right() { m_movement.x = 1.0f;  face_right(); }
-    void move_up() { m_movement.y = 1.0f;  face_up(); }
-    void move_down() { m_movement.y = -1.0f; face_down(); }
+    void move_left() { m_body.movement.x = -1.0f; face_left(); }
+    void move_right() { m_body.movement.x = 1.0f;  face_right(); }
+    void move_up() { m_body.movement.y = 1.0f;  face_up(); }
+    void move_down() { m_body.movement.y = -1.0f; face_down(); }
     
-    void const jump() { m_is_jumping = true; }
+    void const jump() { m_body.is_jumping = true; }
     
 
     // ————— GETTERS ————— //
     EntityType const get_entity_type()    const { return m_entity_type;   };
-    AIType     const get_ai_type()        const { return m_ai_type;       };
-    AIState    const get_ai_state()       const { return m_ai_state;      };
-    glm::vec3 const get_position()     const { return m_position; }
-    glm::vec3 const get_velocity()     const { return m_velocity; }
-    glm::vec3 const get_acceleration() const { return m_acceleration; }
-    glm::vec3 const get_movement()     const { return m_movement; }
+    AIType     const get_ai_type()        const { return m_ai.type;       };
+    AIState    const get_ai_state()       const { return m_ai.state;      };
+    glm::vec3 const get_position()     const { return m_body.position; }
+    glm::vec3 const get_velocity()     const { return m_body.velocity; }
+    glm::vec3 const get_acceleration() const { return glm::vec3(m_body.acceleration, 0.0f); }
+    glm::vec3 const get_movement()     const { return m_body.movement; }
     glm::vec3 const get_scale()        const { return m_scale; }
-    GLuint    const get_texture_id()   const { return m_texture_id; }
-    float     const get_speed()        const { return m_speed; }
-    bool      const get_collided_top() const { return m_collided_top; }
-    bool      const get_collided_bottom() const { return m_collided_bottom; }
-    bool      const get_collided_right() const { return m_collided_right; }
-    bool      const get_collided_left() const { return m_collided_left; }
-    bool is_active() const { return m_is_active; }
-    void activate()   { m_is_active = true;  };
-    void deactivate() { m_is_active = false; };
-    float const get_height() const { return m_height; }
-    bool is_projectile_active() const { return m_projectile_active; }
-    glm::vec3 const get_projectile_position() const { return m_projectile_position; }
-    float const get_width() const { return m_width; }
+    GLuint    const get_texture_id()   const { return m_sprite.texture; }
+    float     const get_speed()        const { return m_body.speed; }
+    float     const get_jumping_power() const { return m_body.jumping_power; }
+    bool      const get_collided_top() const { return m_body.collided_top; }
+    bool      const get_collided_bottom() const { return m_body.collided_bottom; }
+    bool      const get_collided_right() const { return m_body.collided_right; }
+    bool      const get_collided_left() const { return m_body.collided_left; }
+    bool is_active() const { return m_body.is_active; }
+    EntityBody               &get_body()            { return m_body;      }
+    const EntityBody         &get_body()      const { return m_body;      }
+    AnimationComponent       &get_animation()       { return m_animation; }
+    const AnimationComponent &get_animation() const { return m_animation; }
+    AIComponent              &get_ai()              { return m_ai;        }
+    const AIComponent        &get_ai()        const { return m_ai;        }
+    SpriteComponent          &get_sprite()          { return m_sprite;    }
+    const SpriteComponent    &get_sprite()    const { return m_sprite;    }
+    int  get_pool_id() const { return m_pool_id; }
+    void activate()   { m_body.is_active = true;  };
+    void deactivate() { m_body.is_active = false; };
+    float const get_height() const { return m_body.height; }
+    bool is_projectile_active() const { return m_ai.projectile_active; }
+    int       const get_projectile_sprite() const { return m_ai.projectile_sprite; }
+    glm::vec4 const get_sprite_uv_rect() const;
+    int       const get_sprite_frame()   const; // frame of the sheet being shown
+    const SpriteMask *get_sprite_mask() const { return m_sprite.mask; }
+    float const get_visual_scale() const { return m_sprite.visual_scale; }
+    float const get_width() const { return m_body.width; }
 
     // ————— SETTERS ————— //
     void const set_entity_type(EntityType new_entity_type)  { m_entity_type = new_entity_type;};
-    void const set_ai_type(AIType new_ai_type){ m_ai_type = new_ai_type;};
-    void const set_ai_state(AIState new_state){ m_ai_state = new_state;};
-    void const set_position(glm::vec3 new_position) { m_position = new_position; }
-    void const set_velocity(glm::vec3 new_velocity) { m_velocity = new_velocity; }
-    void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration; }
-    void const set_movement(glm::vec3 new_movement) { m_movement = new_movement; }
+    void const set_ai_type(AIType new_ai_type){ m_ai.type = new_ai_type;};
+    void const set_ai_state(AIState new_state){ m_ai.state = new_state;};
+    void const set_position(glm::vec3 new_position) { m_body.position = new_position; }
+    void const set_velocity(glm::vec3 new_velocity) { m_body.velocity = new_velocity; }
+    void const set_acceleration(glm::vec3 new_acceleration) { m_body.acceleration = glm::vec2(new_acceleration); }
+    void const set_movement(glm::vec3 new_movement) { m_body.movement = new_movement; }
     void const set_scale(glm::vec3 new_scale) { m_scale = new_scale; }
-    void const set_texture_id(GLuint new_texture_id) { m_texture_id = new_texture_id; }
-    void const set_speed(float new_speed) { m_speed = new_speed; }
-    void const set_animation_cols(int new_cols) { m_animation_cols = new_cols; }
-    void const set_animation_rows(int new_rows) { m_animation_rows = new_rows; }
-    void const set_animation_frames(int new_frames) { m_animation_frames = new_frames; }
-    void const set_animation_index(int new_index) { m_animation_index = new_index; }
-    void const set_animation_time(float new_time) { m_animation_time = new_time; }
-    void const set_jumping_power(float new_jumping_power) { m_jumping_power = new_jumping_power;}
-    void const set_width(float new_width) {m_width = new_width; }
-    void const set_height(float new_height) {m_height = new_height; }
-    void set_projectile_texture(GLuint texture_id) { m_projectile_texture_id = texture_id; }
-    void set_projectile_active(bool active) { m_projectile_active = active; }
-
-    // Setter for m_walking
+    void const set_texture_id(GLuint new_texture_id) { m_sprite.texture = new_texture_id; }
+    void const set_speed(float new_speed) { m_body.speed = new_speed; }
+    void const set_animation_cols(int new_cols) { m_animation.cols = new_cols; }
+    void const set_animation_rows(int new_rows) { m_animation.rows = new_rows; }
+    void const set_animation_frames(int new_frames) { m_animation.frames = new_frames; }
+    void const set_animation_index(int new_index) { m_animation.index = new_index; }
+    void const set_animation_time(float new_time) { m_animation.time = new_time; }
+    void const set_jumping_power(float new_jumping_power) { m_body.jumping_power = new_jumping_power;}
+    void const set_width(float new_width) {m_body.width = new_width; }
+    void const set_height(float new_height) {m_body.height = new_height; }
+    void set_projectile_sprite(int sprite) { m_ai.projectile_sprite = sprite; }
+    void set_projectile_active(bool active) { m_ai.projectile_active = active; }
+    void set_sprite_mask(const SpriteMask *mask) { m_sprite.mask = mask; }
+    void set_visual_scale(float scale) { m_sprite.visual_scale = scale; }
+
+    // Setter for the walking table
     void set_walking(int walking[4][4])
     {
         for (int i = 0; i < 4; ++i)
         {
             for (int j = 0; j < 4; ++j)
             {
-                m_walking[i][j] = walking[i][j];
+                m_animation.walking[i][j] = walking[i][j];
             }
         }
     }
@@ -0,0 +1,117 @@
+#include "EntityPool.h"
+
+constexpr int EntityHandle::SLOT_BITS;
+constexpr int EntityPool::MAX_CAPACITY;
+
+EntityPool::EntityPool(int capacity, int group_count) : m_capacity(capacity), m_group_count(group_count),
+    m_entities(capacity), m_slots(capacity), m_indices(capacity, -1), m_generations(capacity, 0),
+    m_group_begin(group_count + 1, 0)
+{
+    // Handed out lowest slot first
+    m_free_slots.reserve(capacity);
+    for (int slot = capacity - 1; slot >= 0; slot--) m_free_slots.push_back(slot);
+}
+
+void EntityPool::move(int from, int to)
+{
+    m_entities[to]          = m_entities[from];
+    m_slots[to]             = m_slots[from];
+    m_indices[m_slots[to]]  = to;
+}
+
+int EntityPool::get_group_of(int index) const
+{
+    int group = 0;
+    while (index >= m_group_begin[group + 1]) group++;
+    return group;
+}
+
+EntityHandle EntityPool::spawn(const Entity &entity, int group)
+{
+    if (m_count == m_capacity) return EntityHandle();
+
+    // Every later group shifts one place right by moving its first entity past its last,
+    // which leaves a hole at the end of group
+    int hole = m_count;
+    for (int later = m_group_count - 1; later > group; later--)
+    {
+        if (m_group_begin[later] != hole) move(m_group_begin[later], hole);
+        hole = m_group_begin[later]++;
+    }
+    m_group_begin[m_group_count] = ++m_count;
+
+    int slot = m_free_slots.back();
+    m_free_slots.pop_back();
+
+    EntityHandle handle;
+    handle.slot       = slot;
+    handle.generation = m_generations[slot];
+
+    m_entities[hole]            = entity;
+    m_entities[hole].m_pool_id  = handle.get_id();
+    m_slots[hole]               = slot;
+    m_indices[slot]             = hole;
+    return handle;
+}
+
+void EntityPool::despawn_at(int index)
+{
+    int slot = m_slots[index];
+    m_indices[slot] = -1;
+    m_generations[slot]++;
+    m_free_slots.push_back(slot);
+
+    // The last entity of each group from this one on moves back into the hole before it
+    int hole = index;
+    for (int group = get_group_of(index); group < m_group_count; group++)
+    {
+        int last = --m_group_begin[group + 1];
+        if (last != hole) move(last, hole);
+        hole = last;
+    }
+    m_count--;
+}
+
+bool EntityPool::despawn(EntityHandle handle)
+{
+    if (get(handle) == nullptr) return false;
+    despawn_at(m_indices[handle.slot]);
+    return true;
+}
+
+void EntityPool::clear()
+{
+    for (int index = 0; index < m_count; index++)
+    {
+        int slot = m_slots[index];
+        m_indices[slot] = -1;
+        m_generations[slot]++;
+    }
+
+    m_free_slots.clear();
+    for (int slot = m_capacity - 1; slot >= 0; slot--) m_free_slots.push_back(slot);
+
+    m_count = 0;
+    for (int &begin : m_group_begin) begin = 0;
+}
+
+// Ids carry only the generation's low bits, so compare just those
+Entity *EntityPool::get(EntityHandle handle)
+{
+    if (handle.slot < 0 || handle.slot >= m_capacity || m_indices[handle.slot] < 0) return nullptr;
+    if (((m_generations[handle.slot] ^ handle.generation) & 0x7FFu) != 0) return nullptr;
+    return &m_entities[m_indices[handle.slot]];
+}
+
+const Entity *EntityPool::get(EntityHandle handle) const
+{
+    return const_cast<EntityPool *>(this)->get(handle);
+}
+
+EntityHandle EntityPool::get_handle(int index) const
+{
+    EntityHandle handle;
+    handle.slot       = m_slots[index];
+    handle.generation = m_generations[handle.slot];
+    return handle;
+}
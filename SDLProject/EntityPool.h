@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include "Entity.h"
+
+// ————— HANDLES ————— //
+// A reference to a pooled entity that survives it being moved around the pool: the slot
+// it was given when spawned, and that slot's generation at the time. Despawning moves
+// the slot's generation on, so every handle to the old entity stops resolving, even
+// after the slot is reused.
+struct EntityHandle
+{
+    static constexpr int SLOT_BITS = 20; // slots in the low bits of an id, generation above
+
+    int          slot       = -1;
+    unsigned int generation = 0;
+
+    // The handle in one non-negative int, for records that only hold an int (such as a
+    // shot's owner); -1 for no entity. Generations are kept modulo 2^11 there.
+    int get_id() const
+    {
+        return slot < 0 ? -1 : (int) (((generation & 0x7FFu) << SLOT_BITS) | (unsigned int) slot);
+    }
+    static EntityHandle from_id(int id)
+    {
+        EntityHandle handle;
+        if (id < 0) return handle;
+        handle.slot       = id & ((1 << SLOT_BITS) - 1);
+        handle.generation = (unsigned int) id >> SLOT_BITS;
+        return handle;
+    }
+
+    bool is_valid() const { return slot >= 0; }
+};
+
+// ————— ENTITY POOL ————— //
+// Up to capacity live entities, packed at the front of one array so that loops over them
+// need no is_active() test. Entities are optionally kept in groups (e.g. by AI type), each
+// one contiguous run: group g is [get_group_begin(g), get_group_end(g)).
+//
+// Despawning fills the hole with the last entity of its group, and the hole this leaves
+// with the last entity of the next group, and so on: at most one move per group, however
+// many entities there are. Spawning does the same in reverse. Order within a group is
+// therefore not kept. Every array is sized up front, so neither ever allocates.
+//
+// Indices change as entities come and go; hold on to an EntityHandle instead. A pooled
+// entity knows its own handle, as get_pool_id().
+class EntityPool
+{
+public:
+    static constexpr int MAX_CAPACITY = 1 << EntityHandle::SLOT_BITS;
+
+private:
+    int m_capacity;
+    int m_group_count;
+    int m_count = 0;
+
+    std::vector<Entity>       m_entities;    // live ones in [0, m_count)
+    std::vector<int>          m_slots;       // slot of each live entity, by index
+    std::vector<int>          m_indices;     // index of each slot's entity, or -1 if the slot is free
+    std::vector<unsigned int> m_generations; // of each slot
+    std::vector<int>          m_free_slots;  // a stack
+    std::vector<int>          m_group_begin; // m_group_count + 1 entries; the last is m_count
+
+    void move(int from, int to);
+    int  get_group_of(int index) const;
+
+public:
+    EntityPool(int capacity, int group_count = 1);
+
+    // Copies entity into the pool at the end of group. Returns an invalid handle if the
+    // pool is full.
+    EntityHandle spawn(const Entity &entity, int group = 0);
+
+    // Removes the entity at index / behind handle. Returns false if handle is stale.
+    void despawn_at(int index);
+    bool despawn(EntityHandle handle);
+
+    // Despawns everything; every handle given out so far goes stale
+    void clear();
+
+    // The entity behind handle, or nullptr if it has been despawned
+    Entity       *get(EntityHandle handle);
+    const Entity *get(EntityHandle handle) const;
+
+    EntityHandle get_handle(int index) const;
+
+    Entity       &operator[](int index)       { return m_entities[index]; }
+    const Entity &operator[](int index) const { return m_entities[index]; }
+
+    Entity       *data()        { return m_entities.data(); }
+    const Entity *data()  const { return m_entities.data(); }
+    Entity       *begin()       { return m_entities.data(); }
+    Entity       *end()         { return m_entities.data() + m_count; }
+    const Entity *begin() const { return m_entities.data(); }
+    const Entity *end()   const { return m_entities.data() + m_count; }
+
+    int const get_count()                 const { return m_count;    }
+    int const get_capacity()              const { return m_capacity; }
+    int const get_group_count()           const { return m_group_count; }
+    int const get_group_begin(int group)  const { return m_group_begin[group];     }
+    int const get_group_end(int group)    const { return m_group_begin[group + 1]; }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// ————— FOUR LANES AT A TIME ————— //
+// Just the handful of operations the SoA pools need. greater4() gives bit i set where
+// lane i of a is greater than lane i of b, so lane tests combine with plain integer ops.
+// FLOAT4_LANES is left undefined where neither SSE2 nor NEON is available, and callers
+// keep a scalar loop for that case and for the tail of every array.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FLOAT4_LANES 4
+typedef __m128 float4;
+static inline float4 load4(const float *p)          { return _mm_loadu_ps(p); }
+static inline void   store4(float *p, float4 v)     { _mm_storeu_ps(p, v); }
+static inline float4 splat4(float f)                { return _mm_set1_ps(f); }
+static inline float4 add4(float4 a, float4 b)       { return _mm_add_ps(a, b); }
+static inline float4 sub4(float4 a, float4 b)       { return _mm_sub_ps(a, b); }
+static inline float4 mul4(float4 a, float4 b)       { return _mm_mul_ps(a, b); }
+static inline int    greater4(float4 a, float4 b)   { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLOAT4_LANES 4
+typedef float32x4_t float4;
+static inline float4 load4(const float *p)          { return vld1q_f32(p); }
+static inline void   store4(float *p, float4 v)     { vst1q_f32(p, v); }
+static inline float4 splat4(float f)                { return vdupq_n_f32(f); }
+static inline float4 add4(float4 a, float4 b)       { return vaddq_f32(a, b); }
+static inline float4 sub4(float4 a, float4 b)       { return vsubq_f32(a, b); }
+static inline float4 mul4(float4 a, float4 b)       { return vmulq_f32(a, b); }
+static inline int    greater4(float4 a, float4 b)
+{
+    uint32x4_t mask = vcgtq_f32(a, b);
+    return (vgetq_lane_u32(mask, 0) & 1) | (vgetq_lane_u32(mask, 1) & 2) |
+           (vgetq_lane_u32(mask, 2) & 4) | (vgetq_lane_u32(mask, 3) & 8);
+}
+#endif
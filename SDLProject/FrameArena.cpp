@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include "FrameArena.h"
+
+constexpr size_t FrameArena::DEFAULT_CAPACITY;
+
+FrameArena::FrameArena(size_t capacity) : m_capacity(capacity)
+{
+    m_block = static_cast<char *>(::operator new(m_capacity));
+}
+
+FrameArena::~FrameArena()
+{
+    free_overflow();
+    ::operator delete(m_block);
+}
+
+void FrameArena::free_overflow()
+{
+    while (m_overflow != nullptr)
+    {
+        Overflow *next = m_overflow->next;
+        ::operator delete(m_overflow);
+        m_overflow = next;
+    }
+}
+
+// Past the end of the block: a heap block of its own, with the link in front
+void *FrameArena::allocate_overflow(size_t size, size_t alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    size_t header = std::max(sizeof(Overflow), alignment);
+    char  *memory = static_cast<char *>(::operator new(header + size + alignment));
+
+    Overflow *overflow = reinterpret_cast<Overflow *>(memory);
+    overflow->next = m_overflow;
+    m_overflow     = overflow;
+    m_overflow_bytes += size + alignment;
+
+    uintptr_t start = ((uintptr_t) memory + header + alignment - 1) & ~(uintptr_t) (alignment - 1);
+    return (void *) start;
+}
+
+void FrameArena::reset()
+{
+    size_t used = get_used();
+    m_peak = std::max(m_peak, used);
+
+    free_overflow();
+
+    // Room for all of this frame in the block next time, and a little to spare
+    if (m_overflow_bytes > 0)
+    {
+        ::operator delete(m_block);
+        m_capacity = used + used / 2;
+        m_block    = static_cast<char *>(::operator new(m_capacity));
+        m_grows++;
+    }
+
+    m_used           = 0;
+    m_overflow_bytes = 0;
+}
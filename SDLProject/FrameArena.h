@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ————— FRAME ARENA ————— //
+// Scratch memory that lives for one frame: allocate() bumps a pointer through one block,
+// nothing is freed on its own, and reset() at the end of the frame takes it all back at
+// once. One arena belongs to one thread.
+//
+// A frame that needs more than the block holds still gets its memory, from the heap, and
+// the next reset() regrows the block to fit everything that frame used, so once frames
+// settle into their usual size they never touch the heap at all.
+class FrameArena
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024; // bytes
+
+private:
+    // Heap blocks handed out past the end of the block, freed at reset()
+    struct Overflow
+    {
+        Overflow *next;
+    };
+
+    char  *m_block;
+    size_t m_capacity;
+    size_t m_used = 0;
+
+    Overflow *m_overflow       = nullptr;
+    size_t    m_overflow_bytes = 0;    // asked for this frame beyond the block
+
+    size_t m_peak  = 0;                // the most one frame has asked for
+    int    m_grows = 0;                // times reset() has had to regrow the block
+
+    void *allocate_overflow(size_t size, size_t alignment);
+    void  free_overflow();
+
+public:
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // size bytes aligned to alignment (a power of two), good until the next reset()
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        uintptr_t base    = (uintptr_t) m_block,
+                  address = (base + m_used + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        size_t    end     = (size_t) (address - base) + size;
+        if (end > m_capacity) return allocate_overflow(size, alignment);
+
+        m_used = end;
+        return (void *) address;
+    }
+
+    template <typename T>
+    T *allocate_array(size_t count) { return static_cast<T *>(allocate(count * sizeof(T), alignof(T))); }
+
+    // Takes back everything allocated since the last reset(). End of frame only.
+    void reset();
+
+    size_t const get_used()     const { return m_used + m_overflow_bytes; }
+    size_t const get_capacity() const { return m_capacity; }
+    size_t const get_peak()     const { return m_peak;     }
+    int    const get_grows()    const { return m_grows;    }
+};
+
+// A standard allocator over an arena, so that the usual containers can hold frame scratch.
+// deallocate() does nothing: a vector that grows leaves its old buffer behind until the
+// reset(), so reserve() what is needed up front where the size is known.
+template <typename T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+
+    FrameArena *arena;
+
+    explicit ArenaAllocator(FrameArena *arena) : arena(arena) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T   *allocate(size_t count)    { return arena->allocate_array<T>(count); }
+    void deallocate(T *, size_t)   {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
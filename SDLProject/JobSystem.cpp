@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cassert>
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+
+struct JobRecord
+{
+    JobSystem::Job job;
+    bool           main_thread = false;
+
+    // Dependencies not yet done, plus one held by make_job() until it has wired them all up
+    std::atomic<int>  waiting_on{1};
+    std::atomic<bool> done{false};
+
+    // Guards dependents, and finished, which says dependents can no longer be added to
+    std::mutex                              mutex;
+    std::vector<std::shared_ptr<JobRecord>> dependents;
+    bool                                    finished = false;
+};
+
+bool JobHandle::is_done() const
+{
+    return m_record == nullptr || m_record->done.load(std::memory_order_acquire);
+}
+
+// Which system, if any, this thread works for, and its index there
+static thread_local const JobSystem *t_system       = nullptr;
+static thread_local int              t_thread_index = 0;
+
+constexpr int JobSystem::MAX_SPARE_RECORDS;
+constexpr int JobSystem::LOCAL_CHUNKS;
+
+// ————— JOB RING ————— //
+void JobSystem::JobRing::push_back(std::shared_ptr<JobRecord> record)
+{
+    int capacity = (int) m_slots.size();
+    if (m_count == capacity)
+    {
+        // Unrolled into a ring twice the size, oldest first
+        std::vector<std::shared_ptr<JobRecord>> slots(std::max(16, capacity * 2));
+        for (int i = 0; i < m_count; i++) slots[i] = std::move(m_slots[(m_first + i) % capacity]);
+        m_slots.swap(slots);
+        m_first  = 0;
+        capacity = (int) m_slots.size();
+    }
+    m_slots[(m_first + m_count) % capacity] = std::move(record);
+    m_count++;
+}
+
+std::shared_ptr<JobRecord> JobSystem::JobRing::pop_back()
+{
+    m_count--;
+    return std::move(m_slots[(m_first + m_count) % (int) m_slots.size()]);
+}
+
+std::shared_ptr<JobRecord> JobSystem::JobRing::pop_front()
+{
+    std::shared_ptr<JobRecord> record = std::move(m_slots[m_first]);
+    m_first = (m_first + 1) % (int) m_slots.size();
+    m_count--;
+    return record;
+}
+
+// ————— JOB SYSTEM ————— //
+JobSystem::JobSystem(int thread_count) : m_thread_count(thread_count), m_main_thread(std::this_thread::get_id())
+{
+    if (m_thread_count <= 0) m_thread_count = (int) std::thread::hardware_concurrency();
+    if (m_thread_count <= 0) m_thread_count = 1;
+
+    m_spare_records.reserve(MAX_SPARE_RECORDS);
+
+    for (int i = 0; i < m_thread_count; i++) m_queues.emplace_back(new WorkQueue());
+    for (int i = 1; i < m_thread_count; i++) m_workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &worker : m_workers) worker.join();
+}
+
+int const JobSystem::get_thread_index() const
+{
+    return t_system == this ? t_thread_index : 0;
+}
+
+// ————— SUBMITTING ————— //
+JobHandle JobSystem::make_job(Job job, bool main_thread, std::initializer_list<JobHandle> dependencies)
+{
+    std::shared_ptr<JobRecord> record;
+    {
+        std::lock_guard<std::mutex> lock(m_spare_mutex);
+        if (!m_spare_records.empty())
+        {
+            record = std::move(m_spare_records.back());
+            m_spare_records.pop_back();
+        }
+    }
+    if (record == nullptr) record = std::make_shared<JobRecord>();
+
+    record->job         = std::move(job);
+    record->main_thread = main_thread;
+
+    for (const JobHandle &dependency : dependencies)
+    {
+        if (dependency.m_record == nullptr) continue;
+
+        std::lock_guard<std::mutex> lock(dependency.m_record->mutex);
+        if (dependency.m_record->finished) continue;
+        record->waiting_on.fetch_add(1, std::memory_order_relaxed);
+        dependency.m_record->dependents.push_back(record);
+    }
+
+    JobHandle handle;
+    handle.m_record = record;
+    release(record);
+    return handle;
+}
+
+JobHandle JobSystem::submit(Job job, std::initializer_list<JobHandle> dependencies)
+{
+    return make_job(std::move(job), false, dependencies);
+}
+
+JobHandle JobSystem::submit_main(Job job, std::initializer_list<JobHandle> dependencies)
+{
+    return make_job(std::move(job), true, dependencies);
+}
+
+void JobSystem::release(const std::shared_ptr<JobRecord> &record)
+{
+    if (record->waiting_on.fetch_sub(1, std::memory_order_acq_rel) == 1) enqueue(record);
+}
+
+// Onto the queue of the thread that made it ready, which is likely to run it soon
+void JobSystem::enqueue(const std::shared_ptr<JobRecord> &record)
+{
+    if (record->main_thread)
+    {
+        std::lock_guard<std::mutex> lock(m_main_mutex);
+        m_main_jobs.push_back(record);
+        return;
+    }
+
+    WorkQueue &queue = *m_queues[get_thread_index()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(record);
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this against a worker that has just found nothing and is about to sleep
+    { std::lock_guard<std::mutex> lock(m_sleep_mutex); }
+    m_wake.notify_one();
+}
+
+// Whoever lets go of a record last, out of the thread that ran it and a parallel_for()
+// waiting on it, keeps it; the lock makes sure one of them sees itself as last. Records
+// held by handles elsewhere are simply freed by the last of those.
+void JobSystem::recycle(std::shared_ptr<JobRecord> &record)
+{
+    std::lock_guard<std::mutex> lock(m_spare_mutex);
+    if (record.use_count() == 1 && (int) m_spare_records.size() < MAX_SPARE_RECORDS)
+    {
+        record->waiting_on.store(1, std::memory_order_relaxed);
+        record->done.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> record_lock(record->mutex);
+            record->finished = false;
+            record->dependents.clear();
+        }
+        m_spare_records.push_back(std::move(record));
+    }
+    record = nullptr;
+}
+
+// ————— RUNNING ————— //
+void JobSystem::execute(const std::shared_ptr<JobRecord> &record)
+{
+    record->job();
+    record->job = nullptr; // let go of whatever it captured
+
+    std::vector<std::shared_ptr<JobRecord>> dependents;
+    {
+        std::lock_guard<std::mutex> lock(record->mutex);
+        record->finished = true;
+        dependents.swap(record->dependents);
+    }
+    record->done.store(true, std::memory_order_release);
+
+    for (const std::shared_ptr<JobRecord> &dependent : dependents) release(dependent);
+}
+
+bool JobSystem::run_one(int thread_index)
+{
+    std::shared_ptr<JobRecord> record;
+
+    // Newest of our own first, then the oldest of everyone else's, starting with the next thread along
+    for (int offset = 0; offset < m_thread_count && record == nullptr; offset++)
+    {
+        WorkQueue &queue = *m_queues[(thread_index + offset) % m_thread_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+
+        record = offset == 0 ? queue.jobs.pop_back() : queue.jobs.pop_front();
+    }
+    if (record == nullptr) return false;
+
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    execute(record);
+    recycle(record);
+    return true;
+}
+
+void JobSystem::worker_loop(int thread_index)
+{
+    t_system       = this;
+    t_thread_index = thread_index;
+    AllocationScope scope(TAG_JOBS);
+
+    while (true)
+    {
+        if (run_one(thread_index)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+        if (m_stopping) return;
+    }
+}
+
+int JobSystem::run_main_jobs()
+{
+    assert(std::this_thread::get_id() == m_main_thread);
+
+    int ran = 0;
+    while (true)
+    {
+        std::shared_ptr<JobRecord> record;
+        {
+            std::lock_guard<std::mutex> lock(m_main_mutex);
+            if (m_main_jobs.empty()) return ran;
+            record = m_main_jobs.pop_front();
+        }
+        execute(record);
+        recycle(record);
+        ran++;
+    }
+}
+
+void JobSystem::wait(const JobHandle &handle)
+{
+    bool on_main = std::this_thread::get_id() == m_main_thread;
+    int  index   = get_thread_index();
+
+    while (!handle.is_done())
+    {
+        if (on_main && run_main_jobs() > 0) continue;
+        if (!run_one(index)) std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallel_for(int count, int grain, const std::function<void(int, int)> &body)
+{
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    int chunk_count = (count + grain - 1) / grain;
+    if (chunk_count == 1 || m_thread_count == 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    // Every chunk but the first goes to the queues; this thread takes the first itself
+    JobHandle              local_chunks[LOCAL_CHUNKS];
+    std::vector<JobHandle> more_chunks;
+    if (chunk_count - 1 > LOCAL_CHUNKS) more_chunks.resize(chunk_count - 1);
+    JobHandle *chunks = more_chunks.empty() ? local_chunks : more_chunks.data();
+
+    for (int chunk = 1; chunk < chunk_count; chunk++)
+    {
+        int begin = (int) ((long long) count * chunk / chunk_count),
+            end   = (int) ((long long) count * (chunk + 1) / chunk_count);
+        chunks[chunk - 1] = submit([&body, begin, end] { body(begin, end); });
+    }
+
+    body(0, (int) ((long long) count / chunk_count));
+    for (int chunk = 0; chunk < chunk_count - 1; chunk++)
+    {
+        wait(chunks[chunk]);
+        recycle(chunks[chunk].m_record);
+    }
+}
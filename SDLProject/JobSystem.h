@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobRecord;
+
+// A submitted job: wait for it, or name it as a dependency of later ones. A default-made
+// handle stands for a job that has already finished.
+class JobHandle
+{
+    friend class JobSystem;
+    std::shared_ptr<JobRecord> m_record;
+
+public:
+    bool is_done() const;
+};
+
+// ————— JOB SYSTEM ————— //
+// A fixed set of threads, each with its own queue of ready jobs. A thread runs its own
+// newest job first (what it just queued is likely still in cache) and, when it has none,
+// steals the oldest job of another thread, so a slow chunk of work never leaves the others
+// idle. The thread that creates the system is its main thread: it is thread 0, takes part
+// whenever it waits, and is the only one to run jobs submitted with submit_main(), which is
+// where GL calls belong.
+//
+// Jobs may depend on other jobs; a job is only queued once all of its dependencies are
+// done. Nothing here is ordered beyond that.
+//
+// The queues only grow, and parallel_for() hands the records of its chunks back for
+// reuse once they are done, so a frame that splits its work the way the last did
+// allocates nothing.
+class JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+
+private:
+    // Ready jobs, oldest first, in a ring that doubles when full and never shrinks
+    class JobRing
+    {
+        std::vector<std::shared_ptr<JobRecord>> m_slots;
+        int m_first = 0, m_count = 0;
+
+    public:
+        void push_back(std::shared_ptr<JobRecord> record);
+        std::shared_ptr<JobRecord> pop_back();
+        std::shared_ptr<JobRecord> pop_front();
+        bool empty() const { return m_count == 0; }
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        JobRing    jobs;
+    };
+
+    static constexpr int MAX_SPARE_RECORDS = 256,
+                         LOCAL_CHUNKS      = 64; // parallel_for() chunks it keeps track of without allocating
+
+    int m_thread_count;
+    std::thread::id m_main_thread;
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;     // one per thread, the main thread's first
+    std::vector<std::thread>                m_workers;
+
+    std::mutex m_main_mutex;
+    JobRing    m_main_jobs;
+
+    // Finished records nothing else holds, ready to be made into new jobs
+    std::mutex                              m_spare_mutex;
+    std::vector<std::shared_ptr<JobRecord>> m_spare_records;
+
+    // Sleeping workers wake on m_wake when m_queued goes above zero
+    std::atomic<int>        m_queued{0};
+    std::mutex              m_sleep_mutex;
+    std::condition_variable m_wake;
+    bool                    m_stopping = false;
+
+    JobHandle make_job(Job job, bool main_thread, std::initializer_list<JobHandle> dependencies);
+    void      release(const std::shared_ptr<JobRecord> &record); // one dependency fewer; queues it at none
+    void      enqueue(const std::shared_ptr<JobRecord> &record);
+    void      execute(const std::shared_ptr<JobRecord> &record);
+    void      recycle(std::shared_ptr<JobRecord> &record);       // lets go, keeping it for reuse if it was the last hold
+    bool      run_one(int thread_index);                         // false if no job was found
+    void      worker_loop(int thread_index);
+
+public:
+    // thread_count threads take part, counting the main thread; <= 0 uses every hardware thread
+    explicit JobSystem(int thread_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // Runs job on any of the threads once every one of dependencies is done
+    JobHandle submit(Job job, std::initializer_list<JobHandle> dependencies = {});
+
+    // Runs job on the main thread, from run_main_jobs() or from a wait() there, once every
+    // one of dependencies is done
+    JobHandle submit_main(Job job, std::initializer_list<JobHandle> dependencies = {});
+
+    // Runs whatever main-thread jobs are ready; returns how many. Main thread only.
+    int run_main_jobs();
+
+    // Runs other jobs on this thread until handle's job is done
+    void wait(const JobHandle &handle);
+
+    // Calls body(begin, end) over consecutive chunks of [0, count), about grain items each,
+    // on every thread (this one included), and returns once all of them have run
+    void parallel_for(int count, int grain, const std::function<void(int, int)> &body);
+
+    int const get_thread_count() const { return m_thread_count; }
+
+    // This thread's index in the system: 1 to get_thread_count() - 1 on its workers, and 0
+    // on the main thread or any thread that is not one of its own
+    int const get_thread_index() const;
+};
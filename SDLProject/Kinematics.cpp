@@ -0,0 +1,82 @@
+#include "Kinematics.h"
+#include "Entity.h"
+#include "Float4.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+void integrate_kinematics(float *x, float *y, float *velocity_x, float *velocity_y,
+                          const float *movement_x, const float *speed, const float *acceleration_x,
+                          const float *acceleration_y, int count, float delta_time, KinematicsMode mode)
+{
+    int i = 0;
+
+    if (mode == KINEMATICS_SIMD)
+    {
+#if defined(__AVX__)
+        const __m256 dt8 = _mm256_set1_ps(delta_time);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 vx = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(movement_x + i), _mm256_loadu_ps(speed + i)),
+                                      _mm256_mul_ps(_mm256_loadu_ps(acceleration_x + i), dt8));
+            __m256 vy = _mm256_add_ps(_mm256_loadu_ps(velocity_y + i),
+                                      _mm256_mul_ps(_mm256_loadu_ps(acceleration_y + i), dt8));
+            _mm256_storeu_ps(velocity_x + i, vx);
+            _mm256_storeu_ps(velocity_y + i, vy);
+            _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(vx, dt8)));
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(vy, dt8)));
+        }
+#endif
+#ifdef FLOAT4_LANES
+        const float4 dt4 = splat4(delta_time);
+        for (; i + FLOAT4_LANES <= count; i += FLOAT4_LANES)
+        {
+            float4 vx = add4(mul4(load4(movement_x + i), load4(speed + i)), mul4(load4(acceleration_x + i), dt4));
+            float4 vy = add4(load4(velocity_y + i), mul4(load4(acceleration_y + i), dt4));
+            store4(velocity_x + i, vx);
+            store4(velocity_y + i, vy);
+            store4(x + i, add4(load4(x + i), mul4(vx, dt4)));
+            store4(y + i, add4(load4(y + i), mul4(vy, dt4)));
+        }
+#endif
+    }
+
+    for (; i < count; i++)
+    {
+        integrate_velocity(velocity_x[i], velocity_y[i], movement_x[i], speed[i], acceleration_x[i], acceleration_y[i],
+                           delta_time);
+        x[i] = integrate_position(x[i], velocity_x[i], delta_time);
+        y[i] = integrate_position(y[i], velocity_y[i], delta_time);
+    }
+}
+
+void KinematicBatch::load(const EntityBody *bodies, int count)
+{
+    if ((int) m_x.size() < count)
+    {
+        for (std::vector<float> *column : { &m_x, &m_y, &m_velocity_x, &m_velocity_y,
+                                            &m_movement_x, &m_speed, &m_acceleration_x, &m_acceleration_y })
+            column->resize(count);
+    }
+    m_count = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        const EntityBody &body = bodies[i];
+        m_x[i]              = body.position.x;
+        m_y[i]              = body.position.y;
+        m_velocity_x[i]     = body.velocity.x;
+        m_velocity_y[i]     = body.velocity.y;
+        m_movement_x[i]     = body.movement.x;
+        m_speed[i]          = body.speed;
+        m_acceleration_x[i] = body.acceleration.x;
+        m_acceleration_y[i] = body.acceleration.y;
+    }
+}
+
+void KinematicBatch::integrate(float delta_time)
+{
+    integrate_kinematics(m_x.data(), m_y.data(), m_velocity_x.data(), m_velocity_y.data(), m_movement_x.data(),
+                         m_speed.data(), m_acceleration_x.data(), m_acceleration_y.data(), m_count, delta_time, m_mode);
+}
@@ -7,58 +7,61 @@
 * NYU School of Engineering Policies and Procedures on
 * Academic Misconduct.
 **/
+#include <algorithm>
 #include "Map.h"
+#include "JobSystem.h"
 
-Map::Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y) : m_width(width), m_height(height),
+Map::Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+         JobSystem *jobs) : m_width(width), m_height(height),
     m_level_data(level_data), m_texture_id(texture_id), m_tile_size(tile_size), m_tile_count_x(tile_count_x), m_tile_count_y(tile_count_y)
 {
-    build();
+    m_tiles.assign(m_width, m_height, m_level_data);
+    build(jobs);
+    build_solid_levels();
 }
 
-void Map::build()
+// Rows per job, so that each job has some thousands of tiles to go through
+static int get_row_grain(int width)
 {
-    // Since this is a 2D map, we need a nested for-loop
-    for(int y_coord = 0; y_coord < m_height; y_coord++)
-    {
-        for(int x_coord = 0; x_coord < m_width; x_coord++)
+    return std::max(1, 16384 / std::max(width, 1));
+}
+
+void Map::build(JobSystem *jobs)
+{
+    // 1. Count the solid tiles of every row: row_first[y + 1] is row y's count for now
+    std::vector<int> row_first(m_height + 1, 0);
+    auto count_rows = [&](int begin, int end) {
+        for (int y_coord = begin; y_coord < end; y_coord++)
         {
-            // Get the current tile
-            int tile = m_level_data[y_coord * m_width + x_coord];
-            
-            // If the tile number is 0 i.e. not solid, skip to the next one
-            if (tile == 0) continue;
-            
-            // Otherwise, calculate its UV-coordinates
-            float u_coord = (float) (tile % m_tile_count_x) / (float) m_tile_count_x;
-            float v_coord = (float) (tile / m_tile_count_x) / (float) m_tile_count_y;
-            
-            // And work out their dimensions and posititions
-            float tile_width = 1.0f/ (float)  m_tile_count_x;
-            float tile_height = 1.0f/ (float) m_tile_count_y;
-            
-            float x_offset = -(m_tile_size / 2); // From center of tile
-            float y_offset =  (m_tile_size / 2); // From center of tile
-            
-            // So we can store them inside our std::vectors
-            m_vertices.insert(m_vertices.end(), {
-                x_offset + (m_tile_size * x_coord),  y_offset +  -m_tile_size * y_coord,
-                x_offset + (m_tile_size * x_coord),  y_offset + (-m_tile_size * y_coord) - m_tile_size,
-                x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset + (-m_tile_size * y_coord) - m_tile_size,
-                x_offset + (m_tile_size * x_coord), y_offset + -m_tile_size * y_coord,
-                x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset + (-m_tile_size * y_coord) - m_tile_size,
-                x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset +  -m_tile_size * y_coord
-            });
-            
-            m_texture_coordinates.insert(m_texture_coordinates.end(), {
-                u_coord, v_coord,
-                u_coord, v_coord + (tile_height),
-                u_coord + tile_width, v_coord + (tile_height),
-                u_coord, v_coord,
-                u_coord + tile_width, v_coord + (tile_height),
-                u_coord + tile_width, v_coord
-            });
+            const unsigned int *row = m_level_data + (size_t) y_coord * m_width;
+            int count = 0;
+            for (int x_coord = 0; x_coord < m_width; x_coord++) count += row[x_coord] != 0;
+            row_first[y_coord + 1] = count;
         }
-    }
+    };
+    if (jobs != nullptr) jobs->parallel_for(m_height, get_row_grain(m_width), count_rows);
+    else                 count_rows(0, m_height);
+    
+    // 2. A running total turns the counts into where each row's first quad goes
+    for (int y_coord = 0; y_coord < m_height; y_coord++) row_first[y_coord + 1] += row_first[y_coord];
+    
+    // 3. Size the buffers once, then write every row's quads straight into their place
+    size_t floats = (size_t) row_first[m_height] * 12;
+    m_vertices.clear();
+    m_texture_coordinates.clear();
+    m_vertices.resize(floats);
+    m_texture_coordinates.resize(floats);
+    m_tile_quads.resize((size_t) m_width * m_height);
+    m_free_quads.clear();
+    m_dirty_quads.clear();
+    m_rebuilt = true;
+    m_edit_count++;
+    
+    auto write_rows = [&](int begin, int end) {
+        for (int y_coord = begin; y_coord < end; y_coord++) write_row_quads(y_coord, row_first[y_coord]);
+    };
+    if (jobs != nullptr) jobs->parallel_for(m_height, get_row_grain(m_width), write_rows);
+    else                 write_rows(0, m_height);
     
     // The bounds are dependent on the size of the tiles
     m_left_bound   = 0 - (m_tile_size / 2);
@@ -67,6 +70,223 @@ void Map::build()
     m_bottom_bound = -(m_tile_size * m_height) + (m_tile_size / 2);
 }
 
+// Two triangles for each solid tile of the row, left to right, from quad first_quad on
+void Map::write_row_quads(int y_coord, int first_quad)
+{
+    // One row of the 2D map, tile by tile
+    for(int x_coord = 0; x_coord < m_width; x_coord++)
+    {
+        // Get the current tile
+        int tile = m_level_data[y_coord * m_width + x_coord];
+        
+        // Note which quad draws it, if any
+        m_tile_quads[(size_t) y_coord * m_width + x_coord] = tile == 0 ? -1 : first_quad;
+        
+        // If the tile number is 0 i.e. not solid, skip to the next one
+        if (tile == 0) continue;
+        
+        write_quad(x_coord, y_coord, tile, &m_vertices[(size_t) first_quad * 12],
+                   &m_texture_coordinates[(size_t) first_quad * 12]);
+        first_quad++;
+    }
+}
+
+// The 12 positions and 12 texture coordinates of one tile's two triangles
+void Map::write_quad(int x_coord, int y_coord, unsigned int tile, float *vertices, float *texture_coordinates) const
+{
+    // Calculate its UV-coordinates
+    float u_coord = (float) (tile % m_tile_count_x) / (float) m_tile_count_x;
+    float v_coord = (float) (tile / m_tile_count_x) / (float) m_tile_count_y;
+    
+    // And work out their dimensions and posititions
+    float tile_width = 1.0f/ (float)  m_tile_count_x;
+    float tile_height = 1.0f/ (float) m_tile_count_y;
+    
+    float x_offset = -(m_tile_size / 2); // From center of tile
+    float y_offset =  (m_tile_size / 2); // From center of tile
+    
+    // So we can store them in their places
+    const float quad[12] =
+    {
+        x_offset + (m_tile_size * x_coord),  y_offset +  -m_tile_size * y_coord,
+        x_offset + (m_tile_size * x_coord),  y_offset + (-m_tile_size * y_coord) - m_tile_size,
+        x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset + (-m_tile_size * y_coord) - m_tile_size,
+        x_offset + (m_tile_size * x_coord), y_offset + -m_tile_size * y_coord,
+        x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset + (-m_tile_size * y_coord) - m_tile_size,
+        x_offset + (m_tile_size * x_coord) + m_tile_size, y_offset +  -m_tile_size * y_coord
+    };
+    
+    const float uvs[12] =
+    {
+        u_coord, v_coord,
+        u_coord, v_coord + (tile_height),
+        u_coord + tile_width, v_coord + (tile_height),
+        u_coord, v_coord,
+        u_coord + tile_width, v_coord + (tile_height),
+        u_coord + tile_width, v_coord
+    };
+    
+    std::copy(quad, quad + 12, vertices);
+    std::copy(uvs, uvs + 12, texture_coordinates);
+}
+
+// ————— TILE EDITS ————— //
+bool Map::set_tile(int tile_x, int tile_y, unsigned int tile)
+{
+    if (tile_x < 0 || tile_x >= m_width || tile_y < 0 || tile_y >= m_height) return false;
+    
+    size_t index = (size_t) tile_y * m_width + tile_x;
+    if (m_level_data[index] == tile) return false;
+    m_level_data[index] = tile;
+    m_edit_count++;
+    update_solidity(tile_x, tile_y);
+    
+    int &quad = m_tile_quads[index];
+    if (tile == 0)
+    {
+        // All six corners on one point: nothing left to rasterise
+        std::fill(m_vertices.begin() + (size_t) quad * 12, m_vertices.begin() + (size_t) quad * 12 + 12, 0.0f);
+        std::fill(m_texture_coordinates.begin() + (size_t) quad * 12,
+                  m_texture_coordinates.begin() + (size_t) quad * 12 + 12, 0.0f);
+        m_free_quads.push_back(quad);
+        m_dirty_quads.push_back(quad);
+        quad = -1;
+        return true;
+    }
+    
+    if (quad < 0 && !m_free_quads.empty())
+    {
+        quad = m_free_quads.back();
+        m_free_quads.pop_back();
+    }
+    else if (quad < 0)
+    {
+        quad = (int) (m_vertices.size() / 12);
+        m_vertices.resize(m_vertices.size() + 12);
+        m_texture_coordinates.resize(m_texture_coordinates.size() + 12);
+    }
+    write_quad(tile_x, tile_y, tile, &m_vertices[(size_t) quad * 12], &m_texture_coordinates[(size_t) quad * 12]);
+    m_dirty_quads.push_back(quad);
+    return true;
+}
+
+// Room for a quarter more quads than the mesh has, so placing tiles seldom outgrows it
+static int get_buffer_capacity(int quad_count)
+{
+    return quad_count + std::max(quad_count / 4, 1024);
+}
+
+void Map::MeshPatch::clear()
+{
+    runs.clear();
+    vertices.clear();
+    texture_coordinates.clear();
+    quad_count = -1;
+    capacity   = 0;
+    full       = false;
+}
+
+// Appends quads [first_quad, first_quad + quad_count) to the pending patch; lock held
+void Map::add_patch_run(int first_quad, int quad_count)
+{
+    m_pending.runs.push_back(first_quad);
+    m_pending.runs.push_back(quad_count);
+    
+    size_t begin = (size_t) first_quad * 12, end = begin + (size_t) quad_count * 12;
+    m_pending.vertices.insert(m_pending.vertices.end(), m_vertices.begin() + begin, m_vertices.begin() + end);
+    m_pending.texture_coordinates.insert(m_pending.texture_coordinates.end(),
+                                         m_texture_coordinates.begin() + begin, m_texture_coordinates.begin() + end);
+}
+
+void Map::submit_edits()
+{
+    if (!m_uploaded || (m_dirty_quads.empty() && !m_rebuilt)) return;
+    
+    int quad_count = (int) (m_vertices.size() / 12);
+    std::lock_guard<std::mutex> lock(m_patch_mutex);
+    
+    if (m_rebuilt || quad_count > m_gpu_capacity)
+    {
+        // The whole mesh, into new buffers; whatever was pending before is part of it
+        m_gpu_capacity = get_buffer_capacity(quad_count);
+        m_pending.clear();
+        m_pending.full     = true;
+        m_pending.capacity = m_gpu_capacity;
+        add_patch_run(0, quad_count);
+    }
+    else
+    {
+        // Sorted, the quads fall into runs that each take one copy
+        std::sort(m_dirty_quads.begin(), m_dirty_quads.end());
+        for (size_t i = 0; i < m_dirty_quads.size(); )
+        {
+            int first = m_dirty_quads[i], last = first;
+            while (++i < m_dirty_quads.size() && m_dirty_quads[i] <= last + 1) last = m_dirty_quads[i];
+            add_patch_run(first, last - first + 1);
+        }
+    }
+    
+    m_pending.quad_count = quad_count;
+    m_dirty_quads.clear();
+    m_rebuilt = false;
+}
+
+void Map::upload()
+{
+    int quad_count = (int) (m_vertices.size() / 12);
+    m_gpu_capacity = get_buffer_capacity(quad_count);
+    
+    if (m_vertex_buffer == 0) glGenBuffers(1, &m_vertex_buffer);
+    if (m_texture_coordinate_buffer == 0) glGenBuffers(1, &m_texture_coordinate_buffer);
+    
+    GLsizeiptr capacity = (GLsizeiptr) m_gpu_capacity * 12 * sizeof(float),
+               size     = (GLsizeiptr) quad_count     * 12 * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, m_texture_coordinate_buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_texture_coordinates.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    m_drawn_quads = quad_count;
+    m_dirty_quads.clear();
+    m_pending.clear();
+    m_uploaded = true;
+    m_rebuilt  = false;
+}
+
+// Takes whatever was submitted, under the lock only as long as a swap, and copies it in
+void Map::apply_patches()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_patch_mutex);
+        if (m_pending.quad_count < 0) return;
+        std::swap(m_pending, m_applying);
+        m_pending.clear();
+    }
+    
+    GLsizeiptr capacity = (GLsizeiptr) m_applying.capacity * 12 * sizeof(float);
+    const GLuint buffers[2] = { m_vertex_buffer, m_texture_coordinate_buffer };
+    const MeshBuffer *floats[2] = { &m_applying.vertices, &m_applying.texture_coordinates };
+    
+    for (int b = 0; b < 2; b++)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[b]);
+        if (m_applying.full) glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+        
+        const float *source = floats[b]->data();
+        for (size_t r = 0; r < m_applying.runs.size(); r += 2)
+        {
+            GLsizeiptr size = (GLsizeiptr) m_applying.runs[r + 1] * 12 * sizeof(float);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) m_applying.runs[r] * 12 * sizeof(float), size, source);
+            source += m_applying.runs[r + 1] * 12;
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_drawn_quads = m_applying.quad_count;
+}
+
 void Map::render(ShaderProgram *program)
 {
     glm::mat4 model_matrix = glm::mat4(1.0f);
@@ -74,14 +294,33 @@ void Map::render(ShaderProgram *program)
     
     glUseProgram(program->get_program_id());
     
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
+    // The buffers are drawn by their own quad count: the mesh belongs to the simulation
+    // thread, which may be growing it right now
+    int vertex_count;
+    if (m_vertex_buffer != 0)
+    {
+        apply_patches();
+        vertex_count = m_drawn_quads * 6;
+        
+        // From the buffers, where the attribute "pointers" are offsets into them
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, nullptr);
+        glBindBuffer(GL_ARRAY_BUFFER, m_texture_coordinate_buffer);
+        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, nullptr);
+        glBindBuffer(GL_ARRAY_BUFFER, 0); // everything else draws from client memory
+    }
+    else
+    {
+        vertex_count = (int) m_vertices.size() / 2;
+        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
+        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
+    }
     glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
     glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
     
     glBindTexture(GL_TEXTURE_2D, m_texture_id);
     
-    glDrawArrays(GL_TRIANGLES, 0, (int) m_vertices.size() / 2);
+    glDrawArrays(GL_TRIANGLES, 0, vertex_count);
     glDisableVertexAttribArray(program->get_position_attribute());
     glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
 }
@@ -108,7 +347,7 @@ bool Map::is_solid(glm::vec3 position, float *penetration_x, float *penetration_
     if (tile_y < 0 || tile_y >= m_height) return false;
     
     // If the tile index is 0 i.e. an open space, it is not solid
-    int tile = m_level_data[tile_y * m_width + tile_x];
+    int tile = m_tiles.get(tile_x, tile_y);
     if (tile == 0) return false;
     
     // And we likely have some overlap
@@ -121,3 +360,260 @@ bool Map::is_solid(glm::vec3 position, float *penetration_x, float *penetration_
     
     return true;
 }
+
+// ————— SOLIDITY PYRAMID ————— //
+void Map::build_solid_levels()
+{
+    m_solid_levels.clear();
+    
+    for (int level = 1; (1 << (level - 1)) < m_width || (1 << (level - 1)) < m_height; level++)
+    {
+        int width  = (m_width  + (1 << level) - 1) >> level,
+            height = (m_height + (1 << level) - 1) >> level;
+        m_solid_levels.push_back(std::vector<unsigned char>(width * height, 0));
+        
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                m_solid_levels.back()[y * width + x] = block_has_solid(level, x, y);
+    }
+}
+
+// Looks at the four blocks one level down that make up this block
+bool Map::block_has_solid(int level, int block_x, int block_y) const
+{
+    for (int y = block_y * 2; y <= block_y * 2 + 1; y++)
+    {
+        for (int x = block_x * 2; x <= block_x * 2 + 1; x++)
+        {
+            if (level == 1)
+            {
+                if (x < m_width && y < m_height && m_tiles.is_solid(x, y)) return true;
+            }
+            else
+            {
+                int width  = (m_width  + (1 << (level - 1)) - 1) >> (level - 1),
+                    height = (m_height + (1 << (level - 1)) - 1) >> (level - 1);
+                if (x < width && y < height && m_solid_levels[level - 2][y * width + x]) return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Map::update_solidity(int tile_x, int tile_y)
+{
+    m_tiles.set(tile_x, tile_y, m_level_data[tile_y * m_width + tile_x]);
+    
+    for (int level = 1; level <= (int) m_solid_levels.size(); level++)
+    {
+        int width = (m_width + (1 << level) - 1) >> level;
+        unsigned char &block = m_solid_levels[level - 1][(tile_y >> level) * width + (tile_x >> level)];
+        
+        unsigned char solid = block_has_solid(level, tile_x >> level, tile_y >> level);
+        if (block == solid) return; // nothing above can change either
+        block = solid;
+    }
+}
+
+bool Map::is_block_empty(int level, int tile_x, int tile_y) const
+{
+    if (level == 0) return !m_tiles.is_solid(tile_x, tile_y);
+    
+    int width = (m_width + (1 << level) - 1) >> level;
+    return !m_solid_levels[level - 1][(tile_y >> level) * width + (tile_x >> level)];
+}
+
+// ————— RAYCASTS ————— //
+// Sets up a walk in tile units, with (0, 0) at the top-left corner of tile (0, 0) and rows
+// counting up as y goes down, so that floor() of a coordinate is the tile index. The ray
+// is clipped to the map's rectangle first, since nothing outside it can be solid.
+bool Map::start_ray(glm::vec3 origin, glm::vec3 direction, float max_distance, RayWalk *walk) const
+{
+    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+    if (length == 0.0f || max_distance < 0.0f) return false;
+    
+    walk->u  = origin.x / m_tile_size + 0.5f;
+    walk->v  = -origin.y / m_tile_size + 0.5f;
+    walk->du = direction.x / length / m_tile_size;
+    walk->dv = -direction.y / length / m_tile_size;
+    
+    float t_enter = 0.0f, t_exit = max_distance;
+    float start[2] = { walk->u, walk->v }, delta[2] = { walk->du, walk->dv },
+          size[2]  = { (float) m_width, (float) m_height };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (delta[axis] == 0.0f)
+        {
+            if (start[axis] < 0.0f || start[axis] >= size[axis]) return false;
+            continue;
+        }
+        float t0 = (0.0f - start[axis]) / delta[axis],
+              t1 = (size[axis] - start[axis]) / delta[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        t_enter = std::max(t_enter, t0);
+        t_exit  = std::min(t_exit, t1);
+    }
+    if (t_enter >= t_exit) return false;
+    
+    walk->t      = t_enter;
+    walk->t_exit = t_exit;
+    walk->tile_x = std::min(std::max((int) floorf(walk->u + walk->du * t_enter), 0), m_width - 1);
+    walk->tile_y = std::min(std::max((int) floorf(walk->v + walk->dv * t_enter), 0), m_height - 1);
+    return true;
+}
+
+// Steps through empty space a whole block at a time: at each step it finds the largest
+// empty block of the pyramid around the current tile and jumps to where the ray leaves it
+bool Map::raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const
+{
+    *hit = RaycastHit();
+    
+    RayWalk walk;
+    if (!start_ray(origin, direction, max_distance, &walk)) return false;
+    
+    int top_level = (int) m_solid_levels.size(),
+        level     = 0;
+    
+    while (walk.t <= walk.t_exit)
+    {
+        // The block we skipped last time is a good first guess for this one
+        while (level > 0 && !is_block_empty(level, walk.tile_x, walk.tile_y)) level--;
+        if (level == 0 && !is_block_empty(0, walk.tile_x, walk.tile_y))
+        {
+            hit->tile_x   = walk.tile_x;
+            hit->tile_y   = walk.tile_y;
+            hit->distance = walk.t;
+            return true;
+        }
+        while (level < top_level && is_block_empty(level + 1, walk.tile_x, walk.tile_y)) level++;
+        
+        int size     = 1 << level;
+        int block_x0 = (walk.tile_x >> level) << level,
+            block_y0 = (walk.tile_y >> level) << level;
+        
+        float exit_x = walk.du > 0.0f ? (block_x0 + size - walk.u) / walk.du :
+                       walk.du < 0.0f ? (block_x0 - walk.u) / walk.du : INFINITY;
+        float exit_y = walk.dv > 0.0f ? (block_y0 + size - walk.v) / walk.dv :
+                       walk.dv < 0.0f ? (block_y0 - walk.v) / walk.dv : INFINITY;
+        
+        // Leave through the nearer side; along the other axis we are still inside the block.
+        // Through a corner, leave by the row first, as the tile-by-tile walk does.
+        if (exit_x < exit_y)
+        {
+            walk.t      = exit_x;
+            walk.tile_x = walk.du > 0.0f ? block_x0 + size : block_x0 - 1;
+            walk.tile_y = std::min(std::max((int) floorf(walk.v + walk.dv * walk.t), block_y0), block_y0 + size - 1);
+        }
+        else
+        {
+            walk.t      = exit_y;
+            walk.tile_y = walk.dv > 0.0f ? block_y0 + size : block_y0 - 1;
+            walk.tile_x = std::min(std::max((int) floorf(walk.u + walk.du * walk.t), block_x0), block_x0 + size - 1);
+        }
+        
+        if (walk.tile_x < 0 || walk.tile_x >= m_width || walk.tile_y < 0 || walk.tile_y >= m_height) return false;
+    }
+    return false;
+}
+
+bool Map::raycast_tile_by_tile(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const
+{
+    *hit = RaycastHit();
+    
+    RayWalk walk;
+    if (!start_ray(origin, direction, max_distance, &walk)) return false;
+    
+    int step_x = walk.du > 0.0f ? 1 : -1,
+        step_y = walk.dv > 0.0f ? 1 : -1;
+    
+    while (walk.t <= walk.t_exit)
+    {
+        if (m_tiles.is_solid(walk.tile_x, walk.tile_y))
+        {
+            hit->tile_x   = walk.tile_x;
+            hit->tile_y   = walk.tile_y;
+            hit->distance = walk.t;
+            return true;
+        }
+        
+        // Distance along the ray at which it crosses into the next column / row. Worked out
+        // from the tile index every step rather than accumulated, which drifts a whole tile
+        // off over rays a few thousand tiles long.
+        float next_x = walk.du != 0.0f ? ((walk.tile_x + (walk.du > 0.0f)) - walk.u) / walk.du : INFINITY,
+              next_y = walk.dv != 0.0f ? ((walk.tile_y + (walk.dv > 0.0f)) - walk.v) / walk.dv : INFINITY;
+        
+        if (next_x < next_y)
+        {
+            walk.t = next_x;
+            walk.tile_x += step_x;
+            if (walk.tile_x < 0 || walk.tile_x >= m_width) return false;
+        }
+        else
+        {
+            walk.t = next_y;
+            walk.tile_y += step_y;
+            if (walk.tile_y < 0 || walk.tile_y >= m_height) return false;
+        }
+    }
+    return false;
+}
+
+void Map::raycast(const Ray *rays, int ray_count, RaycastHit *hits) const
+{
+    for (int i = 0; i < ray_count; i++) raycast(rays[i].origin, rays[i].direction, rays[i].max_distance, &hits[i]);
+}
+
+bool Map::has_line_of_sight(glm::vec3 from, glm::vec3 to) const
+{
+    RaycastHit hit;
+    glm::vec3 direction = to - from;
+    return !raycast(from, direction, sqrtf(direction.x * direction.x + direction.y * direction.y), &hit);
+}
+
+// ————— REGION QUERIES ————— //
+bool Map::any_solid_in_block(int level, int block_x, int block_y, int x0, int y0, int x1, int y1) const
+{
+    int size = 1 << level;
+    int left = block_x * size, top = block_y * size, right = left + size - 1, bottom = top + size - 1;
+    if (right < x0 || left > x1 || bottom < y0 || top > y1) return false;
+    if (is_block_empty(level, left, top)) return false;
+    
+    // A solid tile somewhere in a block that lies wholly inside the region is enough
+    if (level == 0 || (left >= x0 && right <= x1 && top >= y0 && bottom <= y1)) return true;
+    
+    for (int y = block_y * 2; y <= block_y * 2 + 1; y++)
+        for (int x = block_x * 2; x <= block_x * 2 + 1; x++)
+            if ((x << (level - 1)) < m_width && (y << (level - 1)) < m_height &&
+                any_solid_in_block(level - 1, x, y, x0, y0, x1, y1)) return true;
+    return false;
+}
+
+bool Map::any_solid(int x0, int y0, int x1, int y1) const
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width - 1);
+    y1 = std::min(y1, m_height - 1);
+    if (x0 > x1 || y0 > y1) return false;
+    
+    return any_solid_in_block((int) m_solid_levels.size(), 0, 0, x0, y0, x1, y1);
+}
+
+bool Map::any_solid_tile_by_tile(int x0, int y0, int x1, int y1) const
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width - 1);
+    y1 = std::min(y1, m_height - 1);
+    
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            if (m_tiles.is_solid(x, y)) return true;
+    return false;
+}
+
+bool Map::box_overlaps_solid(glm::vec3 centre, float width, float height) const
+{
+    return any_solid(get_tile_x(centre.x - width / 2), get_tile_y(centre.y + height / 2),
+                     get_tile_x(centre.x + width / 2), get_tile_y(centre.y - height / 2));
+}
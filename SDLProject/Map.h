@@ -4,6 +4,9 @@
 #include <GL/glew.h>
 #endif
 #define GL_GLEXT_PROTOTYPES 1
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include <math.h>
 #include <SDL.h>
@@ -12,6 +15,45 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "TileStorage.h"
+
+class JobSystem;
+
+// std::allocator, except that resize() leaves new elements uninitialised rather than
+// zeroing them, for buffers whose every element is about to be written anyway (and maybe
+// on other threads, which would otherwise have to wait for this one to zero them all)
+template <typename T>
+struct NoInitAllocator : std::allocator<T>
+{
+    template <typename U> struct rebind { typedef NoInitAllocator<U> other; };
+
+    NoInitAllocator() = default;
+    template <typename U> NoInitAllocator(const NoInitAllocator<U> &) {}
+
+    template <typename U> void construct(U *) {}
+    template <typename U, typename... Args> void construct(U *pointer, Args &&...arguments)
+    {
+        ::new ((void *) pointer) U(std::forward<Args>(arguments)...);
+    }
+};
+
+// A mesh's positions or texture coordinates, two floats per vertex
+typedef std::vector<float, NoInitAllocator<float>> MeshBuffer;
+
+// A ray through the map in world space; direction need not be normalised
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float     max_distance;
+};
+
+// The first solid tile a ray meets
+struct RaycastHit
+{
+    int   tile_x = -1, tile_y = -1; // -1 if the ray reached max_distance without hitting anything
+    float distance = 0.0f;          // along the ray to where it enters that tile
+};
 
 class Map
 {
@@ -21,6 +63,9 @@ private:
     
     // Here, the level_data is the numerical "drawing" of the map
     unsigned int *m_level_data;
+    
+    // The same drawing, compact and in blocks, for everything that asks what a tile is
+    TileStorage m_tiles;
     GLuint m_texture_id;
     
     float m_tile_size;
@@ -29,35 +74,149 @@ private:
     
     // Just like with rendering text, we're rendering several sprites at once
     // So we need vectors to store their respective vertices and texture coordinates
-    std::vector<float> m_vertices;
-    std::vector<float> m_texture_coordinates;
+    MeshBuffer m_vertices;
+    MeshBuffer m_texture_coordinates;
+    
+    // Which quad of the mesh draws each tile, -1 for an open one. A cleared tile leaves
+    // its quad behind, collapsed to nothing, for the next tile placed to take over, so a
+    // tile edit rewrites one quad and never moves the others.
+    std::vector<int, NoInitAllocator<int>> m_tile_quads;
+    std::vector<int> m_free_quads;
+    std::vector<int> m_dirty_quads;  // rewritten since the last submit_edits()
+    unsigned int     m_edit_count = 0;   // bumped by every build and every tile changed
+    bool             m_uploaded = false,
+                     m_rebuilt  = false; // built again since upload(): the GPU needs the whole mesh
+    int              m_gpu_capacity = 0; // quads the GPU buffers hold once what was submitted is applied
+    
+    // ————— GPU MESH ————— //
+    // Edits on their way from the simulation to the render thread: runs of consecutive
+    // quads with their floats, in the order they were submitted. A full patch replaces
+    // the buffers (bigger) before its runs are copied in.
+    struct MeshPatch
+    {
+        std::vector<int> runs;       // first quad and quad count, pair after pair
+        MeshBuffer       vertices;
+        MeshBuffer       texture_coordinates;
+        int              quad_count = -1; // the mesh's size once applied; -1 if there is nothing to apply
+        int              capacity   = 0;
+        bool             full       = false;
+        
+        void clear();
+    };
+    std::mutex m_patch_mutex;
+    MeshPatch  m_pending;  // the simulation's side, behind m_patch_mutex
+    MeshPatch  m_applying; // the render thread's; swapped with m_pending so neither allocates
+    GLuint     m_vertex_buffer = 0, m_texture_coordinate_buffer = 0;
+    int        m_drawn_quads   = 0;
     
     // The boundaries of the map
     float m_left_bound, m_right_bound, m_top_bound, m_bottom_bound;
     
+    // Solidity pyramid: m_solid_levels[k - 1] has one byte per 2^k x 2^k block of tiles,
+    // set if any tile in the block is solid. The last level is a single block covering
+    // the whole map, so queries can skip empty space a block at a time.
+    std::vector<std::vector<unsigned char>> m_solid_levels;
+    
+    void write_quad(int x_coord, int y_coord, unsigned int tile, float *vertices, float *texture_coordinates) const;
+    void write_row_quads(int y_coord, int first_quad);
+    void add_patch_run(int first_quad, int quad_count);
+    void apply_patches();
+    void build_solid_levels();
+    bool block_has_solid(int level, int block_x, int block_y) const;
+    bool is_block_empty(int level, int tile_x, int tile_y) const; // level 0 is the tile itself
+    bool any_solid_in_block(int level, int block_x, int block_y, int x0, int y0, int x1, int y1) const;
+    
+    // A ray's progress through the grid, in tile units
+    struct RayWalk
+    {
+        float u, v, du, dv; // position and direction; u counts columns, v counts rows
+        float t, t_exit;    // distance travelled, and where the ray leaves the map
+        int   tile_x, tile_y;
+    };
+    bool start_ray(glm::vec3 origin, glm::vec3 direction, float max_distance, RayWalk *walk) const;
+    
 public:
-    // Constructor
+    // Constructor; builds the mesh on jobs' threads when there are jobs
     Map(int width, int height, unsigned int *level_data, GLuint texture_id,
-        float tile_size, int tile_count_x, int tile_count_y);
+        float tile_size, int tile_count_x, int tile_count_y, JobSystem *jobs = nullptr);
     
     // Methods
-    void build();
+    // (Re)builds the mesh in two passes: counts the solid tiles of every row, then writes
+    // each row's quads straight to its place in buffers sized once. With jobs, both passes
+    // split the rows across its threads; the mesh comes out the same either way.
+    void build(JobSystem *jobs = nullptr);
+    
+    // Puts the mesh in vertex buffers, with some room to grow, so that tile edits reach the
+    // GPU as a few glBufferSubData() calls of the quads they touched. GL thread only, and
+    // before anything else draws the map; without it render() draws from the mesh as is.
+    void upload();
+    
+    // Draws the map, first copying into the vertex buffers whatever submit_edits() has
+    // handed over since the last time. May run on another thread than the edits.
     void render(ShaderProgram *program);
     bool is_solid(glm::vec3 position, float *penetration_x, float *penetration_y);
     
+    // Walks the tiles a ray crosses (grid DDA) and stops at the first solid one, skipping
+    // empty blocks whole. Anything outside the map counts as open space, as in is_solid().
+    bool raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const;
+    
+    // The same walk one tile at a time, without the pyramid; for comparison
+    bool raycast_tile_by_tile(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const;
+    
+    // Casts ray_count rays in one call; hits[i] answers rays[i]
+    void raycast(const Ray *rays, int ray_count, RaycastHit *hits) const;
+    
+    // True if no solid tile lies on the segment between the two points
+    bool has_line_of_sight(glm::vec3 from, glm::vec3 to) const;
+    
+    // Whether any tile in the inclusive tile rectangle [x0, x1] x [y0, y1] is solid
+    bool any_solid(int x0, int y0, int x1, int y1) const;
+    bool any_solid_tile_by_tile(int x0, int y0, int x1, int y1) const;
+    
+    // Whether a world-space box touches any solid tile
+    bool box_overlaps_solid(glm::vec3 centre, float width, float height) const;
+    
+    // Brings the tile storage and the solidity pyramid up to date after the tile at
+    // (tile_x, tile_y) changed in the level data; touches one block per level at most
+    void update_solidity(int tile_x, int tile_y);
+    
+    // Changes one tile and everything the map derives from it: the tile storage, the
+    // solidity pyramid and the tile's quad in the mesh. The level data is written in
+    // place, so another Map made from the same array is left behind. Returns false if the
+    // tile is off the map or already was tile. Not while anything reads the map, such as
+    // worlds ticking; static colliders and nav graphs baked from it are patched apart.
+    bool set_tile(int tile_x, int tile_y, unsigned int tile);
+    
+    // Hands the quads edited since the last call to the render thread (one run per stretch
+    // of consecutive quads), for render() to copy into the vertex buffers. Once a frame,
+    // from the thread that edits; does nothing before upload().
+    void submit_edits();
+    
+    // Tile column/row that contains a world-space coordinate (may be out of range)
+    int const get_tile_x(float x) const { return (int) floor((x + (m_tile_size / 2)) / m_tile_size); }
+    int const get_tile_y(float y) const { return (int) floor((-y + (m_tile_size / 2)) / m_tile_size); }
+    
     // Getters
     int const get_width()  const  { return m_width;  }
     int const get_height() const  { return m_height; }
     
     unsigned int* const get_level_data() const { return m_level_data; }
+    const TileStorage &get_tiles()       const { return m_tiles;      }
     GLuint        const get_texture_id() const { return m_texture_id; }
     
+    // Changes whenever a tile does, so whoever copied tiles out can tell theirs are stale
+    unsigned int  const get_edit_count() const { return m_edit_count; }
+    
+    // 0 until upload(); what is in them trails the mesh until render() applies the edits
+    GLuint const get_vertex_buffer()             const { return m_vertex_buffer;             }
+    GLuint const get_texture_coordinate_buffer() const { return m_texture_coordinate_buffer; }
+    
     float const get_tile_size()    const { return m_tile_size;    }
     int   const get_tile_count_x() const { return m_tile_count_x; }
     int   const get_tile_count_y() const { return m_tile_count_y; }
     
-    std::vector<float> const get_vertices()            const { return m_vertices;             }
-    std::vector<float> const get_texture_coordinates() const { return m_texture_coordinates; }
+    const MeshBuffer &get_vertices()            const { return m_vertices;            }
+    const MeshBuffer &get_texture_coordinates() const { return m_texture_coordinates; }
     
     float const get_left_bound()   const { return m_left_bound;   }
     float const get_right_bound()  const { return m_right_bound;  }
@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <functional>
+#include "Navigation.h"
+
+NavProfile make_nav_profile(const Entity &entity, float tile_size)
+{
+    return make_nav_profile(entity.get_body(), tile_size);
+}
+
+NavProfile make_nav_profile(const EntityBody &body, float tile_size)
+{
+    NavProfile profile;
+
+    float gravity = -body.acceleration.y,
+          power   = body.jumping_power;
+    if (gravity <= 0.0f || power <= 0.0f) return profile;
+
+    // Apex of v^2 / 2g, and the horizontal distance covered while going up and back down
+    float height    = power * power / (2.0f * gravity);
+    float air_time  = 2.0f * power / gravity;
+    float distance  = body.speed * air_time;
+
+    profile.jump_up     = (int) floor(height / tile_size);
+    profile.jump_across = (int) floor(distance / tile_size);
+    return profile;
+}
+
+// ————— GRAPH ————— //
+NavGraph::NavGraph(const Map &map, NavProfile profile) : m_width(map.get_width()), m_height(map.get_height()),
+    m_profile(profile), m_is_node(m_width * m_height, 0), m_out_links(m_width * m_height), m_in_links(m_width * m_height)
+{
+    rebuild(map, 0, 0, m_width - 1, m_height - 1);
+}
+
+bool NavGraph::is_solid_tile(const Map &map, int x, int y) const
+{
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) return false;
+    return map.get_tiles().is_solid(x, y);
+}
+
+// True if no tile in the rectangle [x0, x1] x [y0, y1] is solid; corners in any order
+bool NavGraph::is_clear(const Map &map, int x0, int y0, int x1, int y1) const
+{
+    if (x0 > x1) std::swap(x0, x1);
+    if (y0 > y1) std::swap(y0, y1);
+
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            if (is_solid_tile(map, x, y)) return false;
+    return true;
+}
+
+void NavGraph::build_links(const Map &map, int node)
+{
+    int x = node % m_width, y = node / m_width;
+    std::vector<NavLink> &links = m_out_links[node];
+
+    for (int side = -1; side <= 1; side += 2)
+    {
+        int next_x = x + side;
+        if (next_x < 0 || next_x >= m_width || is_solid_tile(map, next_x, y)) continue;
+
+        // Walk onto the neighbour, or step off the ledge and fall until something is below
+        if (m_is_node[y * m_width + next_x])
+        {
+            links.push_back({ y * m_width + next_x, NAV_WALK, 1 });
+            continue;
+        }
+
+        for (int fall_y = y + 1; fall_y < m_height; fall_y++)
+        {
+            if (is_solid_tile(map, next_x, fall_y)) break;
+            if (m_is_node[fall_y * m_width + next_x])
+            {
+                links.push_back({ fall_y * m_width + next_x, NAV_FALL, 1 + fall_y - y });
+                break;
+            }
+        }
+    }
+
+    // Jumps: up the own column to the higher of the two rows, across that row, then down
+    // onto the target. Conservative, but never claims a jump the arc can't make.
+    for (int dy = -m_profile.jump_up; dy <= MAX_JUMP_DROP; dy++)
+    {
+        int target_y = y + dy;
+        if (target_y < 0 || target_y >= m_height) continue;
+        int top_y = std::min(y, target_y);
+
+        for (int dx = -m_profile.jump_across; dx <= m_profile.jump_across; dx++)
+        {
+            // A one-tile step on the same row is a walk, not a jump
+            if (dx == 0 || (dy == 0 && abs(dx) == 1)) continue;
+
+            int target_x = x + dx;
+            if (target_x < 0 || target_x >= m_width) continue;
+
+            int target = target_y * m_width + target_x;
+            if (!m_is_node[target]) continue;
+
+            if (!is_clear(map, x, top_y, x, y) ||
+                !is_clear(map, x, top_y, target_x, top_y) ||
+                !is_clear(map, target_x, top_y, target_x, target_y)) continue;
+
+            links.push_back({ target, NAV_JUMP, abs(dx) + abs(dy) + 1 });
+        }
+    }
+
+    for (const NavLink &link : links)
+    {
+        m_in_links[link.node].push_back({ node, link.type, link.cost });
+        m_max_link_cost = std::max(m_max_link_cost, link.cost);
+    }
+}
+
+// Rebuilds every link that starts in [x0, x1] x [y0, y1], after refreshing which of
+// those tiles are nodes
+void NavGraph::rebuild(const Map &map, int x0, int y0, int x1, int y1)
+{
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            int node = y * m_width + x;
+
+            for (const NavLink &link : m_out_links[node])
+            {
+                std::vector<NavLink> &in = m_in_links[link.node];
+                in.erase(std::remove_if(in.begin(), in.end(),
+                                        [node](const NavLink &entry) { return entry.node == node; }),
+                         in.end());
+            }
+            m_out_links[node].clear();
+
+            m_is_node[node] = !is_solid_tile(map, x, y) && is_solid_tile(map, x, y + 1);
+        }
+    }
+
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            if (m_is_node[y * m_width + x]) build_links(map, y * m_width + x);
+}
+
+void NavGraph::patch(const Map &map, int x0, int, int x1, int y1)
+{
+    // Anything whose walk, fall or jump could touch the edited tiles. Falls come from any
+    // height, hence the band starting at the top row.
+    int reach = m_profile.jump_across + 1;
+    x0 = std::max(0, x0 - reach);
+    x1 = std::min(m_width - 1, x1 + reach);
+    y1 = std::min(m_height - 1, y1 + m_profile.jump_up + 1);
+    if (x0 > x1 || y1 < 0) return;
+
+    rebuild(map, x0, 0, x1, y1);
+    m_version++;
+}
+
+int NavGraph::find_node(const Map &map, glm::vec3 position) const
+{
+    int x = map.get_tile_x(position.x), y = map.get_tile_y(position.y);
+    if (x < 0 || x >= m_width) return -1;
+
+    for (y = std::max(y, 0); y < m_height; y++)
+    {
+        if (m_is_node[y * m_width + x]) return y * m_width + x;
+        if (is_solid_tile(map, x, y)) return -1;
+    }
+    return -1;
+}
+
+bool NavGraph::search_to(int start, int goal, NavSearch &search, int max_expansions) const
+{
+    int tile_count = m_width * m_height;
+    if ((int) search.cost.size() != tile_count)
+    {
+        search.cost.assign(tile_count, 0);
+        search.next.assign(tile_count, NavLink());
+        search.stamp.assign(tile_count, 0);
+        search.closed.assign(tile_count, 0);
+        search.current = 0;
+    }
+    if (++search.current == 0) // wrapped: nothing may look valid by accident
+    {
+        std::fill(search.stamp.begin(),  search.stamp.end(),  0);
+        std::fill(search.closed.begin(), search.closed.end(), 0);
+        search.current = 1;
+    }
+    search.open.clear();
+    search.settled.clear();
+    search.cut_off = false;
+
+    if (!is_node(start) || !is_node(goal)) return false;
+
+    // Manhattan distance to start; every link costs at least that, so it never overestimates
+    int start_x = start % m_width, start_y = start / m_width;
+    auto estimate = [&](int node) { return abs(node % m_width - start_x) + abs(node / m_width - start_y); };
+    std::greater<std::pair<int, int>> later;
+
+    search.cost[goal]  = 0;
+    search.stamp[goal] = search.current;
+    search.open.push_back(std::make_pair(estimate(goal), goal));
+
+    while (!search.open.empty())
+    {
+        std::pop_heap(search.open.begin(), search.open.end(), later);
+        int node = search.open.back().second;
+        search.open.pop_back();
+
+        if (search.closed[node] == search.current) continue; // stale entry
+        search.closed[node] = search.current;
+        search.settled.push_back(node);
+
+        if (node == start) return true;
+        if ((int) search.settled.size() >= max_expansions)
+        {
+            search.cut_off = true;
+            return false;
+        }
+
+        // Links into node, followed backwards: whoever stands at link.node goes to node
+        for (const NavLink &link : m_in_links[node])
+        {
+            int from = link.node,
+                cost = search.cost[node] + link.cost;
+            if (search.closed[from] == search.current) continue;
+            if (search.stamp[from] == search.current && search.cost[from] <= cost) continue;
+
+            search.cost[from]  = cost;
+            search.stamp[from] = search.current;
+            search.next[from]  = { node, link.type, link.cost };
+            search.open.push_back(std::make_pair(cost + estimate(from), from));
+            std::push_heap(search.open.begin(), search.open.end(), later);
+        }
+    }
+    return false;
+}
+
+// ————— LEVEL ————— //
+int NavLevel::add_profile(const Map &map, NavProfile profile)
+{
+    int index = find_graph(profile);
+    if (index >= 0) return index;
+
+    m_graphs.emplace_back(map, profile);
+    return (int) m_graphs.size() - 1;
+}
+
+void NavLevel::add_enemies(const Map &map, const Entity *enemies, int enemy_count)
+{
+    for (int i = 0; i < enemy_count; i++)
+    {
+        if (enemies[i].get_ai_type() == GUARD) add_profile(map, make_nav_profile(enemies[i], map.get_tile_size()));
+    }
+}
+
+int NavLevel::find_graph(NavProfile profile) const
+{
+    for (int i = 0; i < (int) m_graphs.size(); i++)
+    {
+        if (m_graphs[i].get_profile() == profile) return i;
+    }
+    return -1;
+}
+
+void NavLevel::patch(const Map &map, int x0, int y0, int x1, int y1)
+{
+    for (NavGraph &graph : m_graphs) graph.patch(map, x0, y0, x1, y1);
+}
+
+// ————— PATH CACHE ————— //
+NavPlanner::CacheSlot &NavPlanner::get_slot(const NavGraph &graph, int goal)
+{
+    CacheSlot *oldest = &m_slots[0];
+
+    for (CacheSlot &slot : m_slots)
+    {
+        if (slot.graph == &graph && slot.goal == goal && slot.version == graph.get_version())
+        {
+            slot.last_used = m_tick;
+            return slot;
+        }
+        if (slot.last_used < oldest->last_used) oldest = &slot;
+    }
+
+    // Reuse the least recently used slot for the new goal
+    if (oldest->keys.empty())
+    {
+        oldest->keys.resize(CACHE_CAPACITY);
+        oldest->links.resize(CACHE_CAPACITY);
+    }
+    std::fill(oldest->keys.begin(), oldest->keys.end(), -1);
+    oldest->graph     = &graph;
+    oldest->version   = graph.get_version();
+    oldest->goal      = goal;
+    oldest->last_used = m_tick;
+    oldest->count     = 0;
+    return *oldest;
+}
+
+// Where node's entry is in the table, or the empty entry where it would go
+int NavPlanner::probe(const CacheSlot &slot, int node) const
+{
+    for (unsigned int i = (unsigned int) node * 2654435761u; ; i++)
+    {
+        int index = (int) (i & (CACHE_CAPACITY - 1));
+        if (slot.keys[index] == node || slot.keys[index] == -1) return index;
+    }
+}
+
+void NavPlanner::store(CacheSlot &slot, int node, NavLink link)
+{
+    // Keep the table at most three quarters full so probes stay short; start over when full
+    if (slot.count >= CACHE_CAPACITY * 3 / 4)
+    {
+        std::fill(slot.keys.begin(), slot.keys.end(), -1);
+        slot.count = 0;
+    }
+
+    int index = probe(slot, node);
+    if (slot.keys[index] == -1) slot.count++;
+    slot.keys[index]  = node;
+    slot.links[index] = link;
+}
+
+// Out of searches: the way to where the player was a moment ago is nearly always still a
+// good way to where it is now, so try the goals remembered from earlier ticks
+bool NavPlanner::find_recent(const NavGraph &graph, int from, NavLink *link)
+{
+    const CacheSlot *best = nullptr;
+
+    for (const CacheSlot &slot : m_slots)
+    {
+        if (slot.graph != &graph || slot.version != graph.get_version() || slot.goal < 0) continue;
+
+        int index = probe(slot, from);
+        if (slot.keys[index] != from || slot.links[index].node < 0) continue;
+        if (best == nullptr || slot.last_used > best->last_used) best = &slot;
+    }
+    if (best == nullptr) return false;
+
+    *link = best->links[probe(*best, from)];
+    return true;
+}
+
+bool NavPlanner::next_link(const NavGraph &graph, int from, int goal, NavLink *link)
+{
+    if (from == goal) return false;
+
+    CacheSlot &slot = get_slot(graph, goal);
+
+    int index = probe(slot, from);
+    if (slot.keys[index] == from)
+    {
+        m_hit_count++;
+        *link = slot.links[index];
+        return link->node >= 0;
+    }
+
+    m_miss_count++;
+    if (m_searches_left == 0) return find_recent(graph, from, link);
+    m_searches_left--;
+    m_search_count++;
+
+    bool found = graph.search_to(from, goal, m_search, MAX_EXPANSIONS);
+
+    // Everything settled has its best way to goal now, whether or not from was reached
+    for (int node : m_search.settled)
+    {
+        if (node != goal) store(slot, node, m_search.next[node]);
+    }
+    if (found)
+    {
+        *link = m_search.next[from];
+        return true;
+    }
+
+    *link = NavLink { -1, NAV_WALK, 0 };
+    if (m_search.cut_off) return find_recent(graph, from, link);
+
+    store(slot, from, *link);
+    return false;
+}
+
+// ————— FLOW FIELD ————— //
+constexpr int FlowField::UNREACHABLE;
+
+void FlowField::update(const NavGraph &graph, int goal)
+{
+    if (&graph == m_graph && goal == m_goal && graph.get_version() == m_version) return;
+
+    m_graph   = &graph;
+    m_version = graph.get_version();
+    m_goal    = goal;
+    rebuild();
+}
+
+void FlowField::rebuild()
+{
+    m_rebuild_count++;
+    m_distance.assign(m_graph->get_node_count(), UNREACHABLE);
+    m_next.resize(m_graph->get_node_count());
+    if (!m_graph->is_node(m_goal)) return;
+
+    // Tentative distances never run more than the largest link cost ahead of the
+    // distance being settled, so that many buckets + 1 can be reused round-robin
+    int bucket_count = m_graph->get_max_link_cost() + 1;
+    if ((int) m_buckets.size() < bucket_count) m_buckets.resize(bucket_count);
+    for (std::vector<int> &bucket : m_buckets) bucket.clear();
+
+    m_distance[m_goal] = 0;
+    m_buckets[0].push_back(m_goal);
+    int pending = 1;
+
+    for (int distance = 0; pending > 0; distance++)
+    {
+        std::vector<int> &bucket = m_buckets[distance % bucket_count];
+
+        // Links relaxed from this bucket are never free, so it does not grow while we walk it
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            int node = bucket[i];
+            pending--;
+            if (m_distance[node] != distance) continue; // reached more cheaply since it was queued
+
+            for (const NavLink &link : m_graph->get_in_links(node))
+            {
+                int from = link.node,
+                    cost = distance + link.cost;
+                if (m_distance[from] != UNREACHABLE && m_distance[from] <= cost) continue;
+
+                m_distance[from] = cost;
+                m_next[from]     = { node, link.type, link.cost };
+                m_buckets[cost % bucket_count].push_back(from);
+                pending++;
+            }
+        }
+        bucket.clear();
+    }
+}
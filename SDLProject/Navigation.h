@@ -0,0 +1,234 @@
+#pragma once
+#include <vector>
+#include "Map.h"
+#include "Entity.h"
+
+// ————— NAVIGATION ————— //
+// A graph over the Map's tiles for enemies that chase across platforms. A node is an
+// empty tile with a solid tile directly below it: somewhere an entity can stand. Nodes
+// are named by their tile index (tile_y * width + tile_x), so tile edits never renumber
+// anything. Three kinds of link leave a node:
+//
+//     WALK  to the node beside it on the same row
+//     FALL  off a ledge, straight down the neighbouring column until it lands
+//     JUMP  to any node within the mover's jump height and reach whose arc is clear
+//
+// Jump links depend on how high and far a mover can jump, so there is one graph per
+// movement profile; a NavLevel keeps the graphs of every profile its enemies need.
+enum NavLinkType { NAV_WALK, NAV_FALL, NAV_JUMP };
+
+struct NavLink
+{
+    int         node; // the other end of the link
+    NavLinkType type;
+    int         cost;
+};
+
+// How far a mover can jump, in whole tiles
+struct NavProfile
+{
+    int jump_up     = 0, // rows it can climb in one jump
+        jump_across = 0; // columns it covers while in the air
+
+    bool operator==(const NavProfile &other) const
+    {
+        return jump_up == other.jump_up && jump_across == other.jump_across;
+    }
+};
+
+// Derived from the entity's speed, jumping power and (downward) acceleration
+NavProfile make_nav_profile(const Entity &entity, float tile_size);
+NavProfile make_nav_profile(const EntityBody &body, float tile_size);
+
+// Scratch for one search at a time; owned by whoever searches, never by the graph
+struct NavSearch
+{
+    std::vector<int>          cost;
+    std::vector<NavLink>      next;    // first link from a node towards the goal
+    std::vector<unsigned int> stamp,   // cost/next are valid where stamp == current
+                              closed;  // settled where closed == current
+    unsigned int              current = 0;
+    std::vector<std::pair<int, int>> open;    // (estimate, node) min-heap
+    std::vector<int>                 settled; // in the order they were settled
+    bool                             cut_off = false; // gave up at max_expansions with nodes still open
+};
+
+class NavGraph
+{
+private:
+    int        m_width, m_height;
+    NavProfile m_profile;
+
+    std::vector<unsigned char>        m_is_node;
+    std::vector<std::vector<NavLink>> m_out_links, // per tile, empty unless it is a node
+                                      m_in_links;  // the same links, seen from their target
+
+    // Bumped by every patch so path caches know their paths may be stale
+    unsigned int m_version = 0;
+
+    // No link costs more than this (an upper bound once patches have removed links)
+    int m_max_link_cost = 1;
+
+    bool is_solid_tile(const Map &map, int x, int y) const;
+    bool is_clear(const Map &map, int x0, int y0, int x1, int y1) const;
+    void build_links(const Map &map, int node);
+    void rebuild(const Map &map, int x0, int y0, int x1, int y1);
+
+public:
+    // Jumps may also drop onto lower nodes; deeper than this is left to falls
+    static constexpr int MAX_JUMP_DROP = 4;
+
+    NavGraph(const Map &map, NavProfile profile);
+
+    // Brings the graph up to date after the tiles in [x0, x1] x [y0, y1] changed. Only
+    // the nodes whose links could pass through those tiles are rebuilt: a band
+    // jump_across + 1 columns wider on each side, down to jump_up rows below the edit.
+    // The band always starts at the top row, since a fall through the edited tiles may
+    // begin at any height above them, so y0 itself goes unused.
+    void patch(const Map &map, int x0, int y0, int x1, int y1);
+
+    // The node a mover at position stands on, or would land on if it is in the air;
+    // -1 when there is none below it
+    int find_node(const Map &map, glm::vec3 position) const;
+
+    // Searches backwards from goal towards start with A*. Every node the search settles
+    // gets its optimal first link towards goal in search.next, not just start, which
+    // is what makes caching the result worthwhile. Gives up after max_expansions nodes,
+    // setting search.cut_off, so a false return does not always mean start is unreachable.
+    bool search_to(int start, int goal, NavSearch &search, int max_expansions) const;
+
+    bool is_node(int node) const { return node >= 0 && node < m_width * m_height && m_is_node[node]; }
+
+    const std::vector<NavLink> &get_out_links(int node) const { return m_out_links[node]; }
+    const std::vector<NavLink> &get_in_links(int node)  const { return m_in_links[node];  }
+
+    int          const get_node_x(int node) const { return node % m_width; }
+    int          const get_node_y(int node) const { return node / m_width; }
+    NavProfile   const get_profile()        const { return m_profile; }
+    unsigned int const get_version()        const { return m_version; }
+    int          const get_max_link_cost()  const { return m_max_link_cost; }
+    int          const get_node_count()     const { return m_width * m_height; }
+};
+
+// ————— LEVEL ————— //
+// The graphs for one level, one per distinct movement profile. Built once when the
+// level loads and shared read-only by every world that plays it.
+class NavLevel
+{
+private:
+    std::vector<NavGraph> m_graphs;
+
+public:
+    // Makes sure there is a graph for profile and returns its index
+    int add_profile(const Map &map, NavProfile profile);
+
+    // Adds the profile of every chasing (GUARD) enemy
+    void add_enemies(const Map &map, const Entity *enemies, int enemy_count);
+
+    // Index of profile's graph, or -1 if the level has none
+    int find_graph(NavProfile profile) const;
+
+    void patch(const Map &map, int x0, int y0, int x1, int y1);
+
+    const NavGraph &get_graph(int index) const { return m_graphs[index]; }
+    int  const get_graph_count()         const { return (int) m_graphs.size(); }
+};
+
+// ————— PATH CACHE ————— //
+// Answers "which link should I take from here to reach goal?" for one world. Searches
+// run backwards from the goal, so one search fills in the way for every node it
+// settled, and chasers converging on the same player mostly hit the cache. Searches are
+// rationed: at most SEARCHES_PER_TICK per tick, each capped at MAX_EXPANSIONS nodes, so
+// the worst-case cost of a tick does not grow with the number of chasers. A chaser
+// that misses the cache once the ration is spent follows its way to one of the last few
+// goals instead, or failing that walks straight at the player for that tick.
+class NavPlanner
+{
+public:
+    static constexpr int SEARCHES_PER_TICK = 4,
+                         MAX_EXPANSIONS    = 1024,
+                         CACHE_SLOTS       = 4,    // goals remembered at once
+                         CACHE_CAPACITY    = 16384; // nodes remembered per goal
+
+private:
+    // Next links towards one goal in an open-addressed table; a node with an
+    // unreachable goal is stored with link.node == -1. A search cut off at MAX_EXPANSIONS
+    // proves nothing about its start, so that node is left out for a later tick to retry.
+    struct CacheSlot
+    {
+        const NavGraph *graph   = nullptr;
+        unsigned int    version = 0;
+        int             goal    = -1;
+        unsigned int    last_used = 0;
+        int             count   = 0;
+        std::vector<int>     keys;
+        std::vector<NavLink> links;
+    };
+
+    CacheSlot    m_slots[CACHE_SLOTS];
+    NavSearch    m_search;
+    unsigned int m_tick = 0;
+    int          m_searches_left = SEARCHES_PER_TICK;
+
+    int m_search_count = 0, m_hit_count = 0, m_miss_count = 0;
+
+    CacheSlot &get_slot(const NavGraph &graph, int goal);
+    int  probe(const CacheSlot &slot, int node) const;
+    void store(CacheSlot &slot, int node, NavLink link);
+    bool find_recent(const NavGraph &graph, int from, NavLink *link);
+
+public:
+    void begin_tick() { m_tick++; m_searches_left = SEARCHES_PER_TICK; }
+
+    // The link to take from node from towards goal. Returns false if from is goal, if goal
+    // cannot be reached, or if finding out would need a search this tick cannot afford.
+    bool next_link(const NavGraph &graph, int from, int goal, NavLink *link);
+
+    int const get_search_count() const { return m_search_count; }
+    int const get_hit_count()    const { return m_hit_count;    }
+    int const get_miss_count()   const { return m_miss_count;   }
+    void reset_counts() { m_search_count = m_hit_count = m_miss_count = 0; }
+};
+
+// ————— FLOW FIELD ————— //
+// Distance to one goal, and the first link towards it, for every node of a graph at
+// once. Made for many chasers after one player: the field is only rebuilt when the
+// goal moves to another node (or the graph is patched), and reading a chaser's next
+// move is then a single lookup however many chasers there are. A rebuild is one
+// backwards Dijkstra over the whole graph with a bucket queue, since link costs are
+// small integers.
+class FlowField
+{
+private:
+    const NavGraph *m_graph   = nullptr;
+    unsigned int    m_version = 0;
+    int             m_goal    = -1;
+
+    std::vector<int>     m_distance;
+    std::vector<NavLink> m_next;
+
+    // Bucket i % size holds the nodes at tentative distance i; kept between rebuilds
+    std::vector<std::vector<int>> m_buckets;
+
+    int m_rebuild_count = 0;
+
+    void rebuild();
+
+public:
+    static constexpr int UNREACHABLE = -1;
+
+    // Points the field at goal on graph, rebuilding it only if either changed
+    void update(const NavGraph &graph, int goal);
+
+    // The link to take from node towards the goal; false at the goal or when it can't be reached
+    bool next_link(int node, NavLink *link) const
+    {
+        if (m_distance[node] <= 0) return false;
+        *link = m_next[node];
+        return true;
+    }
+
+    int const get_distance(int node)  const { return m_distance[node]; }
+    int const get_goal()              const { return m_goal;           }
+    int const get_rebuild_count()     const { return m_rebuild_count;  }
+};
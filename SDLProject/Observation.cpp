@@ -0,0 +1,114 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "Observation.h"
+
+ObservationBuilder::ObservationBuilder(int env_count) : m_caches(env_count) { }
+
+void ObservationBuilder::invalidate()
+{
+    for (Cache &cache : m_caches) cache.block = nullptr;
+}
+
+void ObservationBuilder::write_solid_plane(float *block, const Map *map, int origin_x, int origin_y) const
+{
+    const unsigned int *level_data = map->get_level_data();
+    float *plane = block + OBS_SOLID * PLANE_SIZE;
+
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+    {
+        int tile_y = origin_y + y;
+        float *row = plane + y * VIEW_WIDTH;
+
+        // Rows above or below the map are open space
+        if (tile_y < 0 || tile_y >= map->get_height())
+        {
+            for (int x = 0; x < VIEW_WIDTH; x++) row[x] = 0.0f;
+            continue;
+        }
+
+        const unsigned int *tiles = level_data + tile_y * map->get_width();
+        for (int x = 0; x < VIEW_WIDTH; x++)
+        {
+            int tile_x = origin_x + x;
+            row[x] = (tile_x >= 0 && tile_x < map->get_width() && tiles[tile_x] != 0) ? 1.0f : 0.0f;
+        }
+    }
+}
+
+void ObservationBuilder::build(int env_index, const World &world, const Map *map, float *block)
+{
+    assert((uintptr_t) block % OBSERVATION_ALIGNMENT == 0);
+
+    Cache &cache = m_caches[env_index];
+    const Entity &player = world.player;
+    glm::vec3 player_position = player.get_position();
+
+    // The player always sits in the centre cell
+    int player_tile_x = map->get_tile_x(player_position.x);
+    int player_tile_y = map->get_tile_y(player_position.y);
+    int origin_x = player_tile_x - VIEW_WIDTH / 2;
+    int origin_y = player_tile_y - VIEW_HEIGHT / 2;
+
+    // A block we have never written (or lost track of) gets a full build; otherwise
+    // we only patch what moved since the last build into this same block, and the tiles
+    // again if the view moved or the map was edited
+    if (cache.block != block)
+    {
+        memset(block, 0, FLOATS_PER_ENV * sizeof(float));
+        cache.dynamic_count = 0;
+        write_solid_plane(block, map, origin_x, origin_y);
+    }
+    else if (origin_x != cache.origin_x || origin_y != cache.origin_y || map->get_edit_count() != cache.map_edits)
+    {
+        write_solid_plane(block, map, origin_x, origin_y);
+    }
+
+    // ————— ENEMIES AND PROJECTILES ————— //
+    for (int i = 0; i < cache.dynamic_count; i++) block[cache.dynamic_cells[i]] = 0.0f;
+    cache.dynamic_count = 0;
+
+    for (const Entity &enemy : world.enemies)
+    {
+        int grid_x = map->get_tile_x(enemy.get_position().x) - origin_x;
+        int grid_y = map->get_tile_y(enemy.get_position().y) - origin_y;
+        if (grid_x >= 0 && grid_x < VIEW_WIDTH && grid_y >= 0 && grid_y < VIEW_HEIGHT)
+        {
+            int cell = OBS_ENEMY * PLANE_SIZE + grid_y * VIEW_WIDTH + grid_x;
+            block[cell] = 1.0f;
+            cache.dynamic_cells[cache.dynamic_count++] = cell;
+        }
+    }
+
+    for (int i = 0; i < world.projectiles.get_count(); i++)
+    {
+        glm::vec3 position = world.projectiles.get_position(i);
+        int grid_x = map->get_tile_x(position.x) - origin_x;
+        int grid_y = map->get_tile_y(position.y) - origin_y;
+        if (grid_x >= 0 && grid_x < VIEW_WIDTH && grid_y >= 0 && grid_y < VIEW_HEIGHT)
+        {
+            int cell = OBS_PROJECTILE * PLANE_SIZE + grid_y * VIEW_WIDTH + grid_x;
+            block[cell] = 1.0f;
+            cache.dynamic_cells[cache.dynamic_count++] = cell;
+        }
+    }
+
+    // ————— PLAYER STATE ————— //
+    // Everything the grid cannot show: sub-tile offset, velocity, contact and progress
+    float tile_size = map->get_tile_size();
+    float *state = block + CHANNEL_COUNT * PLANE_SIZE;
+
+    state[0] = player_position.x / tile_size - player_tile_x;
+    state[1] = -player_position.y / tile_size - player_tile_y;
+    state[2] = player.get_velocity().x / (player.get_speed() > 0.0f ? player.get_speed() : 1.0f);
+    state[3] = player.get_velocity().y / 10.0f;
+    state[4] = player.get_collided_bottom() ? 1.0f : 0.0f;
+    state[5] = (float) (ENEMY_COUNT - world.enemies_defeated) / ENEMY_COUNT;
+    state[6] = (float) player_tile_x / map->get_width();
+    state[7] = (float) player_tile_y / map->get_height();
+
+    cache.block     = block;
+    cache.origin_x  = origin_x;
+    cache.origin_y  = origin_y;
+    cache.map_edits = map->get_edit_count();
+}
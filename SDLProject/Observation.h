@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "World.h"
+
+// ————— OBSERVATIONS ————— //
+// Builds an egocentric, multi-channel tile grid around the player for learning agents.
+// Each world's observation is one contiguous block of FLOATS_PER_ENV floats laid out as
+//
+//     [CHANNEL_COUNT][VIEW_HEIGHT][VIEW_WIDTH] grid, then STATE_SIZE player-state floats
+//
+// padded so that every block starts on a 64-byte boundary when the buffer itself does.
+// The builder never allocates after construction: it writes straight into the caller's
+// buffer and only rewrites cells that changed since the previous build into that buffer.
+enum ObservationChannel { OBS_SOLID, OBS_ENEMY, OBS_PROJECTILE, OBS_CHANNEL_COUNT };
+
+class ObservationBuilder
+{
+public:
+    static constexpr int VIEW_WIDTH    = 15,
+                         VIEW_HEIGHT   = 9,
+                         PLANE_SIZE    = VIEW_WIDTH * VIEW_HEIGHT,
+                         CHANNEL_COUNT = OBS_CHANNEL_COUNT,
+                         STATE_SIZE    = 8;
+
+    static constexpr int OBSERVATION_ALIGNMENT = 64; // bytes
+    static constexpr int FLOATS_PER_ENV =
+        (CHANNEL_COUNT * PLANE_SIZE + STATE_SIZE + 15) / 16 * 16;
+
+private:
+    // Enemies and their projectiles are the only things that move between tiles
+    static constexpr int MAX_DYNAMIC_CELLS = ENEMY_COUNT + World::PROJECTILE_CAPACITY;
+
+    // What was last written for one world, so the next build can be a patch
+    struct Cache
+    {
+        const float *block = nullptr;    // block this world was last written to
+        int origin_x = 0, origin_y = 0;  // map tile at the grid's top-left corner
+        unsigned int map_edits = 0;      // the map's edit count when its tiles were copied
+        int dynamic_count = 0;
+        int dynamic_cells[MAX_DYNAMIC_CELLS]; // offsets into the block
+    };
+
+    std::vector<Cache> m_caches;
+
+    void write_solid_plane(float *block, const Map *map, int origin_x, int origin_y) const;
+
+public:
+    ObservationBuilder(int env_count);
+
+    // Writes world's observation into block, which must hold FLOATS_PER_ENV floats and
+    // be OBSERVATION_ALIGNMENT-aligned. Only one thread may build a given env_index.
+    void build(int env_index, const World &world, const Map *map, float *block);
+
+    // Forgets what is in the buffers, e.g. after switching to another map. Tiles changed
+    // through Map::set_tile() need no call: the next build sees the map's edit count move.
+    void invalidate();
+    void invalidate(int env_index) { m_caches[env_index].block = nullptr; }
+};
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include "Particles.h"
+#include "Float4.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
+
+typedef std::chrono::steady_clock ParticleClock;
+
+static double milliseconds_since(ParticleClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(ParticleClock::now() - start).count();
+}
+
+constexpr int ParticleSystem::MAX_STYLES;
+
+ParticleSystem::ParticleSystem(int capacity) : m_capacity(capacity), m_budget(capacity),
+    m_x(capacity), m_y(capacity), m_velocity_x(capacity), m_velocity_y(capacity),
+    m_life(capacity), m_shrink(capacity), m_gravity(capacity), m_drag(capacity), m_style(capacity)
+{
+    for (int i = 0; i < MAX_STYLES; i++) set_style(i, ParticleStyle());
+}
+
+void ParticleSystem::set_style(int index, const ParticleStyle &style)
+{
+    m_styles[index] = style;
+
+    // Styles that share a texture share a draw
+    m_batch_count = 0;
+    for (int i = 0; i < MAX_STYLES; i++)
+    {
+        int batch = 0;
+        while (batch < m_batch_count && m_batch_textures[batch] != m_styles[i].texture) batch++;
+        if (batch == m_batch_count) m_batch_textures[m_batch_count++] = m_styles[i].texture;
+        m_style_batch[i] = batch;
+    }
+}
+
+void ParticleSystem::set_budget(int budget)
+{
+    m_budget = std::max(0, std::min(budget, m_capacity));
+}
+
+void ParticleSystem::reset_stats()
+{
+    m_stats = ParticleStats();
+    m_stats.count = m_count;
+}
+
+float ParticleSystem::next_random()
+{
+    m_seed = m_seed * 1664525u + 1013904223u;
+    return (m_seed >> 8) / 16777216.0f;
+}
+
+int ParticleSystem::emit(int style, glm::vec3 position, glm::vec3 velocity, float spread, int count)
+{
+    const ParticleStyle &look = m_styles[style];
+
+    int room    = std::max(0, m_budget - m_count);
+    int emitted = std::min(count, room);
+    m_stats.dropped += count - emitted;
+
+    for (int n = 0; n < emitted; n++)
+    {
+        // A random direction, and a random fraction of the spread, biased outwards
+        float angle = next_random() * 6.2831853f, push = spread * sqrtf(next_random());
+        float life  = look.lifetime * (0.5f + 0.5f * next_random());
+
+        int i = m_count++;
+        m_x[i]          = position.x;
+        m_y[i]          = position.y;
+        m_velocity_x[i] = velocity.x + cosf(angle) * push;
+        m_velocity_y[i] = velocity.y + sinf(angle) * push;
+        m_life[i]       = life;
+        m_shrink[i]     = look.size / 2.0f / life;
+        m_gravity[i]    = look.gravity;
+        m_drag[i]       = look.drag;
+        m_style[i]      = (unsigned char) style;
+    }
+    return emitted;
+}
+
+// The last particle takes the removed one's slot; order among particles carries no meaning
+void ParticleSystem::remove(int index)
+{
+    int last = --m_count;
+    m_x[index]          = m_x[last];
+    m_y[index]          = m_y[last];
+    m_velocity_x[index] = m_velocity_x[last];
+    m_velocity_y[index] = m_velocity_y[last];
+    m_life[index]       = m_life[last];
+    m_shrink[index]     = m_shrink[last];
+    m_gravity[index]    = m_gravity[last];
+    m_drag[index]       = m_drag[last];
+    m_style[index]      = m_style[last];
+}
+
+void ParticleSystem::update(float delta_time)
+{
+    ParticleClock::time_point start = ParticleClock::now();
+
+    // ————— INTEGRATION ————— //
+    // Velocity first (gravity, then drag), then position, as Entity::update orders them
+    float *x = m_x.data(), *y = m_y.data(), *velocity_x = m_velocity_x.data(), *velocity_y = m_velocity_y.data(),
+          *life = m_life.data();
+    const float *gravity = m_gravity.data(), *drag = m_drag.data();
+
+    int i = 0;
+#ifdef FLOAT4_LANES
+    float4 step = splat4(delta_time), one = splat4(1.0f);
+    for (; i + FLOAT4_LANES <= m_count; i += FLOAT4_LANES)
+    {
+        float4 keep = sub4(one, mul4(load4(drag + i), step));
+        float4 vx   = mul4(load4(velocity_x + i), keep);
+        float4 vy   = mul4(add4(load4(velocity_y + i), mul4(load4(gravity + i), step)), keep);
+
+        store4(velocity_x + i, vx);
+        store4(velocity_y + i, vy);
+        store4(x + i, add4(load4(x + i), mul4(vx, step)));
+        store4(y + i, add4(load4(y + i), mul4(vy, step)));
+        store4(life + i, sub4(load4(life + i), step));
+    }
+#endif
+    for (; i < m_count; i++)
+    {
+        float keep = 1.0f - drag[i] * delta_time;
+        velocity_x[i] = velocity_x[i] * keep;
+        velocity_y[i] = (velocity_y[i] + gravity[i] * delta_time) * keep;
+        x[i]         += velocity_x[i] * delta_time;
+        y[i]         += velocity_y[i] * delta_time;
+        life[i]      -= delta_time;
+    }
+
+    // ————— EXPIRY ————— //
+    // Whole groups of four still alive are skipped at once, as ProjectilePool culls
+#ifdef FLOAT4_LANES
+    float4 zero = splat4(0.0f);
+#endif
+    i = 0;
+    while (i < m_count)
+    {
+#ifdef FLOAT4_LANES
+        if (i + FLOAT4_LANES <= m_count && greater4(load4(life + i), zero) == 0xF) { i += FLOAT4_LANES; continue; }
+#endif
+        if (life[i] <= 0.0f) remove(i);
+        else i++;
+    }
+
+    m_stats.count          = m_count;
+    m_stats.peak_count     = std::max(m_stats.peak_count, m_count);
+    m_stats.update_ms      = milliseconds_since(start);
+    m_stats.peak_update_ms = std::max(m_stats.peak_update_ms, m_stats.update_ms);
+}
+
+void ParticleSystem::write_quad(int index, int slot, float *vertices, float *texture_coordinates) const
+{
+    const ParticleStyle &look = m_styles[m_style[index]];
+    float half = m_life[index] * m_shrink[index];
+
+    float left = m_x[index] - half, right = m_x[index] + half, bottom = m_y[index] - half, top = m_y[index] + half;
+    float quad[] = {
+        left, bottom, right, bottom, right, top,
+        left, bottom, right, top,    left,  top
+    };
+
+    // The frame's top edge is at uv.y, as in Entity::draw_sprite_from_texture_atlas
+    float u0 = look.uv.x, u1 = look.uv.x + look.uv.z, v0 = look.uv.y, v1 = look.uv.y + look.uv.w;
+    float texels[] = {
+        u0, v1, u1, v1, u1, v0,
+        u0, v1, u1, v0, u0, v0
+    };
+
+    for (int k = 0; k < 12; k++)
+    {
+        vertices[slot * 12 + k]            = quad[k];
+        texture_coordinates[slot * 12 + k] = texels[k];
+    }
+}
+
+// Below this many particles, handing chunks to other threads costs more than it saves
+static const int PARALLEL_QUAD_MIN = 1024;
+static const int MAX_QUAD_CHUNKS   = 64;
+
+int ParticleSystem::write_quads(float *vertices, float *texture_coordinates, int *first, JobSystem *jobs) const
+{
+    // Each chunk of particles counts its quads per texture, so that every chunk knows where
+    // in each batch its own quads start: the same slots a single pass in order would give
+    int chunk_count = 1;
+    if (jobs != nullptr && m_count >= PARALLEL_QUAD_MIN)
+        chunk_count = std::min(jobs->get_thread_count() * 2, MAX_QUAD_CHUNKS);
+
+    int counts[MAX_QUAD_CHUNKS][MAX_STYLES] = {};
+    auto chunk_begin = [&](int chunk) { return (int) ((long long) m_count * chunk / chunk_count); };
+    auto count_chunk = [&](int chunk) {
+        for (int i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++) counts[chunk][m_style_batch[m_style[i]]]++;
+    };
+
+    if (chunk_count == 1) count_chunk(0);
+    else jobs->parallel_for(chunk_count, 1, [&](int begin, int end) { for (int c = begin; c < end; c++) count_chunk(c); });
+
+    // Batches in order, and within each batch the chunks in order
+    int cursor[MAX_QUAD_CHUNKS][MAX_STYLES];
+    int slot = 0;
+    for (int batch = 0; batch < m_batch_count; batch++)
+    {
+        first[batch] = slot;
+        for (int chunk = 0; chunk < chunk_count; chunk++)
+        {
+            cursor[chunk][batch] = slot;
+            slot += counts[chunk][batch];
+        }
+    }
+    first[m_batch_count] = m_count;
+
+    auto write_chunk = [&](int chunk) {
+        int *next = cursor[chunk];
+        for (int i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++)
+            write_quad(i, next[m_style_batch[m_style[i]]]++, vertices, texture_coordinates);
+    };
+
+    if (chunk_count == 1) write_chunk(0);
+    else jobs->parallel_for(chunk_count, 1, [&](int begin, int end) { for (int c = begin; c < end; c++) write_chunk(c); });
+    return m_batch_count;
+}
+
+void ParticleSystem::render(ShaderProgram *program, JobSystem *jobs)
+{
+    m_stats.draw_calls = 0;
+    if (m_count == 0) { m_stats.render_ms = 0.0; return; }
+
+    ParticleClock::time_point start = ParticleClock::now();
+
+    m_vertices.resize((size_t) m_capacity * 12);
+    m_texture_coordinates.resize((size_t) m_capacity * 12);
+
+    int first[MAX_STYLES + 1];
+    int batch_count = write_quads(m_vertices.data(), m_texture_coordinates.data(), first, jobs);
+
+    program->set_model_matrix(glm::mat4(1.0f));
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    for (int batch = 0; batch < batch_count; batch++)
+    {
+        int quads = first[batch + 1] - first[batch];
+        if (quads == 0) continue;
+
+        glBindTexture(GL_TEXTURE_2D, m_batch_textures[batch]);
+        glDrawArrays(GL_TRIANGLES, first[batch] * 6, quads * 6);
+        m_stats.draw_calls++;
+    }
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    m_stats.render_ms      = milliseconds_since(start);
+    m_stats.peak_render_ms = std::max(m_stats.peak_render_ms, m_stats.render_ms);
+}
+
+void ParticleSystem::snapshot(RenderSnapshot *snapshot, JobSystem *jobs)
+{
+    m_stats.draw_calls = 0;
+    if (m_count == 0) { m_stats.render_ms = 0.0; return; }
+
+    ParticleClock::time_point start = ParticleClock::now();
+
+    int base = snapshot->add_quads(m_count);
+    int first[MAX_STYLES + 1];
+    int batch_count = write_quads(snapshot->get_quad_vertices(base), snapshot->get_quad_texture_coordinates(base),
+                                  first, jobs);
+
+    for (int batch = 0; batch < batch_count; batch++)
+    {
+        int quads = first[batch + 1] - first[batch];
+        if (quads == 0) continue;
+
+        snapshot->add_batch(m_batch_textures[batch], base + first[batch], quads);
+        m_stats.draw_calls++;
+    }
+
+    m_stats.render_ms      = milliseconds_since(start);
+    m_stats.peak_render_ms = std::max(m_stats.peak_render_ms, m_stats.render_ms);
+}
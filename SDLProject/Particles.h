@@ -0,0 +1,116 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <vector>
+#include <SDL_opengl.h>
+#include "glm/glm.hpp"
+#include "ShaderProgram.h"
+
+class JobSystem;
+struct RenderSnapshot;
+
+// ————— PARTICLES ————— //
+// Sparks, dust and debris: short-lived quads that only ever fly, fall and shrink away, so
+// none of them is an Entity. They live in one fixed-size pool of parallel arrays, like
+// ProjectilePool, and a tick updates them all in one streaming pass, four at a time
+// where SSE2 or NEON is available. A particle whose life runs out is removed by moving
+// the last one into its slot.
+//
+// Each particle is drawn with one of a few styles, and render() issues one draw per
+// texture the styles use, however many particles there are. Effects are cosmetic: they
+// never feed back into a World, so headless worlds simply have none.
+struct ParticleStyle
+{
+    GLuint    texture  = 0;
+    glm::vec4 uv       = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // (u, v, width, height) in texture
+    float     size     = 0.1f;  // quad side at birth, in world units; it shrinks to 0 at death
+    float     lifetime = 0.5f;  // seconds
+    float     gravity  = 0.0f;  // vertical acceleration, in world units per second squared
+    float     drag     = 0.0f;  // fraction of its speed a particle loses per second
+};
+
+// What the pool cost over its last update() and render(), and how busy it was
+struct ParticleStats
+{
+    int    count         = 0;    // alive after the last update()
+    int    peak_count    = 0;
+    int    dropped       = 0;    // emitted while at the budget, since the last reset_stats()
+    int    draw_calls    = 0;    // in the last render()
+    double update_ms     = 0.0,
+           render_ms     = 0.0;  // building the quads and issuing the draws
+    double peak_update_ms = 0.0,
+           peak_render_ms = 0.0;
+};
+
+class ParticleSystem
+{
+public:
+    static constexpr int MAX_STYLES = 8;
+
+private:
+    int m_capacity;
+    int m_budget;
+    int m_count = 0;
+
+    std::vector<float>         m_x, m_y, m_velocity_x, m_velocity_y;
+    std::vector<float>         m_life;    // seconds left
+    std::vector<float>         m_shrink;  // half the quad side per second of life left
+    std::vector<float>         m_gravity, m_drag;
+    std::vector<unsigned char> m_style;
+
+    ParticleStyle m_styles[MAX_STYLES];
+    int           m_style_batch[MAX_STYLES]; // which of the distinct textures each style uses
+    GLuint        m_batch_textures[MAX_STYLES];
+    int           m_batch_count = 0;
+
+    unsigned int  m_seed = 12345u; // emit()'s own generator, so effects never touch rand()
+    ParticleStats m_stats;
+
+    std::vector<float> m_vertices, m_texture_coordinates;
+
+    void  remove(int index);
+    float next_random(); // uniform in [0, 1)
+    void  write_quad(int index, int slot, float *vertices, float *texture_coordinates) const;
+
+public:
+    explicit ParticleSystem(int capacity);
+
+    void set_style(int index, const ParticleStyle &style);
+
+    // No more than budget particles are alive at once (at most the capacity); emits past
+    // it are dropped and counted, so a burst of effects can't blow the frame
+    void set_budget(int budget);
+
+    // Adds count particles of style at position, each moving at velocity plus a random
+    // push of up to spread in any direction. Returns how many fitted in the budget.
+    int emit(int style, glm::vec3 position, glm::vec3 velocity, float spread, int count);
+
+    // Ages, accelerates and moves every particle, then removes those whose life is over
+    void update(float delta_time);
+
+    // Draws every particle, one glDrawArrays per distinct texture. With jobs, large counts
+    // have their quads written on all of its threads (the draws stay on this one).
+    void render(ShaderProgram *program, JobSystem *jobs = nullptr);
+
+    // Adds every particle to snapshot, one batch of quads per distinct texture, for the
+    // render thread to draw. Counts as the pool's render() in its stats.
+    void snapshot(RenderSnapshot *snapshot, JobSystem *jobs = nullptr);
+
+    // Writes 12 position and 12 texture floats per particle (two triangles), those of each
+    // texture together: batch b's first quad is at first[b]. Returns the batch count. The
+    // quads come out the same with or without jobs.
+    int write_quads(float *vertices, float *texture_coordinates, int *first, JobSystem *jobs = nullptr) const;
+
+    void clear() { m_count = 0; }
+    void reset_stats();
+
+    const ParticleStats &get_stats() const { return m_stats; }
+
+    int   const get_count()    const { return m_count;    }
+    int   const get_budget()   const { return m_budget;   }
+    int   const get_capacity() const { return m_capacity; }
+    glm::vec3 const get_position(int index) const { return glm::vec3(m_x[index], m_y[index], 0.0f); }
+};
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "PartitionedWorld.h"
+#include "JobSystem.h"
+
+constexpr float PartitionedWorld::DEFAULT_STRIP_WIDTH;
+constexpr float PartitionedWorld::DEFAULT_HALO_WIDTH;
+
+PartitionedWorld::PartitionedWorld(Map *map, const NavLevel *nav, const StaticColliders *statics, float strip_width,
+                                   float halo_width) :
+    m_map(map), m_nav(nav), m_statics(statics), m_strip_width(strip_width), m_halo_width(halo_width)
+{
+    assert(halo_width <= strip_width);
+
+    float left  = map->get_left_bound(),
+          width = map->get_right_bound() - left;
+    int strip_count = std::max(1, (int) std::ceil(width / strip_width));
+
+    m_strips.resize(strip_count);
+    for (int strip = 0; strip < strip_count; strip++)
+    {
+        m_strips[strip].left  = left + strip * strip_width;
+        m_strips[strip].right = left + (strip + 1) * strip_width;
+    }
+
+    if (m_nav != nullptr) m_flow_fields.resize(m_nav->get_graph_count());
+}
+
+// Anything off either end of the map belongs to the strip at that end
+int PartitionedWorld::get_strip_at(float x) const
+{
+    int strip = (int) std::floor((x - m_strips[0].left) / m_strip_width);
+    return std::min(std::max(strip, 0), (int) m_strips.size() - 1);
+}
+
+int PartitionedWorld::add_enemy(const Entity &enemy)
+{
+    int id    = (int) m_locations.size();
+    int strip = get_strip_at(enemy.get_position().x);
+
+    // Ids only grow, so the list stays in order; the halos need redoing though
+    Strip &self = m_strips[strip];
+    self.owned.add(enemy, id);
+    self.next.push_back(glm::vec2(enemy.get_position()));
+
+    Location location;
+    location.strip = strip;
+    location.index = self.owned.get_count() - 1;
+    m_locations.push_back(location);
+
+    for (int s = std::max(strip - 1, 0); s <= std::min(strip + 1, (int) m_strips.size() - 1); s++) build_halo(s);
+    return id;
+}
+
+int const PartitionedWorld::get_handoff_count() const
+{
+    int count = 0;
+    for (const Strip &strip : m_strips) count += strip.handed_in;
+    return count;
+}
+
+// ————— TICK ————— //
+template <typename Phase>
+void PartitionedWorld::for_each_strip(JobSystem *jobs, Phase phase)
+{
+    int strip_count = (int) m_strips.size();
+    if (jobs == nullptr)
+    {
+        for (int strip = 0; strip < strip_count; strip++) phase(strip);
+        return;
+    }
+    jobs->parallel_for(strip_count, 1, [&phase](int begin, int end) {
+        for (int strip = begin; strip < end; strip++) phase(strip);
+    });
+}
+
+// Each graph's field pointed at the player's node; guards only read them from here on
+void PartitionedWorld::update_flow_fields(const Entity &player)
+{
+    for (int graph = 0; graph < (int) m_flow_fields.size(); graph++)
+    {
+        const NavGraph &nav_graph = m_nav->get_graph(graph);
+        int goal = nav_graph.find_node(*m_map, player.get_position());
+        if (goal >= 0) m_flow_fields[graph].update(nav_graph, goal);
+    }
+}
+
+void PartitionedWorld::run_ai(Entity &enemy, const Entity &player)
+{
+    if (!enemy.is_active()) return;
+
+    AIContext context(player, m_map, m_nav, nullptr);
+    if (!m_flow_fields.empty()) context.flow_fields = m_flow_fields.data();
+
+    AIAgent agent(enemy);
+    run_ai_agent(agent, context);
+}
+
+// The strip's enemies in id order, each through all of World::update's movement phases at
+// once
+void PartitionedWorld::step_strip(int strip, float delta_time, const Entity &player)
+{
+    Strip &self = m_strips[strip];
+    for (int i = 0; i < self.owned.get_count(); i++)
+    {
+        Entity &enemy = self.owned.enemies[i];
+        run_ai(enemy, player);
+        self.next[i] = enemy.integrate(delta_time);
+        enemy.resolve(self.next[i], delta_time, nullptr, 0, m_map, m_statics);
+    }
+    find_leavers(strip);
+}
+
+// Moves whichever of the strip's enemies are now in another out, for take_arrivals()
+void PartitionedWorld::find_leavers(int strip)
+{
+    Strip &self = m_strips[strip];
+    self.leaving.clear();
+    self.leaving_to.clear();
+
+    int kept = 0;
+    for (int i = 0; i < self.owned.get_count(); i++)
+    {
+        int owner = get_strip_at(self.owned.enemies[i].get_position().x);
+        if (owner != strip)
+        {
+            self.leaving.add(self.owned.enemies[i], self.owned.ids[i]);
+            self.leaving_to.push_back(owner);
+            continue;
+        }
+        if (kept != i)
+        {
+            self.owned.enemies[kept] = self.owned.enemies[i];
+            self.owned.ids[kept]     = self.owned.ids[i];
+        }
+        kept++;
+    }
+    self.owned.enemies.resize(kept);
+    self.owned.ids.resize(kept);
+}
+
+// Every strip's leavers that are now this one's, merged into its own by id. Only reads the
+// other strips' leaving lists, which nothing writes in this phase, and only writes the
+// locations of its own ids.
+void PartitionedWorld::take_arrivals(int strip)
+{
+    Strip &self = m_strips[strip];
+
+    self.arrivals.clear();
+    for (int other = 0; other < (int) m_strips.size(); other++)
+    {
+        if (other == strip) continue;
+        for (int k = 0; k < m_strips[other].leaving.get_count(); k++)
+        {
+            if (m_strips[other].leaving_to[k] != strip) continue;
+            Location arrival;
+            arrival.strip = other;
+            arrival.index = k;
+            self.arrivals.push_back(arrival);
+        }
+    }
+    self.handed_in = (int) self.arrivals.size();
+
+    if (!self.arrivals.empty())
+    {
+        auto arrival_id = [this](const Location &arrival) {
+            return m_strips[arrival.strip].leaving.ids[arrival.index];
+        };
+        std::sort(self.arrivals.begin(), self.arrivals.end(), [&](const Location &a, const Location &b) {
+            return arrival_id(a) < arrival_id(b);
+        });
+
+        self.merged.clear();
+        int i = 0;
+        for (const Location &arrival : self.arrivals)
+        {
+            int id = arrival_id(arrival);
+            for (; i < self.owned.get_count() && self.owned.ids[i] < id; i++)
+                self.merged.add(self.owned.enemies[i], self.owned.ids[i]);
+            self.merged.add(m_strips[arrival.strip].leaving.enemies[arrival.index], id);
+        }
+        for (; i < self.owned.get_count(); i++) self.merged.add(self.owned.enemies[i], self.owned.ids[i]);
+
+        std::swap(self.owned, self.merged);
+    }
+
+    self.next.resize(self.owned.get_count());
+    for (int i = 0; i < self.owned.get_count(); i++)
+    {
+        m_locations[self.owned.ids[i]].strip = strip;
+        m_locations[self.owned.ids[i]].index = i;
+    }
+}
+
+// Copies of the neighbours' enemies within the halo width of this strip's edges. A halo
+// is no wider than a strip, so only the strips either side can have any.
+void PartitionedWorld::build_halo(int strip)
+{
+    Strip &self = m_strips[strip];
+    self.halo.clear();
+
+    if (strip > 0)
+    {
+        const EnemyList &left = m_strips[strip - 1].owned;
+        for (int i = 0; i < left.get_count(); i++)
+            if (left.enemies[i].get_position().x >= self.left - m_halo_width) self.halo.add(left.enemies[i], left.ids[i]);
+    }
+    if (strip + 1 < (int) m_strips.size())
+    {
+        const EnemyList &right = m_strips[strip + 1].owned;
+        for (int i = 0; i < right.get_count(); i++)
+            if (right.enemies[i].get_position().x < self.right + m_halo_width) self.halo.add(right.enemies[i], right.ids[i]);
+    }
+}
+
+void PartitionedWorld::tick(float delta_time, const Entity &player, JobSystem *jobs)
+{
+    update_flow_fields(player);
+
+    for_each_strip(jobs, [&](int strip) { step_strip(strip, delta_time, player); });
+    for_each_strip(jobs, [&](int strip) { take_arrivals(strip); });
+    for_each_strip(jobs, [&](int strip) { build_halo(strip); });
+}
+
+void PartitionedWorld::tick_serial(float delta_time, const Entity &player)
+{
+    update_flow_fields(player);
+
+    int count = get_enemy_count();
+    for (int id = 0; id < count; id++)
+    {
+        Strip &strip = m_strips[m_locations[id].strip];
+        run_ai(strip.owned.enemies[m_locations[id].index], player);
+    }
+    for (int id = 0; id < count; id++)
+    {
+        Strip &strip = m_strips[m_locations[id].strip];
+        int index = m_locations[id].index;
+        strip.next[index] = strip.owned.enemies[index].integrate(delta_time);
+    }
+    for (int id = 0; id < count; id++)
+    {
+        Strip &strip = m_strips[m_locations[id].strip];
+        int index = m_locations[id].index;
+        strip.owned.enemies[index].resolve(strip.next[index], delta_time, nullptr, 0, m_map, m_statics);
+    }
+
+    // The strips still follow their enemies, so that either kind of tick can come next
+    for_each_strip(nullptr, [&](int strip) { find_leavers(strip); });
+    for_each_strip(nullptr, [&](int strip) { take_arrivals(strip); });
+    for_each_strip(nullptr, [&](int strip) { build_halo(strip); });
+}
+
+// ————— CONTACTS ————— //
+// The same test as World's broadphase and narrow phase together
+bool PartitionedWorld::touches(const Entity &enemy, const Entity &player, glm::vec2 player_reach) const
+{
+    if (!enemy.is_active()) return false;
+
+    glm::vec2 distance = glm::abs(glm::vec2(enemy.get_position() - player.get_position()));
+    glm::vec2 reach    = player_reach + get_contact_reach(enemy);
+    if (distance.x >= reach.x || distance.y >= reach.y) return false;
+
+    return player.check_sprite_collision(&enemy);
+}
+
+const std::vector<int> &PartitionedWorld::find_contacts(const Entity &player)
+{
+    m_contacts.clear();
+
+    glm::vec2 player_reach = get_contact_reach(player);
+    const Strip &strip = m_strips[get_strip_at(player.get_position().x)];
+
+    for (int i = 0; i < strip.owned.get_count(); i++)
+        if (touches(strip.owned.enemies[i], player, player_reach)) m_contacts.push_back(strip.owned.ids[i]);
+    for (int i = 0; i < strip.halo.get_count(); i++)
+        if (touches(strip.halo.enemies[i], player, player_reach)) m_contacts.push_back(strip.halo.ids[i]);
+
+    std::sort(m_contacts.begin(), m_contacts.end());
+    return m_contacts;
+}
+
+const std::vector<int> &PartitionedWorld::find_contacts_serial(const Entity &player)
+{
+    m_contacts.clear();
+
+    glm::vec2 player_reach = get_contact_reach(player);
+    for (int id = 0; id < get_enemy_count(); id++)
+        if (touches(get_enemy(id), player, player_reach)) m_contacts.push_back(id);
+    return m_contacts;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include "World.h"
+
+class JobSystem;
+
+// ————— PARTITIONED WORLD ————— //
+// The enemies of one level far larger than the game's, tens of thousands of them, stepped
+// by vertical strips of the map. Each strip keeps the enemies whose x falls inside it in
+// arrays of its own, in id order, and steps them on a thread of its own. A strip writes to
+// nothing but its own arrays, and reads nothing another strip writes in the same phase,
+// so no two threads ever touch the same enemy, and each walks memory of its own.
+//
+// Stepping an enemy reads only itself, the player (as the tick found it) and the level, so
+// where and in what order enemies are stepped cannot change what becomes of them: a tick
+// leaves every enemy exactly as tick_serial(), which runs World::update's AI, integrate and
+// resolve passes over them all in id order, would. Replays recorded either way agree.
+//
+// After moving, an enemy that has left its strip is handed to the strip it is now in:
+// every strip moves its leavers out, then takes in whichever of every strip's leavers are
+// now its own, keeping id order, so the arrays come out the same whatever thread did what.
+// Each strip also keeps a halo, copies of its neighbours' enemies within halo_width of its
+// edges as the last tick left them, so that anything asking about the enemies near a
+// point (find_contacts()) needs only the one strip the point is in.
+//
+// Guards chase by flow field, brought up to date for the player once per tick before the
+// strips start, and only read by them after that. Per-tick searches and shots are the
+// whole world's to share, so these enemies get neither: a guard without a graph that
+// fits it stands still, and shooters hold fire.
+class PartitionedWorld
+{
+public:
+    static constexpr float DEFAULT_STRIP_WIDTH = 32.0f, // world units
+                           DEFAULT_HALO_WIDTH  = 2.0f;
+
+private:
+    // Where an id's enemy is kept: the index in a strip's list
+    struct Location
+    {
+        int strip, index;
+    };
+
+    // Enemies with their ids, ascending
+    struct EnemyList
+    {
+        std::vector<Entity> enemies;
+        std::vector<int>    ids;
+
+        void clear() { enemies.clear(); ids.clear(); }
+        void add(const Entity &enemy, int id) { enemies.push_back(enemy); ids.push_back(id); }
+        int  const get_count() const { return (int) ids.size(); }
+    };
+
+    struct Strip
+    {
+        float left, right;
+        EnemyList              owned;
+        std::vector<glm::vec2> next;       // where each owned enemy is headed this tick
+        EnemyList              leaving;    // moved out in the last step
+        std::vector<int>       leaving_to; // the strip each of those is now in
+        EnemyList              halo;       // the left neighbour's, then the right one's
+
+        // Scratch for take_arrivals()
+        std::vector<Location> arrivals;    // (strip, index) in another's leaving list
+        EnemyList             merged;
+
+        int handed_in = 0;                 // in the last tick
+    };
+
+    Map                   *m_map;
+    const NavLevel        *m_nav;
+    const StaticColliders *m_statics;
+
+    std::vector<Strip>     m_strips;
+    std::vector<Location>  m_locations; // by id
+    std::vector<FlowField> m_flow_fields;
+    float m_strip_width, m_halo_width;
+
+    std::vector<int> m_contacts;
+
+    int  get_strip_at(float x) const;
+    void update_flow_fields(const Entity &player);
+    void run_ai(Entity &enemy, const Entity &player);
+    void step_strip(int strip, float delta_time, const Entity &player);
+    void find_leavers(int strip);
+    void take_arrivals(int strip);
+    void build_halo(int strip);
+    bool touches(const Entity &enemy, const Entity &player, glm::vec2 player_reach) const;
+
+    // Runs phase(strip) for every strip, across jobs' threads when there are jobs
+    template <typename Phase> void for_each_strip(JobSystem *jobs, Phase phase);
+
+public:
+    // halo_width must be no wider than a strip, and at least the reach of any contact
+    // find_contacts() is asked about. nav may be null, and so may statics (see World::update).
+    PartitionedWorld(Map *map, const NavLevel *nav, const StaticColliders *statics,
+                     float strip_width = DEFAULT_STRIP_WIDTH, float halo_width = DEFAULT_HALO_WIDTH);
+
+    // Returns the new enemy's id. Add every enemy before the first tick.
+    int add_enemy(const Entity &enemy);
+
+    // One fixed step of every enemy: AI, integrate and resolve by strip, then the handoffs
+    // and halos. jobs may be null, which steps the strips one after another.
+    void tick(float delta_time, const Entity &player, JobSystem *jobs);
+
+    // The same step as tick(), one enemy after another in id order, ignoring the strips
+    void tick_serial(float delta_time, const Entity &player);
+
+    // The ids of the enemies touching player, ascending. Looks at the one strip the player
+    // is in and its halo, so the result is that of a scan of every enemy (find_contacts_serial())
+    // as long as no contact reaches further than the halo.
+    const std::vector<int> &find_contacts(const Entity &player);
+    const std::vector<int> &find_contacts_serial(const Entity &player);
+
+    const Entity &get_enemy(int id) const
+    {
+        return m_strips[m_locations[id].strip].owned.enemies[m_locations[id].index];
+    }
+
+    int   const get_enemy_count()   const { return (int) m_locations.size(); }
+    int   const get_strip_count()   const { return (int) m_strips.size(); }
+    int   const get_owned_count(int strip) const { return m_strips[strip].owned.get_count(); }
+    int   const get_handoff_count() const; // enemies that changed strips in the last tick
+    float const get_halo_width()    const { return m_halo_width; }
+};
@@ -0,0 +1,305 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "glm/gtc/matrix_transform.hpp"
+#include "PixelObservation.h"
+
+#ifdef _WINDOWS
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef RISE_EGL_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// ————— PINNED MEMORY ————— //
+// Page-aligned and locked so the OS never pages it out between readbacks
+static unsigned char *allocate_pinned(size_t bytes)
+{
+    const size_t PAGE_SIZE = 4096;
+    bytes = (bytes + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+
+#ifdef _WINDOWS
+    void *memory = _aligned_malloc(bytes, PAGE_SIZE);
+    if (memory) VirtualLock(memory, bytes);
+#else
+    void *memory = nullptr;
+    if (posix_memalign(&memory, PAGE_SIZE, bytes) != 0) memory = nullptr;
+    if (memory) mlock(memory, bytes); // best effort: may exceed RLIMIT_MEMLOCK
+#endif
+
+    return (unsigned char *) memory;
+}
+
+static void free_pinned(unsigned char *memory, size_t bytes)
+{
+#ifdef _WINDOWS
+    VirtualUnlock(memory, bytes);
+    _aligned_free(memory);
+#else
+    munlock(memory, bytes);
+    free(memory);
+#endif
+}
+
+PixelRenderer::PixelRenderer(int world_count, int tile_width, int tile_height)
+    : m_world_count(world_count), m_tile_width(tile_width), m_tile_height(tile_height)
+{
+    // As square a grid of tiles as the world count allows
+    m_tiles_x = (int) ceil(sqrt((double) world_count));
+    m_tiles_y = (world_count + m_tiles_x - 1) / m_tiles_x;
+    m_atlas_width  = m_tiles_x * m_tile_width;
+    m_atlas_height = m_tiles_y * m_tile_height;
+
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+    // ————— RENDER TARGET ————— //
+    glGenTextures(1, &m_colour_texture);
+    glBindTexture(GL_TEXTURE_2D, m_colour_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_atlas_width, m_atlas_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colour_texture, 0);
+    // Checked in every build: a driver that rejects the target would otherwise hand back
+    // garbage pixels without complaint
+    m_framebuffer_status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (m_atlas_width > max_size || m_atlas_height > max_size) m_framebuffer_status = GL_FRAMEBUFFER_UNSUPPORTED;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // ————— READBACK ————— //
+    m_pixel_bytes = (size_t) m_atlas_width * m_atlas_height * 4;
+    m_pixels = allocate_pinned(m_pixel_bytes);
+
+    glGenBuffers(2, m_pack_buffers);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pack_buffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, m_pixel_bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+PixelRenderer::~PixelRenderer()
+{
+    glDeleteBuffers(2, m_pack_buffers);
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteTextures(1, &m_colour_texture);
+    free_pinned(m_pixels, m_pixel_bytes);
+}
+
+PixelRenderer::SpriteBatch &PixelRenderer::get_batch(GLuint texture_id)
+{
+    // Only a handful of textures exist, so a linear search beats a map
+    for (SpriteBatch &batch : m_batches)
+    {
+        if (batch.texture_id == texture_id) return batch;
+    }
+
+    m_batches.push_back(SpriteBatch());
+    m_batches.back().texture_id = texture_id;
+    return m_batches.back();
+}
+
+void PixelRenderer::append_sprite(int world_index, float camera_x, GLuint texture_id,
+                                  glm::vec3 centre, float width, float height, glm::vec4 uv_rect)
+{
+    // Sprite corners as fractions of the world's view, where (0, 0) is the bottom-left
+    float view_left   = (centre.x - width / 2  - camera_x + VIEW_HALF_WIDTH)  / (2 * VIEW_HALF_WIDTH);
+    float view_right  = (centre.x + width / 2  - camera_x + VIEW_HALF_WIDTH)  / (2 * VIEW_HALF_WIDTH);
+    float view_bottom = (centre.y - height / 2 - CAMERA_Y_OFFSET + VIEW_HALF_HEIGHT) / (2 * VIEW_HALF_HEIGHT);
+    float view_top    = (centre.y + height / 2 - CAMERA_Y_OFFSET + VIEW_HALF_HEIGHT) / (2 * VIEW_HALF_HEIGHT);
+
+    // Clip to the view so a sprite never bleeds into the neighbouring world's tile,
+    // trimming the texture coordinates by the same fraction
+    float left   = fmax(view_left, 0.0f),   right = fmin(view_right, 1.0f);
+    float bottom = fmax(view_bottom, 0.0f), top   = fmin(view_top, 1.0f);
+    if (left >= right || bottom >= top) return;
+
+    float u_left   = uv_rect.x + uv_rect.z * (left  - view_left) / (view_right - view_left);
+    float u_right  = uv_rect.x + uv_rect.z * (right - view_left) / (view_right - view_left);
+    float v_top    = uv_rect.y + uv_rect.w * (view_top - top)    / (view_top - view_bottom);
+    float v_bottom = uv_rect.y + uv_rect.w * (view_top - bottom) / (view_top - view_bottom);
+
+    // Then into the render target's clip space
+    float tile_x = (float) (world_index % m_tiles_x);
+    float tile_y = (float) (world_index / m_tiles_x);
+    float x0 = (tile_x + left)   / m_tiles_x * 2.0f - 1.0f;
+    float x1 = (tile_x + right)  / m_tiles_x * 2.0f - 1.0f;
+    float y0 = (tile_y + bottom) / m_tiles_y * 2.0f - 1.0f;
+    float y1 = (tile_y + top)    / m_tiles_y * 2.0f - 1.0f;
+
+    SpriteBatch &batch = get_batch(texture_id);
+    batch.vertices.insert(batch.vertices.end(), {
+        x0, y0, x1, y0, x1, y1,
+        x0, y0, x1, y1, x0, y1
+    });
+    batch.texture_coordinates.insert(batch.texture_coordinates.end(), {
+        u_left, v_bottom, u_right, v_bottom, u_right, v_top,
+        u_left, v_bottom, u_right, v_top, u_left, v_top
+    });
+}
+
+void PixelRenderer::render(const World *worlds, Map *map, ShaderProgram *program)
+{
+    if (!is_complete()) return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_atlas_width, m_atlas_height);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(program->get_program_id());
+
+    // ————— MAP ————— //
+    // The same geometry for every world; only the viewport and camera change
+    program->set_projection_matrix(glm::ortho(-VIEW_HALF_WIDTH, VIEW_HALF_WIDTH,
+                                              -VIEW_HALF_HEIGHT, VIEW_HALF_HEIGHT, -1.0f, 1.0f));
+
+    for (int i = 0; i < m_world_count; i++)
+    {
+        glViewport((i % m_tiles_x) * m_tile_width, (i / m_tiles_x) * m_tile_height, m_tile_width, m_tile_height);
+
+        glm::mat4 view_matrix = glm::translate(glm::mat4(1.0f),
+            glm::vec3(-worlds[i].player.get_position().x, -CAMERA_Y_OFFSET, 0.0f));
+        program->set_view_matrix(view_matrix);
+        map->render(program);
+    }
+
+    // ————— SPRITES ————— //
+    // Every world's sprites, already in clip space, one draw per texture
+    for (SpriteBatch &batch : m_batches)
+    {
+        batch.vertices.clear();
+        batch.texture_coordinates.clear();
+    }
+
+    for (int i = 0; i < m_world_count; i++)
+    {
+        const Entity &player = worlds[i].player;
+        float camera_x = player.get_position().x;
+
+        append_sprite(i, camera_x, player.get_texture_id(), player.get_position(),
+                      player.get_visual_scale(), player.get_visual_scale(), player.get_sprite_uv_rect());
+
+        for (const Entity &enemy : worlds[i].enemies)
+        {
+            append_sprite(i, camera_x, enemy.get_texture_id(), enemy.get_position(),
+                          enemy.get_visual_scale(), enemy.get_visual_scale(), enemy.get_sprite_uv_rect());
+        }
+
+        const ProjectilePool &projectiles = worlds[i].projectiles;
+        for (int j = 0; j < projectiles.get_count(); j++)
+        {
+            const ProjectileSprite &sprite = projectiles.get_sprite(projectiles.get_sprite_index(j));
+            append_sprite(i, camera_x, sprite.texture, projectiles.get_position(j),
+                          projectiles.get_size(), projectiles.get_size(), sprite.uv);
+        }
+    }
+
+    glViewport(0, 0, m_atlas_width, m_atlas_height);
+    program->set_projection_matrix(glm::mat4(1.0f));
+    program->set_view_matrix(glm::mat4(1.0f));
+    program->set_model_matrix(glm::mat4(1.0f));
+
+    for (SpriteBatch &batch : m_batches)
+    {
+        if (batch.vertices.empty()) continue;
+
+        glBindTexture(GL_TEXTURE_2D, batch.texture_id);
+
+        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, batch.vertices.data());
+        glEnableVertexAttribArray(program->get_position_attribute());
+        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, batch.texture_coordinates.data());
+        glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+        glDrawArrays(GL_TRIANGLES, 0, (int) batch.vertices.size() / 2);
+
+        glDisableVertexAttribArray(program->get_position_attribute());
+        glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    }
+
+    // ————— READBACK ————— //
+    // Queue the copy into a pack buffer; glReadPixels returns without waiting for it
+    int slot = m_pack_frames[0] < 0 ? 0 : (m_pack_frames[1] < 0 ? 1 : -1);
+    if (slot < 0)
+    {
+        // Both buffers are still unread: drop the older frame rather than stall
+        slot = m_pack_frames[0] < m_pack_frames[1] ? 0 : 1;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pack_buffers[slot]);
+    glReadPixels(0, 0, m_atlas_width, m_atlas_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_pack_frames[slot] = m_frames_rendered++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+const unsigned char *PixelRenderer::read_pixels()
+{
+    if (!is_complete()) return nullptr;
+
+    int slot = -1;
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_pack_frames[i] >= 0 && (slot < 0 || m_pack_frames[i] < m_pack_frames[slot])) slot = i;
+    }
+    if (slot < 0) return nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pack_buffers[slot]);
+    const void *mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (mapped)
+    {
+        memcpy(m_pixels, mapped, m_pixel_bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_pixels_frame = m_pack_frames[slot];
+    m_pack_frames[slot] = -1;
+    return mapped ? m_pixels : nullptr;
+}
+
+#ifdef RISE_EGL_HEADLESS
+bool create_headless_gl_context()
+{
+    // Prefer the surfaceless platform explicitly; fall back to whatever EGL defaults to
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (get_platform_display) display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) return false;
+
+    // Surfaceless configs only offer pbuffers; asking for windows (the default) finds none
+    const EGLint config_attributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0) return false;
+
+    // Desktop GL, so the game's GLSL 1.10 shaders load unchanged
+    if (!eglBindAPI(EGL_OPENGL_API)) return false;
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT) return false;
+
+    // No surface at all: everything is drawn into framebuffer objects
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <vector>
+#include <SDL_opengl.h>
+#include "glm/glm.hpp"
+#include "ShaderProgram.h"
+#include "World.h"
+
+// ————— PIXEL OBSERVATIONS ————— //
+// Renders many small, downscaled worlds into the tiles of one offscreen render target,
+// for agents that learn from pixels. Worlds are laid out row by row, tiles_x per row:
+//
+//     world i -> tile (i % tiles_x, i / tiles_x), tile (0, 0) at the bottom-left
+//
+// One render() is one pass over one framebuffer with no window swap: the Map's geometry
+// is drawn once per world into that world's viewport, and every world's sprites are
+// gathered into a single draw per texture. Pixels come back asynchronously through two
+// pixel-pack buffers into a page-locked CPU buffer.
+class PixelRenderer
+{
+private:
+    int m_world_count;
+    int m_tile_width, m_tile_height;
+    int m_tiles_x, m_tiles_y;
+    int m_atlas_width, m_atlas_height;
+
+    GLuint m_framebuffer    = 0,
+           m_colour_texture = 0;
+    GLenum m_framebuffer_status = 0;
+
+    // Frames whose readback is in flight, oldest first; -1 when the buffer is free
+    GLuint m_pack_buffers[2];
+    int    m_pack_frames[2] = { -1, -1 };
+    int    m_frames_rendered = 0;
+    int    m_pixels_frame    = -1;
+
+    unsigned char *m_pixels;      // page-locked copy of the last frame read back
+    size_t         m_pixel_bytes;
+
+    // Sprites for every world, pre-transformed into the render target's clip space
+    struct SpriteBatch
+    {
+        GLuint             texture_id;
+        std::vector<float> vertices;
+        std::vector<float> texture_coordinates;
+    };
+    std::vector<SpriteBatch> m_batches;
+
+    SpriteBatch &get_batch(GLuint texture_id);
+    void append_sprite(int world_index, float camera_x, GLuint texture_id,
+                       glm::vec3 centre, float width, float height, glm::vec4 uv_rect);
+
+public:
+    // The same view the game shows, centred on each world's player
+    static constexpr float VIEW_HALF_WIDTH  = 5.0f,
+                           VIEW_HALF_HEIGHT = 3.75f,
+                           CAMERA_Y_OFFSET  = -2.0f;
+
+    PixelRenderer(int world_count, int tile_width, int tile_height);
+    ~PixelRenderer();
+
+    // False if the render target could not be built (the atlas is larger than the driver
+    // allows, or the framebuffer is incomplete); render() and read_pixels() then do nothing
+    bool   is_complete()            const { return m_framebuffer_status == GL_FRAMEBUFFER_COMPLETE; }
+    GLenum get_framebuffer_status() const { return m_framebuffer_status; }
+
+    // Draws worlds[0..world_count) and starts reading the result back. Leaves the default
+    // framebuffer bound; the program's matrices are left as the sprite pass set them.
+    void render(const World *worlds, Map *map, ShaderProgram *program);
+
+    // Returns the oldest frame not yet read, waiting only if its transfer is still in
+    // flight, or nullptr when nothing is pending. Pixels are RGBA8, atlas-sized, bottom row
+    // first; the pointer stays valid until the next call.
+    const unsigned char *read_pixels();
+
+    int const get_atlas_width()  const { return m_atlas_width;  }
+    int const get_atlas_height() const { return m_atlas_height; }
+    int const get_tile_width()   const { return m_tile_width;   }
+    int const get_tile_height()  const { return m_tile_height;  }
+    int const get_tiles_x()      const { return m_tiles_x;      }
+    int const get_pixels_frame() const { return m_pixels_frame; }
+};
+
+#ifdef RISE_EGL_HEADLESS
+// Makes a window-less OpenGL context current on the calling thread through EGL's
+// surfaceless platform (e.g. Mesa llvmpipe), so pixel observations work on CPU-only
+// machines. Returns false if no such context could be created.
+bool create_headless_gl_context();
+#endif
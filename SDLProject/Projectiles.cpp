@@ -0,0 +1,196 @@
+#include "Projectiles.h"
+#include "Float4.h"
+#include "RenderThread.h"
+
+constexpr int ProjectilePool::MAX_SPRITES;
+
+ProjectilePool::ProjectilePool(int capacity, float size) : m_capacity(capacity), m_size(size),
+    m_x(capacity), m_y(capacity), m_velocity_x(capacity), m_velocity_y(capacity),
+    m_owner(capacity), m_sprite(capacity)
+{
+    m_expired_owners.reserve(capacity);
+    m_hits.reserve(capacity);
+}
+
+bool ProjectilePool::spawn(glm::vec3 position, glm::vec3 velocity, int sprite, int owner)
+{
+    if (m_count == m_capacity) return false;
+
+    int i = m_count++;
+    m_x[i]          = position.x;
+    m_y[i]          = position.y;
+    m_velocity_x[i] = velocity.x;
+    m_velocity_y[i] = velocity.y;
+    m_owner[i]      = owner;
+    m_sprite[i]     = (unsigned char) sprite;
+    return true;
+}
+
+// The last shot takes the removed one's slot; order among shots carries no meaning
+void ProjectilePool::remove(int index)
+{
+    int last = --m_count;
+    m_x[index]          = m_x[last];
+    m_y[index]          = m_y[last];
+    m_velocity_x[index] = m_velocity_x[last];
+    m_velocity_y[index] = m_velocity_y[last];
+    m_owner[index]      = m_owner[last];
+    m_sprite[index]     = m_sprite[last];
+}
+
+void ProjectilePool::update(float delta_time, float left, float right, float bottom, float top)
+{
+    m_expired_owners.clear();
+
+    // ————— INTEGRATION ————— //
+    float *x = m_x.data(), *y = m_y.data();
+    const float *velocity_x = m_velocity_x.data(), *velocity_y = m_velocity_y.data();
+
+    int i = 0;
+#ifdef FLOAT4_LANES
+    float4 step = splat4(delta_time);
+    for (; i + FLOAT4_LANES <= m_count; i += FLOAT4_LANES)
+    {
+        store4(x + i, add4(load4(x + i), mul4(load4(velocity_x + i), step)));
+        store4(y + i, add4(load4(y + i), mul4(load4(velocity_y + i), step)));
+    }
+#endif
+    for (; i < m_count; i++)
+    {
+        x[i] += velocity_x[i] * delta_time;
+        y[i] += velocity_y[i] * delta_time;
+    }
+
+    // ————— CULLING ————— //
+    // Whole groups of four still in bounds are skipped at once; a group with a shot out
+    // of bounds is settled one shot at a time, re-testing whatever moves into a freed slot
+#ifdef FLOAT4_LANES
+    float4 left4 = splat4(left), right4 = splat4(right), bottom4 = splat4(bottom), top4 = splat4(top);
+#endif
+    i = 0;
+    while (i < m_count)
+    {
+#ifdef FLOAT4_LANES
+        if (i + FLOAT4_LANES <= m_count)
+        {
+            float4 x4 = load4(x + i), y4 = load4(y + i);
+            int outside = greater4(x4, right4) | greater4(left4, x4) | greater4(y4, top4) | greater4(bottom4, y4);
+            if (outside == 0) { i += FLOAT4_LANES; continue; }
+        }
+#endif
+        if (x[i] > right || x[i] < left || y[i] > top || y[i] < bottom)
+        {
+            if (m_owner[i] >= 0) m_expired_owners.push_back(m_owner[i]);
+            remove(i);
+        }
+        else i++;
+    }
+}
+
+void ProjectilePool::remove_owner(int owner)
+{
+    for (int i = 0; i < m_count; )
+    {
+        if (m_owner[i] == owner) remove(i);
+        else i++;
+    }
+}
+
+const std::vector<int> &ProjectilePool::find_overlapping(float left, float right, float bottom, float top, float radius)
+{
+    m_hits.clear();
+    const float *x = m_x.data(), *y = m_y.data();
+
+    int i = 0;
+#ifdef FLOAT4_LANES
+    float4 left4 = splat4(left), right4 = splat4(right), bottom4 = splat4(bottom), top4 = splat4(top),
+           radius4 = splat4(radius);
+    for (; i + FLOAT4_LANES <= m_count; i += FLOAT4_LANES)
+    {
+        float4 x4 = load4(x + i), y4 = load4(y + i);
+        int inside = greater4(add4(x4, radius4), left4) & greater4(right4, sub4(x4, radius4)) &
+                     greater4(add4(y4, radius4), bottom4) & greater4(top4, sub4(y4, radius4));
+
+        for (int lane = 0; inside != 0; lane++, inside >>= 1)
+            if (inside & 1) m_hits.push_back(i + lane);
+    }
+#endif
+    for (; i < m_count; i++)
+    {
+        if (x[i] + radius > left && x[i] - radius < right && y[i] + radius > bottom && y[i] - radius < top)
+            m_hits.push_back(i);
+    }
+    return m_hits;
+}
+
+bool ProjectilePool::hits_mask(const SpriteMask &mask, int frame, glm::vec3 position, float quad_width, float quad_height)
+{
+    const std::vector<int> &candidates = find_overlapping(position.x - quad_width / 2.0f, position.x + quad_width / 2.0f,
+                                                          position.y - quad_height / 2.0f, position.y + quad_height / 2.0f,
+                                                          m_size / 2.0f);
+    for (int i : candidates)
+    {
+        const SpriteMask *sprite_mask = m_sprites[m_sprite[i]].mask;
+        if (sprite_mask == nullptr || masks_overlap(*sprite_mask, 0, get_position(i), mask, frame, position)) return true;
+    }
+    return false;
+}
+
+int ProjectilePool::write_quads(float *vertices, float *texture_coordinates) const
+{
+    float half = m_size / 2.0f;
+    for (int i = 0; i < m_count; i++)
+    {
+        float left = m_x[i] - half, right = m_x[i] + half, bottom = m_y[i] - half, top = m_y[i] + half;
+        float quad[] = {
+            left, bottom, right, bottom, right, top,
+            left, bottom, right, top,    left,  top
+        };
+
+        // The frame's top edge is at uv.y, as in Entity::draw_sprite_from_texture_atlas
+        glm::vec4 uv = m_sprites[m_sprite[i]].uv;
+        float u0 = uv.x, u1 = uv.x + uv.z, v0 = uv.y, v1 = uv.y + uv.w;
+        float texels[] = {
+            u0, v1, u1, v1, u1, v0,
+            u0, v1, u1, v0, u0, v0
+        };
+
+        for (int k = 0; k < 12; k++)
+        {
+            vertices[i * 12 + k]            = quad[k];
+            texture_coordinates[i * 12 + k] = texels[k];
+        }
+    }
+    return m_count;
+}
+
+void ProjectilePool::snapshot(RenderSnapshot *snapshot) const
+{
+    if (m_count == 0) return;
+
+    int first = snapshot->add_quads(m_count);
+    write_quads(snapshot->get_quad_vertices(first), snapshot->get_quad_texture_coordinates(first));
+    snapshot->add_batch(m_sprites[0].texture, first, m_count);
+}
+
+void ProjectilePool::render(ShaderProgram *program)
+{
+    if (m_count == 0) return;
+
+    m_vertices.resize((size_t) m_capacity * 12);
+    m_texture_coordinates.resize((size_t) m_capacity * 12);
+    write_quads(m_vertices.data(), m_texture_coordinates.data());
+
+    program->set_model_matrix(glm::mat4(1.0f));
+    glBindTexture(GL_TEXTURE_2D, m_sprites[0].texture);
+
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    glDrawArrays(GL_TRIANGLES, 0, m_count * 6);
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+}
@@ -0,0 +1,99 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <vector>
+#include <SDL_opengl.h>
+#include "glm/glm.hpp"
+#include "ShaderProgram.h"
+#include "SpriteMask.h"
+
+// ————— PROJECTILES ————— //
+// Every shot in flight, in one fixed-size pool laid out as parallel arrays (position,
+// velocity, sprite, owner), so a tick moves them all in one streaming pass, four at a
+// time where SSE2 or NEON is available. Simulating never allocates: a full pool refuses
+// new shots, and a shot that leaves the bounds is removed by moving the last one into its
+// slot, which keeps the live shots packed at the front. (The vertex arrays are made on
+// the first render(), so pools that are never drawn never pay for them.)
+//
+// A projectile is a square quad of get_size() world units, drawn with one of a few
+// sprites. All the sprites must come from one texture (an atlas), which is what lets
+// render() draw the whole pool at once.
+struct RenderSnapshot;
+
+struct ProjectileSprite
+{
+    GLuint            texture = 0;
+    glm::vec4         uv      = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // (u, v, width, height) in texture
+    const SpriteMask *mask    = nullptr; // opaque texels, for pixel-accurate hits
+};
+
+class ProjectilePool
+{
+public:
+    static constexpr int MAX_SPRITES = 4;
+
+private:
+    int   m_capacity;
+    int   m_count = 0;
+    float m_size;
+
+    std::vector<float>         m_x, m_y, m_velocity_x, m_velocity_y;
+    std::vector<int>           m_owner;  // who fired it, or -1
+    std::vector<unsigned char> m_sprite;
+
+    ProjectileSprite m_sprites[MAX_SPRITES];
+
+    std::vector<int>   m_expired_owners; // owners of the shots the last update() removed
+    std::vector<int>   m_hits;           // scratch for find_overlapping()
+    std::vector<float> m_vertices, m_texture_coordinates;
+
+    void remove(int index);
+
+public:
+    ProjectilePool(int capacity, float size = 0.4f);
+
+    void set_sprite(int index, const ProjectileSprite &sprite) { m_sprites[index] = sprite; }
+
+    // Adds a shot at position moving at velocity (world units per second). Returns false
+    // if the pool is full.
+    bool spawn(glm::vec3 position, glm::vec3 velocity, int sprite, int owner = -1);
+
+    // Moves every shot by delta_time, then removes those outside [left, right] x
+    // [bottom, top]. The owners of removed shots are listed in get_expired_owners().
+    void update(float delta_time, float left, float right, float bottom, float top);
+
+    // Removes every shot fired by owner, e.g. when it is defeated
+    void remove_owner(int owner);
+    void clear() { m_count = 0; m_expired_owners.clear(); }
+
+    // Indices of the shots whose square of half-size radius overlaps the box [left, right]
+    // x [bottom, top], touching edges not counting. Valid until the pool next changes.
+    const std::vector<int> &find_overlapping(float left, float right, float bottom, float top, float radius);
+
+    // Whether any shot touches target's drawn pixels, given target's mask and the frame it
+    // shows; a shot whose sprite has no mask counts as soon as its quad overlaps
+    bool hits_mask(const SpriteMask &mask, int frame, glm::vec3 position, float quad_width, float quad_height);
+
+    // Fills the pool's vertex arrays with one quad per shot and draws them in one call
+    void render(ShaderProgram *program);
+
+    // Adds every shot to snapshot as one batch of quads, for the render thread to draw
+    void snapshot(RenderSnapshot *snapshot) const;
+
+    // Writes 12 position and 12 texture floats per shot (two triangles); returns the shot count
+    int write_quads(float *vertices, float *texture_coordinates) const;
+
+    const std::vector<int> &get_expired_owners() const { return m_expired_owners; }
+    const ProjectileSprite &get_sprite(int index)  const { return m_sprites[index]; }
+
+    glm::vec3 const get_position(int index)    const { return glm::vec3(m_x[index], m_y[index], 0.0f); }
+    glm::vec3 const get_velocity(int index)    const { return glm::vec3(m_velocity_x[index], m_velocity_y[index], 0.0f); }
+    int       const get_sprite_index(int index) const { return m_sprite[index]; }
+    int       const get_owner(int index)       const { return m_owner[index]; }
+    int       const get_count()                const { return m_count;    }
+    int       const get_capacity()             const { return m_capacity; }
+    float     const get_size()                 const { return m_size;     }
+};
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include "RenderThread.h"
+#include "AllocationTracker.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+constexpr int TextDraw::MAX_LENGTH;
+
+// ————— RENDER SNAPSHOT ————— //
+void RenderSnapshot::clear()
+{
+    sprites.clear();
+    quad_batches.clear();
+    texts.clear();
+    quad_count = 0;
+}
+
+void RenderSnapshot::reserve(int sprite_count, int quad_count, int batch_count, int text_count)
+{
+    sprites.reserve(sprite_count);
+    quad_batches.reserve(batch_count);
+    texts.reserve(text_count);
+
+    size_t floats = (size_t) quad_count * 12;
+    if (quad_vertices.size() < floats)
+    {
+        quad_vertices.resize(floats);
+        quad_texture_coordinates.resize(floats);
+    }
+}
+
+void RenderSnapshot::add_sprite(glm::vec3 position, GLuint texture, float scale, glm::vec4 uv_rect)
+{
+    SpriteDraw sprite;
+    sprite.texture  = texture;
+    sprite.position = position;
+    sprite.scale    = scale;
+    sprite.uv_rect  = uv_rect;
+    sprites.push_back(sprite);
+}
+
+void RenderSnapshot::add_text(const char *text, float font_size, float spacing, glm::vec3 position)
+{
+    TextDraw draw;
+    strncpy(draw.text, text, TextDraw::MAX_LENGTH);
+    draw.text[TextDraw::MAX_LENGTH] = '\0';
+    draw.font_size = font_size;
+    draw.spacing   = spacing;
+    draw.position  = position;
+    texts.push_back(draw);
+}
+
+int RenderSnapshot::add_quads(int count)
+{
+    int first = quad_count;
+    quad_count += count;
+
+    // Doubling, so a pool that fills up a little more each frame doesn't reallocate each time
+    size_t needed = (size_t) quad_count * 12;
+    if (quad_vertices.size() < needed)
+    {
+        size_t size = std::max(needed, quad_vertices.size() * 2);
+        quad_vertices.resize(size);
+        quad_texture_coordinates.resize(size);
+    }
+    return first;
+}
+
+void RenderSnapshot::add_batch(GLuint texture, int first, int count)
+{
+    if (count == 0) return;
+
+    QuadBatch batch;
+    batch.texture = texture;
+    batch.first   = first;
+    batch.count   = count;
+    quad_batches.push_back(batch);
+}
+
+void draw_snapshot_sprites(ShaderProgram *program, const RenderSnapshot &snapshot)
+{
+    // The same unit quad as draw_sprite, with the frame's top edge at uv.y
+    const float vertices[] =
+    {
+        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
+        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
+    };
+    float tex_coords[12];
+
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    for (const SpriteDraw &sprite : snapshot.sprites)
+    {
+        glm::mat4 model_matrix = glm::mat4(1.0f);
+        model_matrix = glm::translate(model_matrix, sprite.position);
+        model_matrix = glm::scale(model_matrix, glm::vec3(sprite.scale, sprite.scale, 1.0f));
+        program->set_model_matrix(model_matrix);
+
+        float u = sprite.uv_rect.x, v = sprite.uv_rect.y, width = sprite.uv_rect.z, height = sprite.uv_rect.w;
+        const float frame[] =
+        {
+            u, v + height, u + width, v + height, u + width, v,
+            u, v + height, u + width, v,          u,         v
+        };
+        memcpy(tex_coords, frame, sizeof(frame));
+
+        glBindTexture(GL_TEXTURE_2D, sprite.texture);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+}
+
+void draw_snapshot_quads(ShaderProgram *program, const RenderSnapshot &snapshot)
+{
+    if (snapshot.quad_batches.empty()) return;
+
+    program->set_model_matrix(glm::mat4(1.0f));
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, snapshot.quad_vertices.data());
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0,
+                          snapshot.quad_texture_coordinates.data());
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    for (const QuadBatch &batch : snapshot.quad_batches)
+    {
+        glBindTexture(GL_TEXTURE_2D, batch.texture);
+        glDrawArrays(GL_TRIANGLES, batch.first * 6, batch.count * 6);
+    }
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+}
+
+// ————— RENDER THREAD ————— //
+RenderThread::RenderThread(SDL_Window *window, SDL_GLContext context, DrawFunction draw) :
+    m_window(window), m_context(context), m_draw(draw)
+{
+    // A context is current on one thread at a time
+    SDL_GL_MakeCurrent(m_window, nullptr);
+    m_thread = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::~RenderThread()
+{
+    m_running.store(false, std::memory_order_release);
+    m_thread.join();
+    SDL_GL_MakeCurrent(m_window, m_context);
+}
+
+void RenderThread::run()
+{
+    AllocationScope scope(TAG_DRAW);
+    SDL_GL_MakeCurrent(m_window, m_context);
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        // Nothing new: the last frame is still on screen, so there is nothing to draw
+        if (!m_snapshots.acquire())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        m_draw(m_snapshots.get_front(), &m_arena);
+        SDL_GL_SwapWindow(m_window);
+        m_drawn.fetch_add(1, std::memory_order_relaxed);
+
+        m_arena.reset();
+        m_arena_peak.store(m_arena.get_peak(), std::memory_order_relaxed);
+        m_arena_grows.store(m_arena.get_grows(), std::memory_order_relaxed);
+    }
+
+    SDL_GL_MakeCurrent(m_window, nullptr);
+}
+
+RenderSnapshot &RenderThread::get_snapshot()
+{
+    return m_snapshots.get_back();
+}
+
+void RenderThread::publish()
+{
+    m_snapshots.get_back().frame = ++m_published;
+    if (!m_snapshots.publish()) m_skipped++;
+    m_snapshots.get_back().clear();
+}
+
+void RenderThread::reserve(int sprite_count, int quad_count, int batch_count, int text_count)
+{
+    assert(m_published == 0);
+    for (int slot = 0; slot < 3; slot++)
+        m_snapshots.get_slot(slot).reserve(sprite_count, quad_count, batch_count, text_count);
+}
+
+RenderStats const RenderThread::get_stats() const
+{
+    RenderStats stats;
+    stats.published = m_published;
+    stats.drawn     = m_drawn.load(std::memory_order_relaxed);
+    stats.skipped   = m_skipped;
+    stats.arena_peak  = m_arena_peak.load(std::memory_order_relaxed);
+    stats.arena_grows = m_arena_grows.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "FrameArena.h"
+#include "glm/glm.hpp"
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+#include "TripleBuffer.h"
+
+// ————— RENDER SNAPSHOT ————— //
+// Everything one frame draws, copied out of the simulation so that the render thread never
+// reads live game state: the camera, each sprite as a transform and a frame of its
+// texture, the quads of every pool (shots, particles) with the texture of each run of
+// them, and any text. A snapshot is refilled in place each frame, so once its arrays have
+// grown to the busiest frame seen, taking one allocates nothing.
+struct SpriteDraw
+{
+    GLuint    texture;
+    glm::vec3 position;
+    float     scale;
+    glm::vec4 uv_rect; // (u, v, width, height) in texture
+};
+
+// count quads from first on, in the snapshot's quad arrays, all of one texture
+struct QuadBatch
+{
+    GLuint texture;
+    int    first, count;
+};
+
+struct TextDraw
+{
+    static constexpr int MAX_LENGTH = 31;
+
+    char      text[MAX_LENGTH + 1];
+    float     font_size, spacing;
+    glm::vec3 position;
+};
+
+struct RenderSnapshot
+{
+    glm::mat4 view_matrix = glm::mat4(1.0f);
+
+    std::vector<SpriteDraw> sprites;
+    std::vector<QuadBatch>  quad_batches;
+    std::vector<TextDraw>   texts;
+
+    // 12 position and 12 texture floats per quad (two triangles); only the first
+    // quad_count quads are this frame's
+    std::vector<float> quad_vertices, quad_texture_coordinates;
+    int                quad_count = 0;
+
+    long long frame = 0; // which publish this was, counting from 1
+
+    void clear();
+
+    // Room for this many of each without growing, so that the first busy frame allocates
+    // no more than the quiet ones
+    void reserve(int sprite_count, int quad_count, int batch_count, int text_count);
+
+    void add_sprite(glm::vec3 position, GLuint texture, float scale, glm::vec4 uv_rect);
+    void add_text(const char *text, float font_size, float spacing, glm::vec3 position);
+
+    // Makes room for count more quads and returns the first one's index; write them at
+    // get_quad_vertices(index) and get_quad_texture_coordinates(index), then add_batch()
+    int  add_quads(int count);
+    void add_batch(GLuint texture, int first, int count);
+
+    float *get_quad_vertices(int index)            { return quad_vertices.data() + (size_t) index * 12; }
+    float *get_quad_texture_coordinates(int index) { return quad_texture_coordinates.data() + (size_t) index * 12; }
+};
+
+// Draws the snapshot's sprites, then its quad batches, in the order they were added
+void draw_snapshot_sprites(ShaderProgram *program, const RenderSnapshot &snapshot);
+void draw_snapshot_quads(ShaderProgram *program, const RenderSnapshot &snapshot);
+
+// ————— RENDER THREAD ————— //
+// Owns the GL context from construction to destruction and does all of a frame's GL work
+// on its own thread, swap and vsync included, so the simulation never waits on the driver
+// or the display. The simulation fills get_snapshot() and publish()es it; the render
+// thread draws whichever snapshot is the latest when it is ready for a frame, through the
+// draw function it was given, and then swaps. Frames the simulation publishes faster than
+// the display shows them are skipped, never queued.
+//
+// The draw function gets the render thread's frame arena for its scratch; it is reset
+// after every swap.
+struct RenderStats
+{
+    long long published = 0, // snapshots handed over
+              drawn     = 0, // frames the render thread drew
+              skipped   = 0; // snapshots overwritten before they were drawn
+    size_t    arena_peak  = 0; // most scratch one frame's draw used, in bytes
+    int       arena_grows = 0;
+};
+
+class RenderThread
+{
+public:
+    typedef std::function<void(const RenderSnapshot &, FrameArena *)> DrawFunction;
+
+private:
+    SDL_Window   *m_window;
+    SDL_GLContext m_context;
+    DrawFunction  m_draw;
+
+    TripleBuffer<RenderSnapshot> m_snapshots;
+    long long m_published = 0, m_skipped = 0; // only the simulation thread touches these
+    std::atomic<long long> m_drawn{0};
+
+    FrameArena          m_arena;           // the render thread's own
+    std::atomic<size_t> m_arena_peak{0};
+    std::atomic<int>    m_arena_grows{0};
+
+    std::atomic<bool> m_running{true};
+    std::thread       m_thread;
+
+    void run();
+
+public:
+    // context must be current on this thread; it is handed over to the render thread,
+    // and handed back by the destructor once that thread has finished its last frame
+    RenderThread(SDL_Window *window, SDL_GLContext context, DrawFunction draw);
+    ~RenderThread();
+
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    // The snapshot to fill this frame; it starts out empty. Simulation thread only.
+    RenderSnapshot &get_snapshot();
+
+    // Hands it to the render thread. Simulation thread only.
+    void publish();
+
+    // RenderSnapshot::reserve() on every snapshot the two threads pass between them. Only
+    // before the first publish(), while the render thread has none of them.
+    void reserve(int sprite_count, int quad_count, int batch_count, int text_count);
+
+    RenderStats const get_stats() const;
+};
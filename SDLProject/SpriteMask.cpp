@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <math.h>
+#include "SpriteMask.h"
+#include "stb_image.h"
+
+constexpr int SpriteMask::TEXELS_PER_UNIT;
+constexpr int SpriteMask::ALPHA_THRESHOLD;
+
+bool SpriteMask::load(const char *filepath, int cols, int rows, float quad_width, float quad_height)
+{
+    m_frames.clear();
+    m_rows.clear();
+
+    int width, height, number_of_components;
+    unsigned char *image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    if (image == NULL) return false;
+
+    build(image, width, height, cols, rows, quad_width, quad_height);
+    stbi_image_free(image);
+    return true;
+}
+
+void SpriteMask::build(const unsigned char *rgba, int image_width, int image_height, int cols, int rows,
+                       float quad_width, float quad_height)
+{
+    m_quad_width  = std::min((int) floor(quad_width  * TEXELS_PER_UNIT + 0.5f), 64);
+    m_quad_height = (int) floor(quad_height * TEXELS_PER_UNIT + 0.5f);
+
+    m_frames.assign(cols * rows, MaskFrame());
+    m_rows.clear();
+
+    std::vector<uint64_t> full(m_quad_height);
+    for (int index = 0; index < cols * rows; index++)
+    {
+        int col = index % cols, row = index / cols;
+
+        // Sample each texel's centre from the frame's UV rectangle, as GL_NEAREST does
+        int left = 64, right = -1, top = -1, bottom = -1;
+        for (int ty = 0; ty < m_quad_height; ty++)
+        {
+            int source_y = (int) ((row + (ty + 0.5f) / m_quad_height) / rows * image_height);
+            source_y = std::min(source_y, image_height - 1);
+
+            uint64_t bits = 0;
+            for (int tx = 0; tx < m_quad_width; tx++)
+            {
+                int source_x = (int) ((col + (tx + 0.5f) / m_quad_width) / cols * image_width);
+                source_x = std::min(source_x, image_width - 1);
+
+                if (rgba[(source_y * image_width + source_x) * 4 + 3] >= ALPHA_THRESHOLD) bits |= (uint64_t) 1 << tx;
+            }
+
+            full[ty] = bits;
+            if (bits == 0) continue;
+            if (top < 0) top = ty;
+            bottom = ty;
+            for (int tx = 0; tx < m_quad_width; tx++)
+                if (bits >> tx & 1) { left = std::min(left, tx); right = std::max(right, tx); }
+        }
+        if (top < 0) continue;
+
+        MaskFrame &frame = m_frames[index];
+        frame.x0        = left;
+        frame.y0        = top;
+        frame.width     = right - left + 1;
+        frame.height    = bottom - top + 1;
+        frame.first_row = (int) m_rows.size();
+        for (int ty = top; ty <= bottom; ty++) m_rows.push_back(full[ty] >> left);
+    }
+}
+
+bool masks_overlap(const SpriteMask &mask_a, int frame_a, glm::vec3 a,
+                   const SpriteMask &mask_b, int frame_b, glm::vec3 b)
+{
+    const MaskFrame &fa = mask_a.get_frame(frame_a), &fb = mask_b.get_frame(frame_b);
+    if (fa.height == 0 || fb.height == 0) return false;
+
+    // Where b's trimmed rows start relative to a's, in texels (rows count downwards)
+    int dx = (mask_b.get_quad_texel_x(b) + fb.x0) - (mask_a.get_quad_texel_x(a) + fa.x0),
+        dy = (mask_b.get_quad_texel_y(b) + fb.y0) - (mask_a.get_quad_texel_y(a) + fa.y0);
+
+    // Bounding boxes first; this also keeps the shifts below under 64
+    if (dx >= fa.width || -dx >= fb.width || dy >= fa.height || -dy >= fb.height) return false;
+
+    const uint64_t *rows_a = mask_a.get_rows(fa), *rows_b = mask_b.get_rows(fb);
+    int first = std::max(dy, 0), last = std::min(fa.height, dy + fb.height);
+
+    // Texel c of a row of b lands on texel c + dx of the row of a beside it
+    if (dx >= 0)
+    {
+        for (int row = first; row < last; row++)
+            if (rows_a[row] & (rows_b[row - dy] << dx)) return true;
+    }
+    else
+    {
+        for (int row = first; row < last; row++)
+            if (rows_a[row] & (rows_b[row - dy] >> -dx)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "glm/glm.hpp"
+
+// ————— SPRITE MASKS ————— //
+// 1-bit coverage of every frame of a sprite sheet, for hits that follow the drawn pixels
+// rather than a hand-tuned box. At load time each frame is resampled, the way GL_NEAREST
+// would draw it, onto a grid of TEXELS_PER_UNIT texels per world unit at the size the
+// entity is drawn. Every mask then shares one world-aligned texel grid, whatever the
+// resolution of its image, and two masks compare row against row.
+//
+// A row is one 64-bit word, bit 0 being its leftmost texel, which caps a sprite at two
+// world units across (the player is exactly that). Frames are trimmed to their opaque
+// texels, so the trimmed rectangle doubles as a tight bounding box.
+struct MaskFrame
+{
+    int x0 = 0, y0 = 0;          // top-left of the trimmed rows, in texels from the quad's top-left
+    int width = 0, height = 0;   // 0 x 0 if the frame is fully transparent
+    int first_row = 0;           // where its rows start in the mask's row array
+};
+
+class SpriteMask
+{
+public:
+    static constexpr int TEXELS_PER_UNIT = 32,
+                         ALPHA_THRESHOLD = 128; // texels at least this opaque are solid
+
+private:
+    int m_quad_width  = 0, // size of the drawn quad, in texels
+        m_quad_height = 0;
+
+    std::vector<MaskFrame> m_frames;
+    std::vector<uint64_t>  m_rows;
+
+public:
+    // Decodes filepath and cuts it into cols x rows frames drawn quad_width x quad_height
+    // world units large. Returns false, leaving the mask empty, if the image won't load.
+    bool load(const char *filepath, int cols, int rows, float quad_width, float quad_height);
+
+    // The same from pixels already in memory (RGBA, 8 bits per channel, top row first)
+    void build(const unsigned char *rgba, int image_width, int image_height, int cols, int rows,
+               float quad_width, float quad_height);
+
+    // Texel column/row of the quad's top-left corner when it is centred on position
+    int const get_quad_texel_x(glm::vec3 position) const
+    {
+        return (int) floor(position.x * TEXELS_PER_UNIT - m_quad_width / 2.0f + 0.5f);
+    }
+    int const get_quad_texel_y(glm::vec3 position) const
+    {
+        return (int) floor(-position.y * TEXELS_PER_UNIT - m_quad_height / 2.0f + 0.5f);
+    }
+
+    const MaskFrame &get_frame(int index) const { return m_frames[index]; }
+    const uint64_t  *get_rows(const MaskFrame &frame) const { return m_rows.data() + frame.first_row; }
+
+    int  const get_frame_count() const { return (int) m_frames.size(); }
+    bool const is_loaded()       const { return !m_frames.empty(); }
+};
+
+// Whether frame_a of mask_a centred on a and frame_b of mask_b centred on b share an
+// opaque texel. The trimmed boxes are tested first; only when they overlap are the
+// overlapping rows ANDed, one word per row.
+bool masks_overlap(const SpriteMask &mask_a, int frame_a, glm::vec3 a,
+                   const SpriteMask &mask_b, int frame_b, glm::vec3 b);
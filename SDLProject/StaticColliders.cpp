@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "StaticColliders.h"
+
+constexpr int StaticColliders::CELL_TILES;
+constexpr int StaticColliders::MAX_EXTRA_BOXES;
+
+void StaticColliders::bake(const Map &map, const Entity *entities, int entity_count)
+{
+    m_boxes.clear();
+    bake_tiles(map, &m_boxes);
+    m_tile_box_count = (int) m_boxes.size();
+    bake_platforms(entities, entity_count, &m_boxes);
+
+    m_cell_size = CELL_TILES * map.get_tile_size();
+    build_index();
+}
+
+// Greedy merge: take the first unclaimed solid tile in reading order, stretch it right
+// as far as the row allows, then down while every tile under that span is solid and
+// unclaimed. Not always the fewest boxes possible, but close, and linear in the tiles.
+void StaticColliders::bake_tiles(const Map &map, std::vector<StaticBox> *boxes)
+{
+    int   width = map.get_width(), height = map.get_height();
+    float tile_size = map.get_tile_size();
+    const unsigned int *tiles = map.get_level_data();
+
+    std::vector<unsigned char> claimed(width * height, 0);
+    m_tile_count = 0;
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (tiles[y * width + x] == 0) continue;
+            m_tile_count++;
+            if (claimed[y * width + x]) continue;
+
+            int run = 1;
+            while (x + run < width && tiles[y * width + x + run] != 0 && !claimed[y * width + x + run]) run++;
+
+            int rows = 1;
+            for (bool full = true; full && y + rows < height; )
+            {
+                const int row = (y + rows) * width;
+                for (int i = x; i < x + run && full; i++) full = tiles[row + i] != 0 && !claimed[row + i];
+                if (full) rows++;
+            }
+
+            for (int j = y; j < y + rows; j++)
+                std::fill(claimed.begin() + j * width + x, claimed.begin() + j * width + x + run, 1);
+
+            // Tile (x, y) is centred on (x, -y) * tile_size
+            StaticBox box;
+            box.left   = (x - 0.5f) * tile_size;
+            box.right  = (x + run - 0.5f) * tile_size;
+            box.top    = -(y - 0.5f) * tile_size;
+            box.bottom = -(y + rows - 0.5f) * tile_size;
+            boxes->push_back(box);
+        }
+    }
+}
+
+void StaticColliders::bake_platforms(const Entity *entities, int entity_count, std::vector<StaticBox> *boxes)
+{
+    std::vector<StaticBox> platforms;
+    for (int i = 0; i < entity_count; i++)
+    {
+        const Entity &entity = entities[i];
+        if (entity.get_entity_type() != PLATFORM || !entity.is_active()) continue;
+
+        glm::vec3 position = entity.get_position();
+        StaticBox box;
+        box.left   = position.x - entity.get_width()  / 2.0f;
+        box.right  = position.x + entity.get_width()  / 2.0f;
+        box.bottom = position.y - entity.get_height() / 2.0f;
+        box.top    = position.y + entity.get_height() / 2.0f;
+        platforms.push_back(box);
+    }
+    m_platform_count = (int) platforms.size();
+
+    // Row by row, left to right, joining neighbours whose edges meet or overlap
+    std::sort(platforms.begin(), platforms.end(), [](const StaticBox &a, const StaticBox &b) {
+        if (a.bottom != b.bottom) return a.bottom < b.bottom;
+        if (a.top    != b.top)    return a.top    < b.top;
+        return a.left < b.left;
+    });
+
+    for (size_t i = 0; i < platforms.size(); )
+    {
+        StaticBox merged = platforms[i++];
+        while (i < platforms.size() && platforms[i].bottom == merged.bottom && platforms[i].top == merged.top &&
+               platforms[i].left <= merged.right)
+        {
+            merged.right = std::max(merged.right, platforms[i++].right);
+        }
+        boxes->push_back(merged);
+    }
+}
+
+// Cells overlapped by the box, clamped to the grid; false if it misses the grid entirely.
+// Rows count down from the top, as in the Map.
+bool StaticColliders::get_cell_range(float left, float bottom, float right, float top,
+                                     int *x0, int *y0, int *x1, int *y1) const
+{
+    *x0 = std::max((int) floor((left     - m_origin_x) / m_cell_size), 0);
+    *x1 = std::min((int) floor((right    - m_origin_x) / m_cell_size), m_cells_x - 1);
+    *y0 = std::max((int) floor((m_origin_y - top)      / m_cell_size), 0);
+    *y1 = std::min((int) floor((m_origin_y - bottom)   / m_cell_size), m_cells_y - 1);
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+// Counting sort of the boxes into cells: one pass to size the cells, one to fill them
+void StaticColliders::build_index()
+{
+    m_cell_start.clear();
+    m_cell_boxes.clear();
+    m_cells_x = m_cells_y = 0;
+    m_indexed_count = (int) m_boxes.size();
+    if (m_boxes.empty()) return;
+
+    float left = m_boxes[0].left, right = m_boxes[0].right, bottom = m_boxes[0].bottom, top = m_boxes[0].top;
+    for (const StaticBox &box : m_boxes)
+    {
+        left   = std::min(left,   box.left);
+        right  = std::max(right,  box.right);
+        bottom = std::min(bottom, box.bottom);
+        top    = std::max(top,    box.top);
+    }
+    m_origin_x = left;
+    m_origin_y = top;
+    m_cells_x  = (int) floor((right - left) / m_cell_size) + 1;
+    m_cells_y  = (int) floor((top - bottom) / m_cell_size) + 1;
+
+    m_cell_start.assign(m_cells_x * m_cells_y + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            for (int c = 0; c < m_cells_x * m_cells_y; c++) m_cell_start[c + 1] += m_cell_start[c];
+            m_cell_boxes.resize(m_cell_start.back());
+        }
+
+        for (int i = 0; i < (int) m_boxes.size(); i++)
+        {
+            int x0, y0, x1, y1;
+            get_cell_range(m_boxes[i].left, m_boxes[i].bottom, m_boxes[i].right, m_boxes[i].top, &x0, &y0, &x1, &y1);
+
+            for (int cy = y0; cy <= y1; cy++)
+                for (int cx = x0; cx <= x1; cx++)
+                {
+                    int cell = cy * m_cells_x + cx;
+                    if (pass == 0) m_cell_start[cell + 1]++;
+                    else           m_cell_boxes[m_cell_start[cell]++] = i;
+                }
+        }
+    }
+
+    // Filling advanced every start to the next cell's; shift them back
+    for (int c = m_cells_x * m_cells_y; c > 0; c--) m_cell_start[c] = m_cell_start[c - 1];
+    m_cell_start[0] = 0;
+}
+
+int StaticColliders::query(float left, float bottom, float right, float top, int *boxes, int capacity) const
+{
+    int count = 0;
+    int x0, y0, x1, y1;
+    if (!m_cell_start.empty() && get_cell_range(left, bottom, right, top, &x0, &y0, &x1, &y1))
+    {
+        for (int cy = y0; cy <= y1; cy++)
+        {
+            for (int cx = x0; cx <= x1; cx++)
+            {
+                int cell = cy * m_cells_x + cx;
+                for (int k = m_cell_start[cell]; k < m_cell_start[cell + 1]; k++)
+                {
+                    const StaticBox &box = m_boxes[m_cell_boxes[k]];
+                    if (box.right <= left || box.left >= right || box.top <= bottom || box.bottom >= top) continue;
+                    
+                    // A box spanning several cells is reported only from the first one both share
+                    int box_x0, box_y0, box_x1, box_y1;
+                    get_cell_range(box.left, box.bottom, box.right, box.top, &box_x0, &box_y0, &box_x1, &box_y1);
+                    if (cx != std::max(box_x0, x0) || cy != std::max(box_y0, y0)) continue;
+                    
+                    if (count < capacity) boxes[count] = m_cell_boxes[k];
+                    count++;
+                }
+            }
+        }
+    }
+
+    // The few boxes patched in since the grid was built, one by one
+    for (int i = m_indexed_count; i < (int) m_boxes.size(); i++)
+    {
+        const StaticBox &box = m_boxes[i];
+        if (box.right <= left || box.left >= right || box.top <= bottom || box.bottom >= top) continue;
+
+        if (count < capacity) boxes[count] = i;
+        count++;
+    }
+    return std::min(count, capacity);
+}
+
+// ————— TILE EDITS ————— //
+void StaticColliders::patch_tiles(const Map &map, int x0, int y0, int x1, int y1)
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, map.get_width()  - 1);
+    y1 = std::min(y1, map.get_height() - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    // 1. The tile boxes over the edit; platforms stay as they are
+    float tile_size = map.get_tile_size();
+    float left = (x0 - 0.5f) * tile_size, right  =  (x1 + 0.5f) * tile_size,
+          top  = -(y0 - 0.5f) * tile_size, bottom = -(y1 + 0.5f) * tile_size;
+
+    m_patch_boxes.resize(std::max((int) m_patch_boxes.size(), 64));
+    int found;
+    while ((found = query(left, bottom, right, top, m_patch_boxes.data(), (int) m_patch_boxes.size()))
+           == (int) m_patch_boxes.size())
+    {
+        m_patch_boxes.resize(m_patch_boxes.size() * 2);
+    }
+
+    int kept = 0;
+    for (int k = 0; k < found; k++)
+    {
+        int index = m_patch_boxes[k];
+        if (index < m_tile_box_count || index >= m_indexed_count) m_patch_boxes[kept++] = index;
+    }
+
+    // 2. Their tiles and the edited ones are what gets merged again, inside the rectangle
+    // around all of them; the tiles of the boxes being kept are not marked
+    int rx0 = x0, ry0 = y0, rx1 = x1, ry1 = y1;
+    for (int k = 0; k < kept; k++)
+    {
+        const StaticBox &box = m_boxes[m_patch_boxes[k]];
+        rx0 = std::min(rx0, (int) lroundf(box.left   /  tile_size + 0.5f));
+        rx1 = std::max(rx1, (int) lroundf(box.right  /  tile_size + 0.5f) - 1);
+        ry0 = std::min(ry0, (int) lroundf(-box.top    / tile_size + 0.5f));
+        ry1 = std::max(ry1, (int) lroundf(-box.bottom / tile_size + 0.5f) - 1);
+    }
+    int width = rx1 - rx0 + 1, height = ry1 - ry0 + 1;
+    m_patch_tiles.assign((size_t) width * height, 0);
+
+    auto mark = [&](int bx0, int by0, int bx1, int by1) {
+        for (int y = by0; y <= by1; y++)
+            std::fill(m_patch_tiles.begin() + (size_t) (y - ry0) * width + (bx0 - rx0),
+                      m_patch_tiles.begin() + (size_t) (y - ry0) * width + (bx1 - rx0) + 1, 1);
+    };
+    mark(x0, y0, x1, y1);
+    for (int k = 0; k < kept; k++)
+    {
+        // Every tile under a box was solid, and is counted again below if it still is
+        StaticBox &box = m_boxes[m_patch_boxes[k]];
+        int bx0 = (int) lroundf(box.left   /  tile_size + 0.5f), bx1 = (int) lroundf(box.right  / tile_size + 0.5f) - 1,
+            by0 = (int) lroundf(-box.top    / tile_size + 0.5f), by1 = (int) lroundf(-box.bottom / tile_size + 0.5f) - 1;
+        mark(bx0, by0, bx1, by1);
+        m_tile_count -= (bx1 - bx0 + 1) * (by1 - by0 + 1);
+
+        // Emptied rather than removed, so no other box moves: inside out, it overlaps nothing
+        box.left = box.bottom = FLT_MAX;
+        box.right = box.top  = -FLT_MAX;
+    }
+
+    const TileStorage &tiles = map.get_tiles();
+    for (int y = ry0; y <= ry1; y++)
+    {
+        for (int x = rx0; x <= rx1; x++)
+        {
+            unsigned char &marked = m_patch_tiles[(size_t) (y - ry0) * width + (x - rx0)];
+            marked = marked && tiles.is_solid(x, y);
+            m_tile_count += marked;
+        }
+    }
+
+    // 3. The same greedy merge as bake_tiles(), over the marked solid tiles only
+    auto is_marked = [&](int x, int y) { return m_patch_tiles[(size_t) (y - ry0) * width + (x - rx0)] != 0; };
+    for (int y = ry0; y <= ry1; y++)
+    {
+        for (int x = rx0; x <= rx1; x++)
+        {
+            if (!is_marked(x, y)) continue;
+
+            int run = 1;
+            while (x + run <= rx1 && is_marked(x + run, y)) run++;
+
+            int rows = 1;
+            for (bool full = true; full && y + rows <= ry1; )
+            {
+                for (int i = x; i < x + run && full; i++) full = is_marked(i, y + rows);
+                if (full) rows++;
+            }
+
+            for (int j = y; j < y + rows; j++)
+                std::fill(m_patch_tiles.begin() + (size_t) (j - ry0) * width + (x - rx0),
+                          m_patch_tiles.begin() + (size_t) (j - ry0) * width + (x - rx0) + run, 0);
+
+            StaticBox box;
+            box.left   = (x - 0.5f) * tile_size;
+            box.right  = (x + run - 0.5f) * tile_size;
+            box.top    = -(y - 0.5f) * tile_size;
+            box.bottom = -(y + rows - 0.5f) * tile_size;
+            m_boxes.push_back(box);
+        }
+    }
+
+    if ((int) m_boxes.size() - m_indexed_count > MAX_EXTRA_BOXES)
+    {
+        compact();
+        build_index();
+    }
+}
+
+// Drops the emptied boxes and puts the patched ones with the other tile boxes, before the platforms
+void StaticColliders::compact()
+{
+    std::vector<StaticBox> boxes;
+    boxes.reserve(m_boxes.size());
+
+    auto keep_tiles = [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            if (m_boxes[i].left < m_boxes[i].right) boxes.push_back(m_boxes[i]);
+    };
+    keep_tiles(0, m_tile_box_count);
+    keep_tiles(m_indexed_count, (int) m_boxes.size());
+
+    int tile_box_count = (int) boxes.size();
+    boxes.insert(boxes.end(), m_boxes.begin() + m_tile_box_count, m_boxes.begin() + m_indexed_count);
+
+    m_boxes.swap(boxes);
+    m_tile_box_count = tile_box_count;
+}
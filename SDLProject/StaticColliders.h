@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include "Map.h"
+#include "Entity.h"
+
+// ————— STATIC COLLIDERS ————— //
+// Everything solid that never moves, the map's tiles and the PLATFORM entities, baked
+// into as few axis-aligned boxes as possible. Solid tiles are merged greedily: a run of
+// solid tiles along a row is grown downwards for as long as the rows below are solid over
+// the same span, so a floor or a wall becomes one box instead of dozens of tiles.
+// Platforms sitting side by side at the same height are joined into one box the same
+// way. The boxes are bucketed into a uniform grid, so a moving entity only looks at the
+// few boxes near it rather than every platform and a handful of tile probes.
+//
+// Like the Map it is baked from, it is read-only while worlds tick and shared by all of
+// them; a level with the same platforms in every world needs only one. Between ticks,
+// patch_tiles() follows tile edits without baking the whole map again.
+struct StaticBox
+{
+    float left, right, bottom, top;
+};
+
+class StaticColliders
+{
+public:
+    static constexpr int CELL_TILES      = 8,  // edge of a grid cell, in tiles
+                         MAX_EXTRA_BOXES = 64; // patched boxes outside the grid before it is built again
+
+private:
+    float m_cell_size = 1.0f;
+    float m_origin_x  = 0.0f, // world position of the grid's top-left corner
+          m_origin_y  = 0.0f;
+    int   m_cells_x   = 0,
+          m_cells_y   = 0;
+
+    std::vector<StaticBox> m_boxes;
+    int m_tile_box_count = 0; // m_boxes[0, m_tile_box_count) are merged tiles, the rest platforms
+    int m_indexed_count  = 0; // ... up to here; after it come the tile boxes patch_tiles() added
+    int m_tile_count     = 0, // what went into the bake, before merging
+        m_platform_count = 0;
+
+    // The boxes in cell c are m_cell_boxes[m_cell_start[c], m_cell_start[c + 1])
+    std::vector<int> m_cell_start, m_cell_boxes;
+
+    // patch_tiles()' scratch: the tiles it merges again, and the boxes it took apart
+    std::vector<unsigned char> m_patch_tiles;
+    std::vector<int>           m_patch_boxes;
+
+    void bake_tiles(const Map &map, std::vector<StaticBox> *boxes);
+    void bake_platforms(const Entity *entities, int entity_count, std::vector<StaticBox> *boxes);
+    void build_index();
+    void compact();
+    bool get_cell_range(float left, float bottom, float right, float top, int *x0, int *y0, int *x1, int *y1) const;
+
+public:
+    StaticColliders() { }
+    StaticColliders(const Map &map, const Entity *entities, int entity_count) { bake(map, entities, entity_count); }
+
+    // Merges the solid tiles of map and the active PLATFORM entities among entities;
+    // anything else in entities is left out, so a world's whole entity list can be passed
+    void bake(const Map &map, const Entity *entities, int entity_count);
+
+    // Brings the tile boxes up to date after the tiles in [x0, x1] x [y0, y1] of map
+    // changed: the boxes over those tiles are emptied and their tiles, with whatever in
+    // the edit is solid now, merged again into boxes kept outside the grid. Once there are
+    // more than MAX_EXTRA_BOXES of those, the boxes are packed and the grid built again,
+    // which renumbers them. Not while worlds tick.
+    void patch_tiles(const Map &map, int x0, int y0, int x1, int y1);
+
+    // Writes the indices of the boxes that overlap [left, right] x [bottom, top], touching
+    // edges not counting, and returns how many it wrote (at most capacity)
+    int query(float left, float bottom, float right, float top, int *boxes, int capacity) const;
+
+    const StaticBox &get_box(int index) const { return m_boxes[index]; }
+
+    int const get_box_count()      const { return (int) m_boxes.size(); }
+    int const get_tile_box_count() const { return m_tile_box_count;     }
+    int const get_source_count()   const { return m_tile_count + m_platform_count; }
+};
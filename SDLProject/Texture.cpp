@@ -0,0 +1,99 @@
+#define STB_IMAGE_IMPLEMENTATION
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "Texture.h"
+#include "stb_image.h"
+
+constexpr int NUMBER_OF_TEXTURES = 1;
+constexpr GLint LEVEL_OF_DETAIL  = 0;
+constexpr GLint TEXTURE_BORDER   = 0;
+
+bool decode_image(const char* filepath, DecodedImage* image)
+{
+    int number_of_components;
+    image->pixels = stbi_load(filepath, &image->width, &image->height, &number_of_components, STBI_rgb_alpha);
+    
+    if (image->pixels == NULL)
+    {
+        LOG("Unable to load image. Make sure the path is correct.");
+        assert(false);
+        return false;
+    }
+    return true;
+}
+
+bool decode_atlas(const char* const* filepaths, int count, DecodedImage* atlas, glm::vec4* uv_rects)
+{
+    std::vector<DecodedImage> images(count);
+    int atlas_width = 0, atlas_height = 0;
+    
+    for (int i = 0; i < count; i++)
+    {
+        if (!decode_image(filepaths[i], &images[i]))
+        {
+            for (int j = 0; j < i; j++) stbi_image_free(images[j].pixels);
+            return false;
+        }
+        
+        atlas_width += images[i].width;
+        if (images[i].height > atlas_height) atlas_height = images[i].height;
+    }
+    
+    // Left to right along the top edge; whatever is below a shorter image stays transparent
+    atlas->width  = atlas_width;
+    atlas->height = atlas_height;
+    atlas->pixels = (unsigned char*) calloc((size_t) atlas_width * atlas_height, 4);
+    for (int i = 0, x = 0; i < count; x += images[i].width, i++)
+    {
+        for (int row = 0; row < images[i].height; row++)
+        {
+            std::copy(images[i].pixels + (size_t) row * images[i].width * 4,
+                      images[i].pixels + (size_t) (row + 1) * images[i].width * 4,
+                      atlas->pixels + ((size_t) row * atlas_width + x) * 4);
+        }
+        
+        uv_rects[i] = glm::vec4((float) x / atlas_width, 0.0f,
+                                (float) images[i].width / atlas_width, (float) images[i].height / atlas_height);
+        stbi_image_free(images[i].pixels);
+    }
+    return true;
+}
+
+GLuint upload_texture(DecodedImage* image, GLint wrap)
+{
+    GLuint texture_id;
+    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, image->width, image->height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
+    
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    
+    // stbi_image_free() is free(), which also suits decode_atlas()'s calloc()
+    stbi_image_free(image->pixels);
+    image->pixels = NULL;
+    
+    return texture_id;
+}
+
+GLuint load_texture(const char* filepath)
+{
+    DecodedImage image;
+    decode_image(filepath, &image);
+    return upload_texture(&image, GL_REPEAT);
+}
+
+// Clamped, so a sprite's edge never samples its neighbour
+GLuint load_texture_atlas(const char* const* filepaths, int count, glm::vec4* uv_rects)
+{
+    DecodedImage atlas;
+    decode_atlas(filepaths, count, &atlas, uv_rects);
+    return upload_texture(&atlas, GL_CLAMP_TO_EDGE);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include "glm/glm.hpp"
+
+// An image decoded to RGBA8 and not yet uploaded. Decoding needs no GL context, so it can
+// happen on any thread; only the upload has to be on the GL thread.
+struct DecodedImage
+{
+    unsigned char* pixels = NULL;
+    int            width  = 0,
+                   height = 0;
+};
+
+bool decode_image(const char* filepath, DecodedImage* image);
+
+// Decodes several images and lays them side by side in one, as load_texture_atlas() does
+bool decode_atlas(const char* const* filepaths, int count, DecodedImage* atlas, glm::vec4* uv_rects);
+
+// Uploads a decoded image as a nearest-filtered RGBA texture and frees its pixels
+GLuint upload_texture(DecodedImage* image, GLint wrap = GL_REPEAT);
+
+// Decodes an image file and uploads it as a nearest-filtered RGBA texture
+GLuint load_texture(const char* filepath);
+
+// Decodes several images and uploads them side by side as one texture, so sprites from
+// any of them can share a draw call. uv_rects[i] receives image i's (u, v, width, height).
+GLuint load_texture_atlas(const char* const* filepaths, int count, glm::vec4* uv_rects);
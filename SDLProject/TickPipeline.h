@@ -0,0 +1,55 @@
+#pragma once
+
+// ————— TICK PHASES ————— //
+// World::update runs one fixed step as these phases, in this order, each over every entity
+// before the next one starts; between phases there is a barrier. Only integrate and
+// resolve are entity-parallel: there each mover writes nothing but its own body, animation
+// and motion, and reads nothing another mover writes. The others share an output. In ai,
+// guards fill the world's one NavPlanner cache and spend its search ration, and shooters
+// spawn into the one ProjectilePool, so splitting it across threads would race without a
+// planner and a spawn buffer per thread merged at the barrier (PartitionedWorld instead
+// runs AI with no planner and no projectiles). Broadphase and narrowphase append to single
+// lists, and events go in pool order.
+enum TickPhase
+{
+    PHASE_AI,          // enemies decide from the state the tick started with
+    PHASE_INTEGRATE,   // velocities and animations step; movers work out where they are headed; shots move
+    PHASE_RESOLVE,     // each mover goes there against the tiles and platforms
+    PHASE_BROADPHASE,  // enemies near enough to the player to maybe touch it
+    PHASE_NARROWPHASE, // which of those do touch (sprite against sprite), and whether a shot does
+    PHASE_EVENTS,      // defeats, losses and wins, in pool order; effects; despawns
+    PHASE_COUNT
+};
+
+// The pieces of world state a phase may touch. The level (Map, NavLevel, StaticColliders)
+// is read-only throughout and not listed.
+enum WorldData
+{
+    DATA_PLAYER      = 1 << 0, // the player's body and animation
+    DATA_ENEMIES     = 1 << 1, // every enemy's body and animation
+    DATA_ENEMY_AI    = 1 << 2, // every enemy's AI component
+    DATA_PROJECTILES = 1 << 3,
+    DATA_NAVIGATION  = 1 << 4, // the world's planner cache and flow fields
+    DATA_MOTION      = 1 << 5, // where each mover is headed this tick
+    DATA_CANDIDATES  = 1 << 6, // broadphase pairs
+    DATA_CONTACTS    = 1 << 7, // narrow-phase results
+    DATA_OUTCOME     = 1 << 8, // status, defeat count, the pool's membership, emitted effects
+};
+
+struct TickPhaseInfo
+{
+    const char  *name;
+    unsigned int reads, writes; // WorldData bits
+};
+
+extern const TickPhaseInfo TICK_PHASES[PHASE_COUNT];
+
+// Wall time spent in each phase, summed over the ticks that were timed
+struct TickTimings
+{
+    double phase_ms[PHASE_COUNT] = {};
+    long long ticks = 0;
+
+    void reset() { *this = TickTimings(); }
+    double get_average_ms(TickPhase phase) const { return ticks ? phase_ms[phase] / ticks : 0.0; }
+};
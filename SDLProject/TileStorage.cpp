@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cassert>
+#include "TileStorage.h"
+
+constexpr int TileStorage::BLOCK_SHIFT;
+constexpr int TileStorage::BLOCK_SIZE;
+
+void TileStorage::assign(int width, int height, const unsigned int *level_data)
+{
+    m_width    = width;
+    m_height   = height;
+    m_blocks_x = (width + BLOCK_SIZE - 1) >> BLOCK_SHIFT;
+    int blocks_y = (height + BLOCK_SIZE - 1) >> BLOCK_SHIFT;
+
+    unsigned int largest = 0;
+    for (size_t i = 0; i < (size_t) width * height; i++) largest = std::max(largest, level_data[i]);
+    assert(largest <= 0xFFFF);
+
+    // Whole blocks, so the tiles past the right and bottom edges are there (and open)
+    size_t size = (size_t) m_blocks_x * blocks_y * BLOCK_SIZE * BLOCK_SIZE;
+    m_wide = largest > 0xFF;
+    m_narrow.assign(m_wide ? 0 : size, 0);
+    m_wide_tiles.assign(m_wide ? size : 0, 0);
+
+    // Each row is a run of 8 tiles in every block along its row of blocks
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned int *row   = level_data + (size_t) y * width;
+        size_t              first = get_index(0, y);
+        for (int x0 = 0; x0 < width; x0 += BLOCK_SIZE)
+        {
+            size_t run = first + (size_t) (x0 >> BLOCK_SHIFT) * BLOCK_SIZE * BLOCK_SIZE;
+            int    end = std::min(x0 + BLOCK_SIZE, width);
+            if (m_wide) for (int x = x0; x < end; x++) m_wide_tiles[run + (x - x0)] = (uint16_t) row[x];
+            else        for (int x = x0; x < end; x++) m_narrow[run + (x - x0)]     = (uint8_t)  row[x];
+        }
+    }
+}
+
+void TileStorage::widen()
+{
+    m_wide_tiles.assign(m_narrow.begin(), m_narrow.end());
+    std::vector<uint8_t>().swap(m_narrow);
+    m_wide = true;
+}
+
+void TileStorage::set(int x, int y, unsigned int id)
+{
+    assert(id <= 0xFFFF);
+    if (!m_wide && id > 0xFF) widen();
+
+    if (m_wide) m_wide_tiles[get_index(x, y)] = (uint16_t) id;
+    else        m_narrow[get_index(x, y)]     = (uint8_t)  id;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ————— TILE STORAGE ————— //
+// A map's tile ids, one or two bytes each rather than an unsigned int: one while every id
+// fits in a byte (a tileset has a handful of tiles), two once one doesn't. The tiles are
+// kept in 8x8 blocks, each block's 64 tiles together and the blocks in rows, so that a
+// tile's neighbours above and below are 8 bytes away instead of a whole row of the map.
+// A probe around a body, or a walk down a column, stays within a cache line or two.
+class TileStorage
+{
+public:
+    static constexpr int BLOCK_SHIFT = 3,
+                         BLOCK_SIZE  = 1 << BLOCK_SHIFT; // tiles along a block's side
+
+private:
+    int  m_width = 0, m_height = 0;
+    int  m_blocks_x = 0;      // blocks per row of blocks
+    bool m_wide = false;      // two bytes a tile
+
+    std::vector<uint8_t>  m_narrow;
+    std::vector<uint16_t> m_wide_tiles;
+
+    size_t get_index(int x, int y) const
+    {
+        return ((size_t) (y >> BLOCK_SHIFT) * m_blocks_x + (x >> BLOCK_SHIFT)) * (BLOCK_SIZE * BLOCK_SIZE)
+               + ((y & (BLOCK_SIZE - 1)) << BLOCK_SHIFT) + (x & (BLOCK_SIZE - 1));
+    }
+    void widen();
+
+public:
+    // Copies a width x height map of ids, in rows from the top; ids must fit in 16 bits
+    void assign(int width, int height, const unsigned int *level_data);
+
+    // The tile at column x, row y, which must be on the map
+    unsigned int get(int x, int y) const
+    {
+        return m_wide ? m_wide_tiles[get_index(x, y)] : m_narrow[get_index(x, y)];
+    }
+    bool is_solid(int x, int y) const { return get(x, y) != 0; }
+
+    // Widens to two bytes a tile the first time id needs them
+    void set(int x, int y, unsigned int id);
+
+    int    const get_width()  const { return m_width;  }
+    int    const get_height() const { return m_height; }
+    bool   const is_wide()    const { return m_wide;   }
+    size_t const get_bytes()  const { return m_narrow.size() + m_wide_tiles.size() * sizeof(uint16_t); }
+};
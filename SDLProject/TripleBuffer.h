@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+
+// ————— TRIPLE BUFFER ————— //
+// Hands whole values from one writer thread to one reader thread without either ever
+// waiting on the other. There are three slots: the writer fills its back slot, the reader
+// reads its front slot, and the third sits in the middle. publish() swaps the back slot
+// with the middle one, and acquire() swaps the front slot with the middle one if the
+// middle holds something published since the reader last took it. The writer can run far
+// ahead: any values the reader never took are simply overwritten.
+template <typename T>
+class TripleBuffer
+{
+    static constexpr int SLOT  = 3, // the bits of m_middle that say which slot it is
+                         FRESH = 4; // set when the middle slot was published but not yet acquired
+
+    T m_slots[3];
+    std::atomic<int> m_middle{1};
+    int m_back  = 0; // the writer's own
+    int m_front = 2; // the reader's own
+
+public:
+    // Any of the three slots, whoever's it is now; only for setting them all up before
+    // the reader starts
+    T &get_slot(int index) { return m_slots[index]; }
+
+    // The slot to fill before publish(). It holds whatever was published two or more
+    // publishes ago, so reset what matters first.
+    T &get_back() { return m_slots[m_back]; }
+
+    // Offers the back slot to the reader and takes a slot it isn't reading to fill next.
+    // Returns false if that slot had been published but the reader never took it.
+    bool publish()
+    {
+        int previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+        m_back = previous & SLOT;
+        return (previous & FRESH) == 0;
+    }
+
+    // Makes the latest published slot the front one. Returns false, leaving the front as
+    // it was, if nothing has been published since the last acquire().
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & SLOT;
+        return true;
+    }
+
+    const T &get_front() const { return m_slots[m_front]; }
+};
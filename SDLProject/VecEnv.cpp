@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include "VecEnv.h"
+
+// Small, allocation-free RNG; each world keeps its own state so threads never share one
+static unsigned int xorshift32(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static int get_env_thread_count(int env_count, int thread_count)
+{
+    if (thread_count <= 0) thread_count = (int) std::thread::hardware_concurrency();
+    if (thread_count <= 0) thread_count = 1;
+    return std::max(1, std::min(thread_count, env_count)); // one even with no worlds to step
+}
+
+// A few chunks per thread, so that stealing can even out worlds that take longer (episode
+// resets, busy shooters) without handing out so many that the queues dominate
+static const int CHUNKS_PER_THREAD = 4;
+
+VecEnv::VecEnv(int env_count, int thread_count, const WorldMasks *masks) : m_env_count(std::max(env_count, 0)),
+    m_thread_count(get_env_thread_count(m_env_count, thread_count)), m_masks(masks),
+    m_worlds(m_env_count), m_rng_states(m_env_count, 1u), m_episode_steps(m_env_count, 0),
+    m_observation_builder(m_env_count), m_jobs(m_thread_count)
+{
+    m_grain = std::max(1, m_env_count / (m_thread_count * CHUNKS_PER_THREAD));
+    m_observation_timers.resize(m_thread_count);
+
+    // Textureless map: headless worlds only need it for collisions
+    m_map = new Map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, 0, 1.0f, 3, 1);
+
+    reset(0);
+
+    // The graphs and colliders come from a world's enemies and platforms; with no worlds,
+    // from one that is never stepped
+    World prototype;
+    World &model = m_env_count > 0 ? m_worlds[0] : prototype;
+    if (m_env_count == 0) prototype.initialise(WorldTextures(), m_map, 0.0f);
+    m_nav.add_enemies(*m_map, model.enemies.data(), model.enemies.get_count());
+    m_statics.bake(*m_map, model.platforms, PLATFORM_COUNT);
+}
+
+VecEnv::~VecEnv()
+{
+    delete m_map;
+}
+
+void VecEnv::reset_env(int env_index)
+{
+    // Spawn anywhere within a quarter tile of the usual spot
+    float jitter = ((xorshift32(&m_rng_states[env_index]) & 0xFFFF) / 65535.0f - 0.5f) * 0.5f;
+
+    WorldTextures textures;
+    textures.masks = m_masks;
+
+    m_worlds[env_index].initialise(textures, m_map, jitter);
+    m_episode_steps[env_index] = 0;
+}
+
+void VecEnv::reset(unsigned int seed)
+{
+    for (int i = 0; i < m_env_count; i++)
+    {
+        // Spread the seeds out; a zero state would lock xorshift at zero forever
+        m_rng_states[i] = (seed + 1u) * 2654435761u ^ (unsigned int) (i + 1) * 2246822519u;
+        if (m_rng_states[i] == 0) m_rng_states[i] = 1u;
+        reset_env(i);
+    }
+}
+
+void VecEnv::step_range(int thread_index, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        World &world = m_worlds[i];
+        int defeated_before = world.enemies_defeated;
+
+        world.apply_action((WorldAction) m_actions[i]);
+        WorldStatus status = world.update(FIXED_TIMESTEP, m_map, &m_nav, &m_statics);
+        m_episode_steps[i]++;
+
+        float reward = (world.enemies_defeated - defeated_before) * REWARD_DEFEAT;
+        if (status == WORLD_WON)  reward += REWARD_WIN;
+        if (status == WORLD_LOST) reward += REWARD_LOSE;
+
+        bool done = status != WORLD_RUNNING || m_episode_steps[i] >= MAX_EPISODE_STEPS;
+
+        m_rewards[i] = reward;
+        m_dones[i]   = done ? 1 : 0;
+
+        if (done) reset_env(i);
+    }
+
+    if (m_observations) observe_range(thread_index, begin, end);
+}
+
+void VecEnv::observe_range(int thread_index, int begin, int end)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    for (int i = begin; i < end; i++)
+    {
+        m_observation_builder.build(i, m_worlds[i], m_map,
+                                    m_observations + (size_t) i * ObservationBuilder::FLOATS_PER_ENV);
+    }
+
+    ObservationTimer &timer = m_observation_timers[thread_index];
+    timer.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    timer.builds      += end - begin;
+}
+
+double VecEnv::get_observation_ns_per_step() const
+{
+    long long nanoseconds = 0, builds = 0;
+    for (const ObservationTimer &timer : m_observation_timers)
+    {
+        nanoseconds += timer.nanoseconds;
+        builds      += timer.builds;
+    }
+    return builds > 0 ? (double) nanoseconds / builds : 0.0;
+}
+
+void VecEnv::reset_observation_timers()
+{
+    for (ObservationTimer &timer : m_observation_timers) timer.nanoseconds = timer.builds = 0;
+}
+
+void VecEnv::run_on_workers()
+{
+    m_jobs.parallel_for(m_env_count, m_grain, [this](int begin, int end) {
+        int thread_index = m_jobs.get_thread_index();
+        if (m_actions) step_range(thread_index, begin, end);
+        else           observe_range(thread_index, begin, end);
+    });
+}
+
+void VecEnv::step(const int *actions, float *rewards, unsigned char *dones, float *observations)
+{
+    m_actions      = actions;
+    m_rewards      = rewards;
+    m_dones        = dones;
+    m_observations = observations;
+
+    run_on_workers();
+}
+
+void VecEnv::observe(float *observations)
+{
+    m_actions      = nullptr;
+    m_observations = observations;
+
+    run_on_workers();
+}
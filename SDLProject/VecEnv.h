@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+#include "World.h"
+#include "Observation.h"
+#include "JobSystem.h"
+
+// ————— VECTORISED ENVIRONMENT ————— //
+// Runs K independent copies of the level for agent rollouts. Every copy is a World and
+// is advanced with exactly the same World::update the game uses, one FIXED_TIMESTEP per
+// step. The worlds live in one contiguous array and share a single read-only Map. Each
+// step is a parallel_for over that array on the VecEnv's own JobSystem: chunks of worlds
+// are handed out to its threads, and a thread that finishes early steals the chunks of
+// one that has not, so no two threads ever write to the same world at once.
+class VecEnv
+{
+private:
+    int m_env_count;
+    int m_thread_count;
+
+    Map *m_map;
+    const WorldMasks *m_masks;
+    NavLevel m_nav;
+    StaticColliders m_statics;
+    std::vector<World>        m_worlds;
+    std::vector<unsigned int> m_rng_states;    // per-world episode RNG (xorshift32)
+    std::vector<int>          m_episode_steps;
+
+    ObservationBuilder m_observation_builder;
+
+    // Observation build time, accumulated per thread, each thread's on its own cache line
+    struct alignas(64) ObservationTimer
+    {
+        long long nanoseconds = 0;
+        long long builds      = 0;
+    };
+    std::vector<ObservationTimer> m_observation_timers;
+
+    // ————— WORKERS ————— //
+    // The caller is the job system's thread 0 and takes chunks like any other
+    JobSystem m_jobs;
+    int       m_grain; // worlds per chunk
+
+    const int     *m_actions = nullptr;
+    float         *m_rewards = nullptr;
+    unsigned char *m_dones   = nullptr;
+    float         *m_observations = nullptr;
+
+    void run_on_workers();
+    void step_range(int thread_index, int begin, int end);
+    void observe_range(int thread_index, int begin, int end);
+    void reset_env(int env_index);
+
+public:
+    static constexpr float REWARD_DEFEAT = 1.0f;   // per enemy stomped
+    static constexpr float REWARD_WIN    = 10.0f;  // all enemies defeated
+    static constexpr float REWARD_LOSE   = -10.0f; // touched, shot or fell
+    static constexpr int   MAX_EPISODE_STEPS = 60 * 60; // one minute of game time
+
+    // thread_count <= 0 uses every hardware thread, but never more threads than worlds; an
+    // env_count <= 0 gives an empty VecEnv whose steps do nothing. With masks (which must
+    // outlive the VecEnv), worlds hit each other pixel by pixel, as in the game.
+    VecEnv(int env_count, int thread_count = 0, const WorldMasks *masks = nullptr);
+    ~VecEnv();
+
+    // Starts a fresh episode in every copy. The seed only jitters the player's spawn
+    // point, so equal seeds always give identical rollouts.
+    void reset(unsigned int seed);
+
+    // Applies actions[i] (a WorldAction) to copy i and advances all copies by one tick.
+    // Writes one reward and one done flag per copy; finished copies restart on their own.
+    // When observations is given (see observe()) each copy's next observation is written
+    // right after it steps, by the same thread, while the world is still in cache.
+    void step(const int *actions, float *rewards, unsigned char *dones, float *observations = nullptr);
+
+    // Writes every copy's current observation: get_env_count() blocks of
+    // ObservationBuilder::FLOATS_PER_ENV floats, in a 64-byte aligned buffer. Keep passing
+    // the same buffer to benefit from incremental updates.
+    void observe(float *observations);
+
+    // Mean wall time to build one world's observation since the last reset_observation_timers()
+    double get_observation_ns_per_step() const;
+    void   reset_observation_timers();
+
+    int   const get_env_count()    const { return m_env_count;    }
+    int   const get_thread_count() const { return m_thread_count; }
+    Map*  const get_map()          const { return m_map;          }
+    World const &get_world(int env_index) const { return m_worlds[env_index]; }
+    World const *get_worlds()              const { return m_worlds.data();    }
+};
@@ -0,0 +1,359 @@
+#include <chrono>
+#include "World.h"
+
+unsigned int LEVEL_1_DATA[LEVEL1_WIDTH * LEVEL1_HEIGHT] =
+{
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+// How large the sprites are drawn, in world units; the masks are cut to match
+static const float PLAYER_VISUAL_SCALE = 2.0f,
+                   ENEMY_VISUAL_SCALE  = 1.0f,
+                   PROJECTILE_SIZE     = 0.4f; // as Entity::render draws it
+
+constexpr int World::PROJECTILE_CAPACITY;
+
+bool WorldMasks::load(const char *player_path, const char *enemy_path, const char *projectile_1_path,
+                      const char *projectile_2_path)
+{
+    return player.load(player_path, 4, 4, PLAYER_VISUAL_SCALE, PLAYER_VISUAL_SCALE) &&
+           enemy.load(enemy_path, 4, 4, ENEMY_VISUAL_SCALE, ENEMY_VISUAL_SCALE) &&
+           projectile_1.load(projectile_1_path, 1, 1, PROJECTILE_SIZE, PROJECTILE_SIZE) &&
+           projectile_2.load(projectile_2_path, 1, 1, PROJECTILE_SIZE, PROJECTILE_SIZE);
+}
+
+void World::initialise(const WorldTextures &textures, Map *map, float player_offset_x)
+{
+    enemies_defeated = 0;
+    status           = WORLD_RUNNING;
+
+    // ––––– PLATFORM ––––– //
+    float start_x = 6.0f; // Set the desired starting x position
+    float start_y = 2.0f; // Set the desired starting y position
+
+    for (int i = 0; i < PLATFORM_COUNT; i++) {
+        platforms[i] = Entity(textures.platform, 0.0f, 0.4f, 1.0f, PLATFORM);
+        platforms[i].set_position(glm::vec3(start_x + i, start_y, 0.0f));
+        platforms[i].update(0.0f, nullptr, 0, map);
+    }
+
+    // ————— PLAYER SET-UP ————— //
+    int player_walking_animation[4][4] =
+    {
+        { 0, 1, 2, 3 },  // for PLAYER to move to the left,
+        { 4, 5, 6, 7 }, // for PLAYER to move to the right,
+        { 8, 9, 10, 11 }, // for PLAYER to move upwards,
+        { 12, 13, 14, 15 }   // for PLAYER to move downwards
+    };
+
+    glm::vec3 acceleration = glm::vec3(0.0f,-4.905f, 0.0f);
+
+    player = Entity(
+        textures.player,           // texture id
+        3.0f,                      // speed
+        acceleration,              // acceleration
+        4.0f,                      // jumping power
+        player_walking_animation,  // animation index sets
+        0.0f,                      // animation time
+        4,                         // animation frame amount
+        0,                         // current animation index
+        4,                         // animation column amount
+        4,                         // animation row amount
+        0.65f,                      // width
+        0.65f,                      // height
+        PLAYER
+    );
+
+    player.set_visual_scale(PLAYER_VISUAL_SCALE); // scaling player
+    player.set_position(glm::vec3(2.0f + player_offset_x, 0.0f, 0.0f));
+
+    // Jumping
+    player.set_jumping_power(5.0f);
+
+    // ————— ENEMIES SET-UP ————— //
+    int enemy_walking_animation[4][4] = {
+        {8, 9, 10, 11}, // Left
+        {4, 5, 6, 7},   // Right
+        {0, 1, 2, 3}, // Up
+        {12, 13, 14, 15} // Down
+    };
+    glm::vec3 enemy_acceleration = glm::vec3(0.0f, -2.905f, 0.0f);
+
+    // Configured here, then copied into the pool
+    Entity spawns[ENEMY_COUNT];
+    for (int i = 0; i < ENEMY_COUNT; ++i) {
+        spawns[i] = Entity(
+            textures.enemy,            // texture id
+            2.0f,                      // speed
+            enemy_acceleration,        // acceleration
+            1.0f,                      // jumping power (or adjust as needed)
+            enemy_walking_animation,   // animation frames
+            0.0f,                      // animation time
+            4,                         // animation frame amount
+            0,                         // current animation index
+            4,                         // animation column amount
+            4,                         // animation row amount
+            0.65f,                     // width
+            0.65f,                     // height
+            ENEMY                      // type
+        );
+        spawns[i].set_visual_scale(ENEMY_VISUAL_SCALE); // scale of enemies
+        if (textures.masks) spawns[i].set_sprite_mask(&textures.masks->enemy);
+    }
+
+    //first enemy
+    spawns[0].set_position(glm::vec3(4.0f, -5.125f, 0.0f));
+    spawns[0].set_ai_type(JUMPER);
+    spawns[0].set_ai_state(JUMPING);
+    spawns[0].set_jumping_power(2.0f);
+
+    //second enemy
+    spawns[1].set_position(glm::vec3(10.45f, -2.125f, 0.0f));
+    spawns[1].set_ai_type(SHOOTER);
+    spawns[1].set_ai_state(SHOOTING);
+    spawns[1].set_projectile_sprite(0);
+
+    //third enemy
+    spawns[2].set_position(glm::vec3(19.95f, -5.125f, 0.0f));
+    spawns[2].set_ai_type(PATROL);
+    spawns[2].set_ai_state(PATROLLING);
+    spawns[2].set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
+    spawns[2].set_speed(1.5f);
+
+    //fourth enemy
+    spawns[3].set_position(glm::vec3(12.95f, -4.125f, 0.0f));
+    spawns[3].set_ai_type(SHOOTER);
+    spawns[3].set_ai_state(SHOOTING);
+    spawns[3].set_projectile_sprite(1);
+
+    // ————— PROJECTILES ————— //
+    projectiles.clear();
+    for (int i = 0; i < 2; i++) {
+        ProjectileSprite sprite;
+        sprite.texture = textures.projectiles;
+        sprite.uv      = textures.projectile_uvs[i];
+        if (textures.masks) sprite.mask = i == 0 ? &textures.masks->projectile_1 : &textures.masks->projectile_2;
+        projectiles.set_sprite(i, sprite);
+    }
+
+    if (textures.masks) player.set_sprite_mask(&textures.masks->player);
+
+    enemies.clear();
+    for (int i = 0; i < ENEMY_COUNT; i++) enemies.spawn(spawns[i], spawns[i].get_ai_type());
+}
+
+// Mirrors what process_input() does with the keyboard, for callers that have no keyboard
+void World::apply_action(WorldAction action)
+{
+    player.set_movement(glm::vec3(0.0f));
+
+    bool wants_jump = action == ACTION_JUMP || action == ACTION_LEFT_JUMP || action == ACTION_RIGHT_JUMP;
+    if (wants_jump && player.get_collided_bottom()) player.jump();
+
+    if (action == ACTION_LEFT || action == ACTION_LEFT_JUMP)        player.move_left();
+    else if (action == ACTION_RIGHT || action == ACTION_RIGHT_JUMP) player.move_right();
+}
+
+// ————— TICK PIPELINE ————— //
+const TickPhaseInfo TICK_PHASES[PHASE_COUNT] =
+{
+    { "ai",          DATA_PLAYER | DATA_ENEMIES | DATA_ENEMY_AI,      DATA_ENEMIES | DATA_ENEMY_AI | DATA_PROJECTILES | DATA_NAVIGATION },
+    { "integrate",   DATA_PLAYER | DATA_ENEMIES | DATA_PROJECTILES,   DATA_PLAYER | DATA_ENEMIES | DATA_ENEMY_AI | DATA_PROJECTILES | DATA_MOTION },
+    { "resolve",     DATA_PLAYER | DATA_ENEMIES | DATA_MOTION,        DATA_PLAYER | DATA_ENEMIES },
+    { "broadphase",  DATA_PLAYER | DATA_ENEMIES,                      DATA_CANDIDATES },
+    { "narrowphase", DATA_PLAYER | DATA_ENEMIES | DATA_PROJECTILES | DATA_CANDIDATES, DATA_CONTACTS },
+    { "events",      DATA_PLAYER | DATA_ENEMIES | DATA_ENEMY_AI | DATA_CONTACTS,      DATA_ENEMIES | DATA_ENEMY_AI | DATA_PROJECTILES | DATA_OUTCOME },
+};
+
+// Adds the time from its construction to its destruction to one phase's total
+class PhaseTimer
+{
+    typedef std::chrono::steady_clock Clock;
+
+    TickTimings      *m_timings;
+    TickPhase         m_phase;
+    Clock::time_point m_start;
+
+public:
+    PhaseTimer(TickTimings *timings, TickPhase phase) : m_timings(timings), m_phase(phase)
+    {
+        if (m_timings) m_start = Clock::now();
+    }
+    ~PhaseTimer()
+    {
+        if (m_timings) m_timings->phase_ms[m_phase] += std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+    }
+};
+
+// Advances the world by one fixed step and applies the win/lose rules
+WorldStatus World::update(float delta_time, Map *map, const NavLevel *nav, const StaticColliders *statics)
+{
+    if (status != WORLD_RUNNING) return status;
+
+    { PhaseTimer timer(timings, PHASE_AI);          run_ai_phase(map, nav);                   }
+    { PhaseTimer timer(timings, PHASE_INTEGRATE);   integrate_phase(delta_time, map);         }
+    { PhaseTimer timer(timings, PHASE_RESOLVE);     resolve_phase(delta_time, map, statics);  }
+    { PhaseTimer timer(timings, PHASE_BROADPHASE);  broadphase();                             }
+    { PhaseTimer timer(timings, PHASE_NARROWPHASE); narrowphase();                            }
+    { PhaseTimer timer(timings, PHASE_EVENTS);      status = events_phase();                  }
+
+    if (timings) timings->ticks++;
+    return status;
+}
+
+// AI decides from the collision flags of the previous tick and from where the player was
+// when this one began, before anyone moves
+void World::run_ai_phase(Map *map, const NavLevel *nav)
+{
+    nav_planner.begin_tick();
+    AIContext context(player, map, nav, &nav_planner);
+    context.projectiles = &projectiles;
+
+    AIGroups ai_groups = get_ai_groups(enemies);
+    int chaser_count = ai_groups.begin[GUARD + 1] - ai_groups.begin[GUARD];
+    if (nav != nullptr && chaser_count >= FLOW_FIELD_MIN_CHASERS) {
+        if ((int) flow_fields.size() != nav->get_graph_count()) flow_fields.resize(nav->get_graph_count());
+        context.flow_fields = flow_fields.data();
+    }
+    run_ai(enemies.data(), ai_groups, context);
+}
+
+// Every mover on its own; all shots at once, and a shooter whose shot left the map may fire again
+void World::integrate_phase(float delta_time, Map *map)
+{
+    m_tick.player_next = player.integrate(delta_time);
+    for (int i = 0; i < enemies.get_count(); i++) m_tick.enemy_next[i] = enemies[i].integrate(delta_time);
+
+    projectiles.update(delta_time, map->get_left_bound(), map->get_right_bound(),
+                       map->get_bottom_bound(), map->get_top_bound());
+    for (int owner : projectiles.get_expired_owners()) {
+        Entity *shooter = enemies.get(EntityHandle::from_id(owner));
+        if (shooter) shooter->set_projectile_active(false);
+    }
+}
+
+// Each mover only against the level, so the order they go in does not matter. Baked
+// platforms drop out of the per-mover entity checks altogether.
+void World::resolve_phase(float delta_time, Map *map, const StaticColliders *statics)
+{
+    Entity *collidables      = statics ? nullptr : platforms;
+    int     collidable_count = statics ? 0       : PLATFORM_COUNT;
+
+    player.resolve(m_tick.player_next, delta_time, collidables, collidable_count, map, statics);
+    for (int i = 0; i < enemies.get_count(); i++)
+        enemies[i].resolve(m_tick.enemy_next[i], delta_time, collidables, collidable_count, map, statics);
+}
+
+glm::vec2 get_contact_reach(const Entity &entity)
+{
+    glm::vec2 half(entity.get_width() / 2.0f, entity.get_height() / 2.0f);
+    if (entity.get_sprite_mask() != nullptr) half = glm::max(half, glm::vec2(entity.get_visual_scale() / 2.0f));
+    return half;
+}
+
+bool edit_level_tile(Map *map, NavLevel *nav, StaticColliders *statics, int tile_x, int tile_y, unsigned int tile)
+{
+    if (!map->set_tile(tile_x, tile_y, tile)) return false;
+
+    if (statics != nullptr) statics->patch_tiles(*map, tile_x, tile_y, tile_x, tile_y);
+    if (nav     != nullptr) nav->patch(*map, tile_x, tile_y, tile_x, tile_y);
+    return true;
+}
+
+void World::broadphase()
+{
+    m_tick.candidate_count = 0;
+
+    glm::vec3 position    = player.get_position();
+    glm::vec2 player_half = get_contact_reach(player);
+    for (int i = 0; i < enemies.get_count(); i++) {
+        glm::vec2 distance = glm::abs(glm::vec2(enemies[i].get_position() - position));
+        glm::vec2 reach    = player_half + get_contact_reach(enemies[i]);
+        if (distance.x < reach.x && distance.y < reach.y) m_tick.candidates[m_tick.candidate_count++] = i;
+    }
+}
+
+// Landing on top of an enemy defeats it; any other touch defeats the player
+void World::narrowphase()
+{
+    m_tick.contact_count = 0;
+    for (int c = 0; c < m_tick.candidate_count; c++) {
+        Entity &enemy = enemies[m_tick.candidates[c]];
+        if (!player.check_sprite_collision(&enemy)) continue;
+
+        m_tick.touching[m_tick.contact_count] = enemies.get_handle(m_tick.candidates[c]);
+        m_tick.stomped[m_tick.contact_count]  = player.get_position().y > enemy.get_position().y + enemy.get_height() / 2.0f;
+        m_tick.contact_count++;
+    }
+
+    m_tick.player_shot = is_player_shot();
+}
+
+// Contacts are taken in the pool order the tick started with; the first one that decides
+// the game ends the tick
+WorldStatus World::events_phase()
+{
+    for (int c = 0; c < m_tick.contact_count; c++) {
+        Entity *enemy = enemies.get(m_tick.touching[c]);
+        if (enemy == nullptr) continue;
+
+        if (!m_tick.stomped[c]) {
+            emit_player_hit();
+            return WORLD_LOST;
+        }
+
+        enemies_defeated++;
+        emit_defeat(enemy->get_position());
+
+        // A shooter's shots go with it
+        if (enemy->get_ai_type() == SHOOTER) projectiles.remove_owner(enemy->get_pool_id());
+
+        enemies.despawn(m_tick.touching[c]);
+        if (enemies.get_count() == 0) return WORLD_WON;
+    }
+
+    if (m_tick.player_shot) {
+        emit_player_hit();
+        return WORLD_LOST;
+    }
+
+    //handles if player falls off map
+    if (player.get_position().y < MAP_LOWER_BOUNDARY) return WORLD_LOST;
+
+    return WORLD_RUNNING;
+}
+
+bool World::is_player_shot()
+{
+    if (projectiles.get_count() == 0) return false;
+
+    glm::vec3 position = player.get_position();
+    if (player.get_sprite_mask() != nullptr) {
+        return projectiles.hits_mask(*player.get_sprite_mask(), player.get_sprite_frame(), position,
+                                     player.get_visual_scale(), player.get_visual_scale());
+    }
+
+    float half_width = player.get_width() / 2.0f, half_height = player.get_height() / 2.0f;
+    return !projectiles.find_overlapping(position.x - half_width, position.x + half_width,
+                                         position.y - half_height, position.y + half_height, 0.1f).empty();
+}
+
+// ————— EFFECTS ————— //
+void World::emit_player_hit()
+{
+    if (effects == nullptr) return;
+    effects->emit(EFFECT_SPARKS, player.get_position(), glm::vec3(0.0f), 4.0f, 40);
+}
+
+void World::emit_defeat(glm::vec3 position)
+{
+    if (effects == nullptr) return;
+    effects->emit(EFFECT_DEBRIS, position, glm::vec3(0.0f, 2.0f, 0.0f), 2.5f, 24);
+    effects->emit(EFFECT_DUST, position - glm::vec3(0.0f, 0.3f, 0.0f), glm::vec3(0.0f, 0.4f, 0.0f), 1.2f, 16);
+}
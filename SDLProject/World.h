@@ -0,0 +1,143 @@
+#pragma once
+#include "Entity.h"
+#include "Map.h"
+#include "EnemyAI.h"
+#include "StaticColliders.h"
+#include "SpriteMask.h"
+#include "Projectiles.h"
+#include "Particles.h"
+#include "TickPipeline.h"
+
+#define FIXED_TIMESTEP 0.0166666f
+#define PLATFORM_COUNT 11
+#define ENEMY_COUNT 4
+#define LEVEL1_WIDTH 30
+#define LEVEL1_HEIGHT 7
+
+// The numerical "drawing" of the only level; shared by the game and every headless copy
+extern unsigned int LEVEL_1_DATA[LEVEL1_WIDTH * LEVEL1_HEIGHT];
+
+enum WorldStatus { WORLD_RUNNING, WORLD_WON, WORLD_LOST };
+
+// The discrete inputs a player (human or agent) can give in one fixed step
+enum WorldAction { ACTION_NONE, ACTION_LEFT, ACTION_RIGHT, ACTION_JUMP,
+                   ACTION_LEFT_JUMP, ACTION_RIGHT_JUMP, ACTION_COUNT };
+
+// The particle styles a world emits; whoever owns its ParticleSystem sets their looks
+enum WorldEffect { EFFECT_SPARKS, EFFECT_DUST, EFFECT_DEBRIS, EFFECT_COUNT };
+
+// The sprites' opaque pixels, for hits that match what is drawn. Decoded from the same
+// images as the textures but without needing GL, so headless worlds can use them too;
+// read-only once loaded and shared by every world, like the Map.
+struct WorldMasks
+{
+    SpriteMask player, enemy, projectile_1, projectile_2;
+
+    // Cuts each sheet into frames at the size World::initialise draws it. Returns false
+    // if any image is missing, in which case worlds should be given no masks at all.
+    bool load(const char *player_path, const char *enemy_path, const char *projectile_1_path,
+              const char *projectile_2_path);
+};
+
+// Texture handles used when building a world. Headless worlds leave them all at 0.
+struct WorldTextures
+{
+    GLuint player       = 0;
+    GLuint enemy        = 0;
+    GLuint platform     = 0;
+
+    // Both bullets side by side in one texture, so every shot in flight draws at once;
+    // projectile_uvs says where each one is
+    GLuint    projectiles = 0;
+    glm::vec4 projectile_uvs[2] = { glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f) };
+
+    // Without masks, entities hit each other by their collision boxes
+    const WorldMasks *masks = nullptr;
+};
+
+// Half the extent an entity can touch others over: its drawn quad when it hits by sprite
+// mask, which may be larger than its collision box
+glm::vec2 get_contact_reach(const Entity &entity);
+
+// Changes one tile of a level and patches everything baked from it: the map's mesh and
+// solidity, the static colliders' tile boxes and the nav graphs, whose flow fields then
+// rebuild on their next update. nav and statics may be null. Between ticks only; false
+// if nothing changed.
+bool edit_level_tile(Map *map, NavLevel *nav, StaticColliders *statics, int tile_x, int tile_y, unsigned int tile);
+
+// ————— WORLD ————— //
+// Everything that changes while one copy of the level is played. The Map is not part of
+// the world: it is read-only during a tick, so any number of worlds can share one.
+struct World
+{
+    Entity player;
+    Entity platforms[PLATFORM_COUNT];
+
+    // The enemies still standing, grouped by AI type so that AI runs one specialised pass
+    // per type; a defeated enemy is despawned rather than left inactive
+    EntityPool enemies{ENEMY_COUNT, AI_TYPE_COUNT};
+
+    // Every shot in flight; each shot's owner is its shooter's EntityHandle id
+    static constexpr int PROJECTILE_CAPACITY = 16;
+    ProjectilePool projectiles{PROJECTILE_CAPACITY};
+
+    // This world's path cache for chasers; the graphs it searches belong to the level
+    NavPlanner nav_planner;
+
+    // With this many guards, one flow field per player move is cheaper than their searches
+    static constexpr int FLOW_FIELD_MIN_CHASERS = 16;
+    std::vector<FlowField> flow_fields; // one per level graph, made on first use
+
+    // Where hits and defeats throw their sparks, dust and debris. Purely visual, so it is
+    // not the world's own: left null (as headless worlds do), nothing is emitted.
+    ParticleSystem *effects = nullptr;
+
+    // When set, update() adds the time each of its phases takes here
+    TickTimings *timings = nullptr;
+
+    int         enemies_defeated = 0;
+    WorldStatus status           = WORLD_RUNNING;
+
+    // The y position below which the player counts as having fallen off the map
+    static constexpr float MAP_LOWER_BOUNDARY = -6.0f;
+
+    void initialise(const WorldTextures &textures, Map *map, float player_offset_x = 0.0f);
+    void apply_action(WorldAction action);
+
+    // Runs the phases of TickPipeline.h in order. statics is the map and this world's
+    // platforms baked together (every world places them alike, so one bake serves them all).
+    // Without it, each mover probes the map and scans every platform, every tick.
+    WorldStatus update(float delta_time, Map *map, const NavLevel *nav = nullptr, const StaticColliders *statics = nullptr);
+
+    // Whether any shot touches the player: pixel against pixel when there are masks, and
+    // the shot's 0.2-unit hit box against the player's collision box otherwise
+    bool is_player_shot();
+
+private:
+    // What each phase leaves for the next ones; sized for a full pool, so a tick never allocates
+    struct TickScratch
+    {
+        glm::vec2 player_next;
+        glm::vec2 enemy_next[ENEMY_COUNT];
+
+        int candidates[ENEMY_COUNT]; // pool indices
+        int candidate_count = 0;
+
+        EntityHandle touching[ENEMY_COUNT];
+        bool         stomped[ENEMY_COUNT]; // from above, rather than the enemy running into the player
+        int          contact_count = 0;
+        bool         player_shot   = false;
+    };
+    TickScratch m_tick;
+
+    // One per TickPhase
+    void run_ai_phase(Map *map, const NavLevel *nav);
+    void integrate_phase(float delta_time, Map *map);
+    void resolve_phase(float delta_time, Map *map, const StaticColliders *statics);
+    void broadphase();
+    void narrowphase();
+    WorldStatus events_phase();
+
+    void emit_player_hit();
+    void emit_defeat(glm::vec3 position);
+};
@@ -8,14 +8,8 @@
 * Academic Misconduct.
 **/
 #define GL_SILENCE_DEPRECATION
-#define STB_IMAGE_IMPLEMENTATION
 #define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
-#define FIXED_TIMESTEP 0.0166666f
-#define PLATFORM_COUNT 11
-#define ENEMY_COUNT 4
-#define LEVEL1_WIDTH 30
-#define LEVEL1_HEIGHT 7
 
 #ifdef _WINDOWS
 #include <GL/glew.h>
@@ -27,26 +21,43 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
-#include "stb_image.h"
+#include "Texture.h"
 #include "cmath"
 #include <ctime>
 #include <vector>
+#include <cstring>
 #include "Entity.h"
 #include "Map.h"
+#include "World.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
+#include <chrono>
 
 // ————— GAME STATE ————— //
 struct GameState
 {
+    World *world;
+
+    // Shortcuts into world
     Entity *player;
-    Entity *enemies;
+    EntityPool *enemies;
     Entity *platforms;
     
     Map *map;
+    NavLevel *nav; // paths across map for chasing enemies
+    StaticColliders *statics; // map tiles and platforms, merged for collisions
+    WorldMasks *masks;        // sprite alpha, for pixel-accurate hits
+    ParticleSystem *effects;  // sparks, dust and debris thrown by the world
+    TickTimings timings;      // where the world's ticks spend their time, by phase
+    JobSystem *jobs;          // worker threads; this one is its main thread
+    RenderThread *renderer;   // owns the GL context once set-up is done, and draws each frame
+    FrameAllocationStats frames; // simulation-side frame times, and what each frame allocated
     
     Mix_Music *bgm;
     Mix_Chunk *jump_sfx;
-    
-    int enemies_defeated = 0;  // variable to track defeated enemies
 };
 
 
@@ -85,24 +96,10 @@ constexpr char SPRITESHEET_FILEPATH[] = "assets/images/player0.png",
 constexpr char FONTSHEET_FILEPATH[]   = "assets/images/font1.png";
 constexpr int FONTBANK_SIZE = 16;
 
-constexpr int NUMBER_OF_TEXTURES = 1;
-constexpr GLint LEVEL_OF_DETAIL  = 0;
-constexpr GLint TEXTURE_BORDER   = 0;
-
 constexpr float PLATFORM_OFFSET = 5.0f;
 
-unsigned int LEVEL_1_DATA[] =
-{
-    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
-};
-
-
+constexpr int PARTICLE_CAPACITY = 4096,
+              PARTICLE_BUDGET   = 2048;
 
 // ————— VARIABLES ————— //
 GameState g_game_state;
@@ -115,7 +112,6 @@ glm::mat4 g_view_matrix, g_projection_matrix;
 float g_previous_ticks = 0.0f,
       g_accumulator    = 0.0f;
 
-GLuint load_texture(const char* filepath);
 GLuint g_font_texture_id;
 GLuint g_bg_texture_id;
 glm::mat4 g_bg_matrix;
@@ -128,39 +124,17 @@ void print_vec3(const glm::vec3& vec)
 void initialise();
 void process_input();
 void update();
+void update_effects();
 void render();
+void draw_frame(const RenderSnapshot &snapshot, FrameArena *arena);
+void wait_for_next_tick();
 void shutdown();
 
 // ————— GENERAL FUNCTIONS ————— //
-GLuint load_texture(const char* filepath)
-{
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
-    
-    if (image == NULL)
-    {
-        LOG("Unable to load image. Make sure the path is correct.");
-        assert(false);
-    }
-    
-    GLuint texture_id;
-    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    stbi_image_free(image);
-    
-    return texture_id;
-}
-
-// taken from lecture: sprites-and-text to write end game text
-void draw_text(ShaderProgram *shader_program, GLuint font_texture_id, std::string text,
-               float font_size, float spacing, glm::vec3 position)
+// taken from lecture: sprites-and-text to write end game text. The quads are frame
+// scratch, so they come out of arena.
+void draw_text(ShaderProgram *shader_program, GLuint font_texture_id, const char *text,
+               float font_size, float spacing, glm::vec3 position, FrameArena *arena)
 {
     // Scale the size of the fontbank in the UV-plane
     // We will use this for spacing and positioning
@@ -168,12 +142,15 @@ void draw_text(ShaderProgram *shader_program, GLuint font_texture_id, std::strin
     float height = 1.0f / FONTBANK_SIZE;
 
     // Instead of having a single pair of arrays, we'll have a series of pairs—one for
-    // each character. Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    // each character, all of them reserved up front
+    int length = (int) strlen(text);
+    ArenaVector<float> vertices{ArenaAllocator<float>(arena)};
+    ArenaVector<float> texture_coordinates{ArenaAllocator<float>(arena)};
+    vertices.reserve(length * 12);
+    texture_coordinates.reserve(length * 12);
 
     // For every character...
-    for (int i = 0; i < text.size(); i++) {
+    for (int i = 0; i < length; i++) {
         // 1. Get their index in the spritesheet, as well as their offset (i.e. their
         //    position relative to the whole sentence)
         int spritesheet_index = (int) text[i];  // ascii value of character
@@ -219,7 +196,7 @@ void draw_text(ShaderProgram *shader_program, GLuint font_texture_id, std::strin
     glEnableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
 
     glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int) (text.size() * 6));
+    glDrawArrays(GL_TRIANGLES, 0, length * 6);
 
     glDisableVertexAttribArray(shader_program->get_position_attribute());
     glDisableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
@@ -246,8 +223,42 @@ void initialise()
     glewInit();
 #endif
     
-    // ————— FONT SETUP ————— //
-    g_font_texture_id = load_texture(FONTSHEET_FILEPATH);
+    // ————— ASSETS ————— //
+    // Every image decodes on a worker, as do the sprite masks, while the set-up below goes
+    // on; each upload waits for its decode and then runs on this (the GL) thread as part of
+    // the wait at MAP SET-UP
+    g_game_state.jobs = new JobSystem();
+    JobSystem &jobs = *g_game_state.jobs;
+
+    WorldTextures textures;
+    GLuint map_texture_id = 0;
+
+    const int TEXTURE_COUNT = 6;
+    const char *texture_paths[TEXTURE_COUNT] = { FONTSHEET_FILEPATH, MAP_TILESET_FILEPATH, "assets/images/background.png",
+                                                 PLATFORM_FILEPATH, SPRITESHEET_FILEPATH, ENEMY1_FILEPATH };
+    GLuint *texture_ids[TEXTURE_COUNT] = { &g_font_texture_id, &map_texture_id, &g_bg_texture_id,
+                                           &textures.platform, &textures.player, &textures.enemy };
+    const char *projectile_files[] = { "assets/images/bullet.png", "assets/images/bullet2.png" };
+
+    DecodedImage images[TEXTURE_COUNT + 1]; // the last is the projectile atlas
+    JobHandle    uploads[TEXTURE_COUNT + 1];
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        JobHandle decode = jobs.submit([&, i] { decode_image(texture_paths[i], &images[i]); });
+        uploads[i] = jobs.submit_main([&, i] { *texture_ids[i] = upload_texture(&images[i]); }, { decode });
+    }
+    JobHandle decode_atlas_job = jobs.submit([&] {
+        decode_atlas(projectile_files, 2, &images[TEXTURE_COUNT], textures.projectile_uvs);
+    });
+    uploads[TEXTURE_COUNT] = jobs.submit_main([&] {
+        textures.projectiles = upload_texture(&images[TEXTURE_COUNT], GL_CLAMP_TO_EDGE);
+    }, { decode_atlas_job });
+
+    g_game_state.masks = new WorldMasks();
+    bool masks_loaded = false;
+    JobHandle load_masks = jobs.submit([&] {
+        masks_loaded = g_game_state.masks->load(SPRITESHEET_FILEPATH, ENEMY1_FILEPATH, projectile_files[0],
+                                                projectile_files[1]);
+    });
     
     // ————— VIDEO SETUP ————— //
     glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
@@ -268,124 +279,64 @@ void initialise()
     glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
     
     // ————— MAP SET-UP ————— //
-    GLuint map_texture_id = load_texture(MAP_TILESET_FILEPATH);
-    g_game_state.map = new Map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, map_texture_id, 1.0f,3, 1);
+    for (const JobHandle &upload : uploads) jobs.wait(upload);
+    jobs.wait(load_masks);
+    if (masks_loaded) textures.masks = g_game_state.masks;
+
+    g_game_state.map = new Map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, map_texture_id, 1.0f,3, 1, &jobs);
+    g_game_state.map->upload(); // while the context is still this thread's
     
     // ————— BACKGROUND SET-UP ————— //
-    g_bg_texture_id = load_texture("assets/images/background.png");
     g_bg_matrix = glm::mat4(1.0f);
     g_bg_matrix = glm::translate(g_bg_matrix, glm::vec3(0.0f, 0.0f, 0.0f));
     g_bg_matrix = glm::scale(g_bg_matrix, glm::vec3(60.5f, 12.5f, 1.0f));   // scale
     
-    // ––––– PLATFORM ––––– //
-    GLuint platform_texture_id = load_texture(PLATFORM_FILEPATH);
-
-    g_game_state.platforms = new Entity[PLATFORM_COUNT];
-
-    float start_x = 6.0f; // Set the desired starting x position
-    float start_y = 2.0f; // Set the desired starting y position
-
-    for (int i = 0; i < PLATFORM_COUNT; i++) {
-        g_game_state.platforms[i] = Entity(platform_texture_id, 0.0f, 0.4f, 1.0f, PLATFORM);
-        g_game_state.platforms[i].set_position(glm::vec3(start_x + i, start_y, 0.0f));
-        g_game_state.platforms[i].update(0.0f, nullptr, nullptr, 0, g_game_state.map);
-    }
-    
-    // ————— PLAYER SET-UP ————— //
-
-    GLuint player_texture_id = load_texture(SPRITESHEET_FILEPATH);
-
-    int player_walking_animation[4][4] =
-    {
-        { 0, 1, 2, 3 },  // for PLAYER to move to the left,
-        { 4, 5, 6, 7 }, // for PLAYER to move to the right,
-        { 8, 9, 10, 11 }, // for PLAYER to move upwards,
-        { 12, 13, 14, 15 }   // for PLAYER to move downwards
-    };
-
-    glm::vec3 acceleration = glm::vec3(0.0f,-4.905f, 0.0f);
-
-    g_game_state.player = new Entity(
-        player_texture_id,         // texture id
-        3.0f,                      // speed
-        acceleration,              // acceleration
-        4.0f,                      // jumping power
-        player_walking_animation,  // animation index sets
-        0.0f,                      // animation time
-        4,                         // animation frame amount
-        0,                         // current animation index
-        4,                         // animation column amount
-        4,                         // animation row amount
-        0.65f,                      // width
-        0.65f,                      // height
-        PLAYER
-    );
-    
-    g_game_state.player->m_visual_scale = 2.0f; // scaling player
-    g_game_state.player->set_position(glm::vec3(2.0f, 0.0f, 0.0f));
-
-    // ————— ENEMIES SET-UP ————— //
-    GLuint enemy_texture_id = load_texture(ENEMY1_FILEPATH);
-
-    int enemy_walking_animation[4][4] = {
-        {8, 9, 10, 11}, // Left
-        {4, 5, 6, 7},   // Right
-        {0, 1, 2, 3}, // Up
-        {12, 13, 14, 15} // Down
-    };
-    glm::vec3 enemy_acceleration = glm::vec3(0.0f, -2.905f, 0.0f);
-
-    g_game_state.enemies = new Entity[ENEMY_COUNT];
-
-    for (int i = 0; i < ENEMY_COUNT; ++i) {
-        g_game_state.enemies[i] = Entity(
-            enemy_texture_id,          // texture id
-            2.0f,                      // speed
-            enemy_acceleration,        // acceleration
-            1.0f,                      // jumping power (or adjust as needed)
-            enemy_walking_animation,   // animation frames
-            0.0f,                      // animation time
-            4,                         // animation frame amount
-            0,                         // current animation index
-            4,                         // animation column amount
-            4,                         // animation row amount
-            0.65f,                     // width
-            0.65f,                     // height
-            ENEMY                      // type
-        );
-        g_game_state.enemies[i].m_visual_scale = 1.0f; // scale of enemies
-    }
-    
-    //first enemy
-    g_game_state.enemies[0].set_position(glm::vec3(4.0f, -5.125f, 0.0f));
-    g_game_state.enemies[0].set_ai_type(JUMPER);
-    g_game_state.enemies[0].set_ai_state(JUMPING);
-    g_game_state.enemies[0].set_jumping_power(2.0f);
-
-    //second enemy
-    g_game_state.enemies[1].set_position(glm::vec3(10.45f, -2.125f, 0.0f));
-    g_game_state.enemies[1].set_ai_type(SHOOTER);
-    g_game_state.enemies[1].set_ai_state(SHOOTING);
-    GLuint projectile_texture1 = load_texture("assets/images/bullet.png");
-    g_game_state.enemies[1].set_projectile_texture(projectile_texture1);
-    
-    //third enemy
-    g_game_state.enemies[2].set_position(glm::vec3(19.95f, -5.125f, 0.0f));
-    g_game_state.enemies[2].set_ai_type(PATROL);
-    g_game_state.enemies[2].set_ai_state(PATROLLING);
-    g_game_state.enemies[2].set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
-    g_game_state.enemies[2].set_speed(1.5f);
-    
-    //fourth enemy
-    g_game_state.enemies[3].set_position(glm::vec3(12.95f, -4.125f, 0.0f));
-    g_game_state.enemies[3].set_ai_type(SHOOTER);
-    g_game_state.enemies[3].set_ai_state(SHOOTING);
-    GLuint projectile_texture2 = load_texture("assets/images/bullet2.png");
-    g_game_state.enemies[3].set_projectile_texture(projectile_texture2);
-    
-
-    // Jumping
-    g_game_state.player->set_jumping_power(5.0f);
+    // ————— WORLD SET-UP ————— //
+    g_game_state.world = new World();
+    g_game_state.world->initialise(textures, g_game_state.map);
+
+    g_game_state.player    = &g_game_state.world->player;
+    g_game_state.enemies   = &g_game_state.world->enemies;
+    g_game_state.platforms = g_game_state.world->platforms;
+
+    g_game_state.nav = new NavLevel();
+    g_game_state.nav->add_enemies(*g_game_state.map, g_game_state.enemies->data(), g_game_state.enemies->get_count());
+
+    g_game_state.statics = new StaticColliders(*g_game_state.map, g_game_state.platforms, PLATFORM_COUNT);
+
+    // ————— EFFECTS SET-UP ————— //
+    // Specks cut from textures already loaded: three textures, so at most three draws
+    g_game_state.effects = new ParticleSystem(PARTICLE_CAPACITY);
+    g_game_state.effects->set_budget(PARTICLE_BUDGET);
+
+    ParticleStyle sparks;
+    sparks.texture  = textures.projectiles;
+    sparks.uv       = textures.projectile_uvs[0];
+    sparks.size     = 0.15f;
+    sparks.lifetime = 0.4f;
+    sparks.drag     = 3.0f;
+    g_game_state.effects->set_style(EFFECT_SPARKS, sparks);
+
+    ParticleStyle dust;
+    dust.texture  = map_texture_id;
+    dust.uv       = glm::vec4(0.0f, 0.0f, 1.0f / 3.0f, 1.0f);
+    dust.size     = 0.2f;
+    dust.lifetime = 0.8f;
+    dust.gravity  = 0.5f;
+    dust.drag     = 2.0f;
+    g_game_state.effects->set_style(EFFECT_DUST, dust);
+
+    ParticleStyle debris;
+    debris.texture  = textures.enemy;
+    debris.uv       = glm::vec4(0.0f, 0.0f, 0.25f, 0.25f);
+    debris.size     = 0.25f;
+    debris.lifetime = 1.0f;
+    debris.gravity  = -9.81f;
+    debris.drag     = 0.5f;
+    g_game_state.effects->set_style(EFFECT_DEBRIS, debris);
+
+    g_game_state.world->effects = g_game_state.effects;
+    g_game_state.world->timings = &g_game_state.timings;
 
     Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
     
@@ -398,12 +349,19 @@ void initialise()
     // ————— BLENDING ————— //
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // ————— RENDER THREAD ————— //
+    // From here on this thread only simulates; every GL call is the render thread's
+    g_game_state.renderer = new RenderThread(g_display_window, context, draw_frame);
+
+    // Room for everything a frame can hold at once, so no frame grows the snapshots
+    g_game_state.renderer->reserve(1 + PLATFORM_COUNT + g_game_state.enemies->get_capacity(),
+                                   PARTICLE_CAPACITY + World::PROJECTILE_CAPACITY, ParticleSystem::MAX_STYLES + 1, 1);
 }
 
 void process_input()
 {
     g_game_state.player->set_movement(glm::vec3(0.0f));
-    g_game_state.enemies->set_movement(glm::vec3(0.0f));
     
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -461,65 +419,25 @@ void update() {
 
     delta_time += g_accumulator;
     
-    glm::vec3 player_pos = g_game_state.player->get_position();
-    const float map_lower_boundary = -6.0f; // sets y position for map cutoff
-
     while (delta_time >= FIXED_TIMESTEP) {
-        g_game_state.player->update(FIXED_TIMESTEP, g_game_state.player, g_game_state.platforms, PLATFORM_COUNT, g_game_state.map);
-
-        for (int i = 0; i < ENEMY_COUNT; i++) {
-            if (!g_game_state.enemies[i].is_active()) continue;
-
-            g_game_state.enemies[i].ai_activate(g_game_state.player);
-            g_game_state.enemies[i].update(FIXED_TIMESTEP, g_game_state.player, g_game_state.platforms, PLATFORM_COUNT, g_game_state.map);
-
-            // Check if player lands on top of the enemy to defeat it
-            if (g_game_state.player->check_collision(&g_game_state.enemies[i])) {
-                if (g_game_state.player->get_position().y > g_game_state.enemies[i].get_position().y + g_game_state.enemies[i].get_height() / 2.0f) {
-                    g_game_state.enemies[i].deactivate();
-                    g_game_state.enemies_defeated++;
-
-                    // Ensure the projectile is deactivated if the enemy is a shooter
-                    if (g_game_state.enemies[i].get_ai_type() == SHOOTER) {
-                        g_game_state.enemies[i].set_projectile_active(false);
-                    }
-
-                    if (g_game_state.enemies_defeated == ENEMY_COUNT) {
-                        g_app_status = PAUSED;
-                        return;
-                    }
-                } else {
-                    g_app_status = PAUSED;
-                    return;
-                }
-            }
-
-            // Check for collisions manually with the projectile since I couldnt get it to work correctly in Entity
-            if (g_game_state.enemies[i].is_projectile_active()) {
-                // Projectile boundaries
-                float proj_left = g_game_state.enemies[i].get_projectile_position().x - 0.1f;
-                float proj_right = g_game_state.enemies[i].get_projectile_position().x + 0.1f;
-                float proj_top = g_game_state.enemies[i].get_projectile_position().y + 0.1f;
-                float proj_bottom = g_game_state.enemies[i].get_projectile_position().y - 0.1f;
-
-                // Player boundaries
-                float player_left = player_pos.x - g_game_state.player->get_width() / 2.0f;
-                float player_right = player_pos.x + g_game_state.player->get_width() / 2.0f;
-                float player_top = player_pos.y + g_game_state.player->get_height() / 2.0f;
-                float player_bottom = player_pos.y - g_game_state.player->get_height() / 2.0f;
-
-                // Check collision between projectile and player
-                if (proj_right > player_left && proj_left < player_right &&
-                    proj_top > player_bottom && proj_bottom < player_top) {
-                    g_app_status = PAUSED;
-                    return;
-                }
-            }
+        WorldStatus status;
+        {
+            AllocationScope scope(TAG_WORLD);
+            status = g_game_state.world->update(FIXED_TIMESTEP, g_game_state.map, g_game_state.nav,
+                                                g_game_state.statics);
+        }
+        {
+            AllocationScope scope(TAG_EFFECTS);
+            g_game_state.effects->update(FIXED_TIMESTEP);
         }
-        //handles if player falls off map
-        if (g_game_state.player->get_position().y < map_lower_boundary) {
+
+        if (status != WORLD_RUNNING) {
             g_app_status = PAUSED;
-            std::cout << "You lose! Player fell out of bounds." << std::endl;
+
+            //handles if player falls off map
+            if (g_game_state.player->get_position().y < World::MAP_LOWER_BOUNDARY) {
+                std::cout << "You lose! Player fell out of bounds." << std::endl;
+            }
             return;
         }
 
@@ -531,11 +449,63 @@ void update() {
     float camera_y_offset = -2.0f;
     g_view_matrix = glm::mat4(1.0f);
     g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-g_game_state.player->get_position().x, -camera_y_offset, 0.0f));
-    g_shader_program.set_view_matrix(g_view_matrix);
 }
 
+// Effects keep playing out on the end screen, after the world has stopped
+void update_effects()
+{
+    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    float delta_time = ticks - g_previous_ticks;
+    g_previous_ticks = ticks;
+
+    AllocationScope scope(TAG_EFFECTS);
+    g_game_state.effects->update(delta_time);
+}
 
+// Copies what this frame shows into a snapshot for the render thread; no GL here
 void render()
+{
+    AllocationScope scope(TAG_SNAPSHOT);
+    RenderSnapshot &snapshot = g_game_state.renderer->get_snapshot();
+    snapshot.view_matrix = g_view_matrix;
+
+    g_game_state.player->snapshot(&snapshot);
+
+//    for (int i = 0; i < PLATFORM_COUNT; i++) {
+//        g_game_state.platforms[i].snapshot(&snapshot);
+//    }
+
+    for (Entity &enemy : *g_game_state.enemies) enemy.snapshot(&snapshot);
+
+    // Every shot in flight, in one draw
+    g_game_state.world->projectiles.snapshot(&snapshot);
+
+    // Every particle, one draw per texture
+    g_game_state.effects->snapshot(&snapshot, g_game_state.jobs);
+
+    // Display end-game messages if the game is paused which means its the end state
+    if (g_app_status == PAUSED) {
+        glm::vec3 player_position = g_game_state.player->get_position();
+        glm::vec3 message_position = player_position + glm::vec3(-1.5f, 1.5f, 0.0f);  // Adjust y-offset as needed
+
+        if (g_game_state.world->status == WORLD_WON) {
+            snapshot.add_text("You Win!", 0.5f, 0.05f, message_position);
+        } else {
+            snapshot.add_text("You Lose!", 0.5f, 0.05f, message_position);
+        }
+    }
+
+    // Tiles edited this frame, for the render thread to copy into the map's buffers
+    g_game_state.map->submit_edits();
+
+    g_game_state.renderer->publish();
+}
+
+// Runs on the render thread, which swaps afterwards. Besides the snapshot it only reads
+// what set-up left fixed: the shader, the background, the map's buffers (which only change
+// by the edits the map hands over) and the font.
+// Anything it needs for just this frame comes out of arena.
+void draw_frame(const RenderSnapshot &snapshot, FrameArena *arena)
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -561,34 +531,26 @@ void render()
     glBindTexture(GL_TEXTURE_2D, g_bg_texture_id);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
-    g_shader_program.set_view_matrix(g_view_matrix);
+    g_shader_program.set_view_matrix(snapshot.view_matrix);
 
     g_game_state.map->render(&g_shader_program);
-    g_game_state.player->render(&g_shader_program);
-
-//    for (int i = 0; i < PLATFORM_COUNT; i++) {
-//        g_game_state.platforms[i].render(&g_shader_program);
-//    }
-
-    for (int i = 0; i < ENEMY_COUNT; i++) {
-        if (g_game_state.enemies[i].is_active()) {
-            g_game_state.enemies[i].render(&g_shader_program);
-        }
-    }
 
-    // Display end-game messages if the game is paused which means its the end state
-    if (g_app_status == PAUSED) {
-        glm::vec3 player_position = g_game_state.player->get_position();
-        glm::vec3 message_position = player_position + glm::vec3(-1.5f, 1.5f, 0.0f);  // Adjust y-offset as needed
+    // The player, then the enemies, then the shots and particles
+    draw_snapshot_sprites(&g_shader_program, snapshot);
+    draw_snapshot_quads(&g_shader_program, snapshot);
 
-        if (g_game_state.enemies_defeated == ENEMY_COUNT) {
-            draw_text(&g_shader_program, g_font_texture_id, "You Win!", 0.5f, 0.05f, message_position);
-        } else {
-            draw_text(&g_shader_program, g_font_texture_id, "You Lose!", 0.5f, 0.05f, message_position);
-        }
-    }
+    for (const TextDraw &text : snapshot.texts)
+        draw_text(&g_shader_program, g_font_texture_id, text.text, text.font_size, text.spacing, text.position,
+                  arena);
+}
 
-    SDL_GL_SwapWindow(g_display_window);
+// The display no longer holds this thread back once a frame, so rather than spin it
+// sleeps until the next fixed step is due
+void wait_for_next_tick()
+{
+    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    float until_next = FIXED_TIMESTEP - g_accumulator - (ticks - g_previous_ticks);
+    if (until_next * MILLISECONDS_IN_SECOND >= 1.0f) SDL_Delay((Uint32) (until_next * MILLISECONDS_IN_SECOND));
 }
 
 
@@ -596,12 +558,51 @@ void render()
 
 void shutdown()
 {
+    // Hands the context back to this thread, after the last frame
+    if (g_game_state.renderer) {
+        RenderStats stats = g_game_state.renderer->get_stats();
+        LOG("Frames: " << stats.published << " published, " << stats.drawn << " drawn, " << stats.skipped
+            << " skipped; frame scratch peak " << stats.arena_peak << " bytes (" << stats.arena_grows
+            << " grows)");
+        delete g_game_state.renderer;
+        g_game_state.renderer = nullptr;
+    }
+
     SDL_Quit();
+
+    const FrameAllocationStats &frames = g_game_state.frames;
+    if (frames.frames > 0) {
+        std::cout << "Frame cost: " << frames.get_average_ms() << " ms (worst " << frames.peak_ms << ")";
+        if (is_allocation_tracking_enabled()) {
+            std::cout << "; " << frames.allocating_frames << " of " << frames.frames << " frames allocated, worst "
+                      << frames.peak_count << " allocations / " << frames.peak_bytes << " bytes;";
+            for (int tag = 0; tag < TAG_COUNT; tag++)
+                std::cout << ' ' << ALLOCATION_TAG_NAMES[tag] << ' ' << frames.total.count[tag];
+        }
+        std::cout << std::endl;
+    }
+
+    if (g_game_state.timings.ticks > 0) {
+        std::cout << "Tick phases (ms per tick over " << g_game_state.timings.ticks << " ticks):";
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+            std::cout << ' ' << TICK_PHASES[phase].name << ' ' << g_game_state.timings.get_average_ms((TickPhase) phase);
+        std::cout << std::endl;
+    }
     
-    delete [] g_game_state.platforms;
-    delete [] g_game_state.enemies;
-    delete    g_game_state.player;
+    delete    g_game_state.world;
+    delete    g_game_state.nav;
+    delete    g_game_state.statics;
+    delete    g_game_state.masks;
+
+    if (g_game_state.effects) {
+        const ParticleStats &stats = g_game_state.effects->get_stats();
+        LOG("Particles: peak " << stats.peak_count << " of " << g_game_state.effects->get_budget() << " ("
+            << stats.dropped << " dropped), worst update " << stats.peak_update_ms << " ms, worst render "
+            << stats.peak_render_ms << " ms");
+    }
+    delete    g_game_state.effects;
     delete    g_game_state.map;
+    delete    g_game_state.jobs;
     Mix_FreeChunk(g_game_state.jump_sfx);
     Mix_FreeMusic(g_game_state.bgm);
 }
@@ -609,17 +610,29 @@ void shutdown()
 // ————— GAME LOOP ————— //
 int main(int argc, char* argv[])
 {
+    if (argc > 2 && strcmp(argv[1], "--bench") == 0) return run_benchmark(argv[2]);
+
     initialise();
 
     while (g_app_status != TERMINATED)
     {
+        AllocationCounts frame_start = get_allocation_counts();
+        auto             start_time  = std::chrono::steady_clock::now();
+
         process_input();
         
         if (g_app_status == RUNNING) {
             update();
+        } else if (g_app_status == PAUSED) {
+            update_effects();
         }
         
         render();
+
+        std::chrono::duration<double, std::milli> frame_ms = std::chrono::steady_clock::now() - start_time;
+        g_game_state.frames.add_frame(frame_ms.count(), get_allocation_counts() - frame_start);
+
+        wait_for_next_tick();
     }
 
     shutdown();